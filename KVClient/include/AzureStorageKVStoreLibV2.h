@@ -6,6 +6,7 @@
 #include <future>
 #include <functional>
 #include "KVTypes.h"
+#include "PayloadCodec.h"
 #include <memory>
 
 // Log levels
@@ -24,6 +25,9 @@ enum class HttpTransportProtocol {
 // Logging callback type
 using LogCallback = std::function<void(LogLevel level, const std::string&)>;
 
+// Per-chunk StreamingRead callback: index into the requested locations, then the read result
+using StreamingReadCallback = std::function<void(size_t index, bool found, const PromptChunk& chunk, const ServerMetrics& metrics)>;
+
 // gRPC Client implementation of AzureStorageKVStoreLibV2 interface
 // Provides same API as server-side library but communicates via gRPC
 class AzureStorageKVStoreLibV2 {
@@ -42,6 +46,10 @@ public:
     // Logging configuration
     void SetLogCallback(LogCallback callback);
     void SetLogLevel(LogLevel level);
+    
+    // Compress Write/WriteBatch payloads before sending (default: none). The server stores them
+    // as sent; reads always accept the codecs built into this client and return raw payloads.
+    void SetPayloadCompression(const payload::Options& options);
 
     // Core API methods
     template<typename TokenIterator>
@@ -50,19 +58,29 @@ public:
         const std::string& completionId,
         TokenIterator begin,
         TokenIterator end,
-        const std::vector<hash_t>& precomputedHashes
+        const std::vector<hash_t>& precomputedHashes,
+        ProbeStrategy probeStrategy = ProbeStrategy::Default
     ) const;
     
     // Returns: tuple<found, chunk, server_metrics>
     std::future<std::tuple<bool, PromptChunk, ServerMetrics>> ReadAsync(const std::string& location, const std::string& completionId = "") const;
     // Returns: future<server_metrics>
-    std::future<ServerMetrics> WriteAsync(const PromptChunk& chunk);
+    std::future<ServerMetrics> WriteAsync(const PromptChunk& chunk, WriteDurability durability = WriteDurability::Storage);
+    
+    // Batch Write - stores an ordered block chain with one WriteBatch RPC per ~64MB of payload
+    // Parent links are implied: chunks[i]'s parent is chunks[i-1].hash (chunks[0].parentHash is used as given)
+    // Throws if an RPC fails; per-block storage failures are reported in the result statuses
+    std::future<WriteBatchResult> WriteBatchAsync(const std::vector<PromptChunk>& chunks,
+                                                  WriteDurability durability = WriteDurability::Storage);
     
     // Streaming Read - reads multiple locations with reduced network overhead
-    // Returns: vector of tuple<found, chunk, server_metrics> in same order as locations
+    // Returns: vector of tuple<found, chunk, server_metrics> in same order as locations.
+    // The server answers in completion order; onChunk, if set, sees each chunk as it arrives
+    // (on the stream thread, with its index in locations) so early chunks need not wait for slow ones.
     std::future<std::vector<std::tuple<bool, PromptChunk, ServerMetrics>>> StreamingReadAsync(
         const std::vector<std::string>& locations,
-        const std::string& completionId = "") const;
+        const std::string& completionId = "",
+        StreamingReadCallback onChunk = nullptr) const;
 
 private:
     class Impl;
@@ -75,5 +93,6 @@ extern template LookupResult AzureStorageKVStoreLibV2::Lookup<std::vector<Token>
     const std::string&,
     std::vector<Token>::const_iterator,
     std::vector<Token>::const_iterator,
-    const std::vector<hash_t>&
+    const std::vector<hash_t>&,
+    ProbeStrategy
 ) const;
@@ -13,15 +13,36 @@ using hash_t = uint64_t;
 // Type representing a vector of hash values                
 using HashVector = std::vector<hash_t>;
 
+// How the server probes storage for the cached prefix on Lookup
+enum class ProbeStrategy {
+    Default,    // Server/container configured strategy
+    Parallel,   // Probe every block at once
+    Waves,      // Doubling waves until the chain breaks
+    Galloping,  // Exponential then binary search for the first miss
+    Binary      // Binary search for the first miss
+};
+
+// When the server acknowledges a write. The early levels need write-behind enabled on the server;
+// otherwise the write completes at Storage durability.
+enum class WriteDurability {
+    Storage,     // After the upload to storage completes (default)
+    LocalCache,  // After the server journals it on local disk
+    Receipt      // Once queued in server memory
+};
+
 // Server-side performance metrics (from gRPC responses)
 struct ServerMetrics {
     int64_t storage_latency_us = 0;  // Storage layer latency
     int64_t total_latency_us = 0;    // Total server-side latency
-    int64_t overhead_us = 0;         // Server overhead (total - storage)
+    int64_t overhead_us = 0;         // Server overhead (total - storage - queue wait)
+    int64_t queue_wait_us = 0;       // Wait in the server's request executor queue
     int64_t client_e2e_us = 0;       // Client-measured E2E latency (from gRPC client)
     int64_t serialize_us = 0;        // Client-side request serialization time
     int64_t deserialize_us = 0;      // Client-side response deserialization time
     int64_t network_us = 0;          // Pure network time (e2e - server_total - serialize - deserialize)
+    int32_t probes_issued = 0;       // Lookup: storage probes issued by the server
+    int32_t probes_wasted = 0;       // Lookup: probes past the block that ended the chain
+    int64_t bytes_copied = 0;        // Read: payload bytes the server copied in memory
     
     ServerMetrics() = default;
     ServerMetrics(int64_t storage, int64_t total, int64_t overhead, int64_t client_e2e = 0)
@@ -45,6 +66,29 @@ struct PromptChunk {
         : hash(h), partitionKey(pk), parentHash(ph), buffer(buf), bufferSize(buf.size()), tokens(toks), completionId(cid) {}
 };
 
+// Outcome of one block of a WriteBatch
+struct BlockWriteStatus {
+    hash_t hash = 0;
+    bool success = false;   // Stored, or an identical version already existed
+    std::string error;      // Set when success is false
+};
+
+// Result of WriteBatchAsync: one status per chunk, in request order
+struct WriteBatchResult {
+    std::vector<BlockWriteStatus> statuses;
+    ServerMetrics server_metrics;  // Summed over the RPCs the batch was split into
+    WriteDurability durability = WriteDurability::Storage;  // Weakest level any RPC was acknowledged at
+    
+    bool AllSucceeded() const {
+        for (const auto& status : statuses) {
+            if (!status.success) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
 // V2 API: Block location (token-based blob name OR GUID for multi-version)
 struct BlockLocation {
     hash_t hash;
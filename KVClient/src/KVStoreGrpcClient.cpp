@@ -4,9 +4,11 @@
 #include "AzureStorageKVStoreLibV2.h"
 #include "kvstore.grpc.pb.h"
 #include <grpcpp/grpcpp.h>
+#include <algorithm>
 #include <memory>
 #include <iostream>
 #include <limits>
+#include <thread>
 
 using grpc::Channel;
 using grpc::ClientContext;
@@ -18,11 +20,70 @@ using kvstore::ReadRequest;
 using kvstore::ReadResponse;
 using kvstore::WriteRequest;
 using kvstore::WriteResponse;
+using kvstore::WriteBatchRequest;
+using kvstore::WriteBatchResponse;
 
 class AzureStorageKVStoreLibV2::Impl {
 public:
     Impl() : initialized_(false) {}
     
+    static kvstore::WriteDurability ToProtoDurability(WriteDurability durability) {
+        switch (durability) {
+        case WriteDurability::LocalCache: return kvstore::WRITE_DURABILITY_LOCAL_CACHE;
+        case WriteDurability::Receipt: return kvstore::WRITE_DURABILITY_RECEIPT;
+        default: return kvstore::WRITE_DURABILITY_STORAGE;
+        }
+    }
+    
+    static WriteDurability FromProtoDurability(kvstore::WriteDurability durability) {
+        switch (durability) {
+        case kvstore::WRITE_DURABILITY_LOCAL_CACHE: return WriteDurability::LocalCache;
+        case kvstore::WRITE_DURABILITY_RECEIPT: return WriteDurability::Receipt;
+        default: return WriteDurability::Storage;
+        }
+    }
+    
+    // Codecs this build can decode, so the server may send stored payloads without decompressing
+    static void AddAcceptedCodecs(ReadRequest& request) {
+        for (auto codec : {payload::Codec::Lz4, payload::Codec::Zstd}) {
+            if (payload::IsSupported(codec)) {
+                request.add_accept_codecs(static_cast<kvstore::PayloadCodec>(codec));
+            }
+        }
+    }
+    
+    // Raw payload of a response chunk; false if a compressed payload does not decode
+    static bool DecodePayload(const kvstore::PromptChunk& protoChunk, std::vector<uint8_t>& buffer) {
+        const auto& data = protoChunk.buffer();
+        if (protoChunk.codec() == kvstore::PAYLOAD_CODEC_NONE) {
+            buffer.assign(data.begin(), data.end());
+            return true;
+        }
+        payload::Encoding encoding;
+        encoding.codec = static_cast<payload::Codec>(protoChunk.codec());
+        encoding.shuffle = static_cast<uint8_t>(std::min<uint32_t>(protoChunk.shuffle(), 255));
+        encoding.rawSize = protoChunk.raw_size();
+        if (encoding.rawSize > payload::kMaxRawSize) {
+            return false;
+        }
+        buffer.resize(static_cast<size_t>(encoding.rawSize));
+        return payload::Decode(reinterpret_cast<const uint8_t*>(data.data()), data.size(), encoding, buffer.data());
+    }
+    
+    // Request payload, compressed with the configured codec when that makes it smaller
+    void EncodePayload(const std::vector<uint8_t>& buffer, kvstore::PromptChunk* protoChunk) const {
+        std::string encoded;
+        auto encoding = payload::Encode(buffer.data(), buffer.size(), compression_, encoded);
+        if (encoding.IsRaw()) {
+            protoChunk->set_buffer(buffer.data(), buffer.size());
+            return;
+        }
+        protoChunk->set_buffer(std::move(encoded));
+        protoChunk->set_codec(static_cast<kvstore::PayloadCodec>(encoding.codec));
+        protoChunk->set_shuffle(encoding.shuffle);
+        protoChunk->set_raw_size(encoding.rawSize);
+    }
+    
     // Extract resource name from account URL
     // e.g., "https://mystorageaccount.blob.core.windows.net" -> "mystorageaccount"
     static std::string ExtractResourceName(const std::string& accountUrl) {
@@ -99,7 +160,8 @@ public:
                        const std::string& completionId,
                        TokenIterator tokensBegin,
                        TokenIterator tokensEnd,
-                       const std::vector<hash_t>& precomputedHashes) const {
+                       const std::vector<hash_t>& precomputedHashes,
+                       ProbeStrategy probeStrategy) const {
         LookupResult result;
         result.cachedBlocks = 0;
         result.lastHash = 0;
@@ -127,6 +189,14 @@ public:
             request.add_precomputed_hashes(hash);
         }
         
+        switch (probeStrategy) {
+        case ProbeStrategy::Parallel: request.set_probe_strategy(kvstore::PROBE_STRATEGY_PARALLEL); break;
+        case ProbeStrategy::Waves: request.set_probe_strategy(kvstore::PROBE_STRATEGY_WAVES); break;
+        case ProbeStrategy::Galloping: request.set_probe_strategy(kvstore::PROBE_STRATEGY_GALLOPING); break;
+        case ProbeStrategy::Binary: request.set_probe_strategy(kvstore::PROBE_STRATEGY_BINARY); break;
+        default: break;
+        }
+        
         // Force size calculation (triggers internal serialization prep, but doesn't serialize twice)
         size_t request_size = request.ByteSizeLong();
         
@@ -156,6 +226,8 @@ public:
             metricsLog += ", server_total=" + std::to_string(sm.total_latency_us()) + "us";
             metricsLog += ", storage=" + std::to_string(sm.storage_latency_us()) + "us";
             metricsLog += ", overhead=" + std::to_string(sm.overhead_us()) + "us";
+            metricsLog += ", queue=" + std::to_string(sm.queue_wait_us()) + "us";
+            metricsLog += ", probes=" + std::to_string(sm.probes_issued()) + "/" + std::to_string(sm.probes_wasted()) + " wasted";
         }
         metricsLog += ", partition=" + partitionKey + ", blocks=" + std::to_string(response.cached_blocks());
         LogMessage(LogLevel::Information, metricsLog);
@@ -190,6 +262,9 @@ public:
             result.server_metrics.storage_latency_us = sm.storage_latency_us();
             result.server_metrics.total_latency_us = sm.total_latency_us();
             result.server_metrics.overhead_us = sm.overhead_us();
+            result.server_metrics.queue_wait_us = sm.queue_wait_us();
+            result.server_metrics.probes_issued = sm.probes_issued();
+            result.server_metrics.probes_wasted = sm.probes_wasted();
         }
         
         // Add client-measured times
@@ -226,6 +301,7 @@ public:
             request.set_container_name(containerName_);
             request.set_location(location);
             request.set_completion_id(completionId);
+            AddAcceptedCodecs(request);
             
             auto t1_request_built = std::chrono::high_resolution_clock::now();
             
@@ -257,6 +333,7 @@ public:
                 metricsLog += ", server_total=" + std::to_string(sm.total_latency_us()) + "us";
                 metricsLog += ", storage=" + std::to_string(sm.storage_latency_us()) + "us";
                 metricsLog += ", overhead=" + std::to_string(sm.overhead_us()) + "us";
+                metricsLog += ", queue=" + std::to_string(sm.queue_wait_us()) + "us";
                 metricsLog += ", network_rtt=" + std::to_string(e2e_us - sm.total_latency_us()) + "us";
             }
             
@@ -280,9 +357,11 @@ public:
             
             // Copy buffer - this is the largest data copy
             auto t5_buffer_copy_start = std::chrono::high_resolution_clock::now();
-            const auto& bufferData = protoChunk.buffer();
-            response_size = bufferData.size();
-            chunk.buffer.assign(bufferData.begin(), bufferData.end());
+            response_size = protoChunk.buffer().size();
+            if (!DecodePayload(protoChunk, chunk.buffer)) {
+                LogMessage(LogLevel::Error, "Read payload does not decode: " + location);
+                return std::make_tuple(false, PromptChunk(), metrics);
+            }
             chunk.bufferSize = chunk.buffer.size();
             auto t6_buffer_copy_end = std::chrono::high_resolution_clock::now();
             
@@ -313,6 +392,8 @@ public:
                 metrics.storage_latency_us = sm.storage_latency_us();
                 metrics.total_latency_us = sm.total_latency_us();
                 metrics.overhead_us = sm.overhead_us();
+                metrics.queue_wait_us = sm.queue_wait_us();
+                metrics.bytes_copied = sm.bytes_copied();
             }
             // Add client-measured E2E time and serialization metrics
             metrics.client_e2e_us = e2e_us;
@@ -327,8 +408,8 @@ public:
         });
     }
     
-    std::future<ServerMetrics> WriteAsync(const PromptChunk& chunk) {
-        return std::async(std::launch::async, [this, chunk]() -> ServerMetrics {
+    std::future<ServerMetrics> WriteAsync(const PromptChunk& chunk, WriteDurability durability) {
+        return std::async(std::launch::async, [this, chunk, durability]() -> ServerMetrics {
             ServerMetrics metrics;
             
             if (!initialized_) {
@@ -343,6 +424,7 @@ public:
             WriteRequest request;
             request.set_resource_name(resourceName_);
             request.set_container_name(containerName_);
+            request.set_durability(ToProtoDurability(durability));
             
             auto* protoChunk = request.mutable_chunk();
             protoChunk->set_hash(chunk.hash);
@@ -351,7 +433,7 @@ public:
             protoChunk->set_completion_id(chunk.completionId);
             
             auto t1_before_buffer = std::chrono::high_resolution_clock::now();
-            protoChunk->set_buffer(chunk.buffer.data(), chunk.buffer.size());
+            EncodePayload(chunk.buffer, protoChunk);
             auto t2_after_buffer = std::chrono::high_resolution_clock::now();
             
             for (auto token : chunk.tokens) {
@@ -387,6 +469,7 @@ public:
                     metricsLog += ", server_total=" + std::to_string(sm.total_latency_us()) + "us";
                     metricsLog += ", storage=" + std::to_string(sm.storage_latency_us()) + "us";
                     metricsLog += ", overhead=" + std::to_string(sm.overhead_us()) + "us";
+                    metricsLog += ", queue=" + std::to_string(sm.queue_wait_us()) + "us";
                     
                     // Pure network = gRPC call - server processing
                     auto pure_network_us = grpc_call_us - server_total_us;
@@ -413,6 +496,7 @@ public:
                 metrics.storage_latency_us = sm.storage_latency_us();
                 metrics.total_latency_us = sm.total_latency_us();
                 metrics.overhead_us = sm.overhead_us();
+                metrics.queue_wait_us = sm.queue_wait_us();
                 server_total_us = sm.total_latency_us();
             }
             // Add client-measured E2E time and serialization metrics
@@ -429,12 +513,103 @@ public:
         });
     }
     
+    // Batch Write - one RPC per kMaxBatchBytes of payload, issued in chain order
+    std::future<WriteBatchResult> WriteBatchAsync(const std::vector<PromptChunk>& chunks, WriteDurability durability) {
+        return std::async(std::launch::async, [this, chunks, durability]() -> WriteBatchResult {
+            WriteBatchResult result;
+            result.statuses.reserve(chunks.size());
+            
+            if (!initialized_) {
+                LogMessage(LogLevel::Error, "KVClient not initialized");
+                throw std::runtime_error("KVClient not initialized");
+            }
+            
+            // Stay well under the 100MB gRPC message limit (~50 blocks of 1.2MB per RPC)
+            constexpr size_t kMaxBatchBytes = 64 * 1024 * 1024;
+            
+            size_t next = 0;
+            while (next < chunks.size()) {
+                auto serialize_start = std::chrono::high_resolution_clock::now();
+                
+                WriteBatchRequest request;
+                request.set_resource_name(resourceName_);
+                request.set_container_name(containerName_);
+                request.set_durability(ToProtoDurability(durability));
+                
+                size_t batchBytes = 0;
+                size_t first = next;
+                while (next < chunks.size() && (next == first || batchBytes + chunks[next].buffer.size() <= kMaxBatchBytes)) {
+                    const auto& chunk = chunks[next];
+                    auto* protoChunk = request.add_chunks();
+                    protoChunk->set_hash(chunk.hash);
+                    protoChunk->set_partition_key(chunk.partitionKey);
+                    // Later RPCs of a split batch carry their link to the previous block explicitly
+                    protoChunk->set_parent_hash(next == 0 ? chunk.parentHash : chunks[next - 1].hash);
+                    protoChunk->set_completion_id(chunk.completionId);
+                    EncodePayload(chunk.buffer, protoChunk);
+                    for (auto token : chunk.tokens) {
+                        protoChunk->add_tokens(static_cast<int64_t>(token));
+                    }
+                    batchBytes += chunk.buffer.size();
+                    ++next;
+                }
+                
+                auto grpc_start = std::chrono::high_resolution_clock::now();
+                WriteBatchResponse response;
+                ClientContext context;
+                Status status = stub_->WriteBatch(&context, request, &response);
+                auto grpc_end = std::chrono::high_resolution_clock::now();
+                
+                if (!status.ok()) {
+                    LogMessage(LogLevel::Error, "WriteBatch RPC failed: " + status.error_message());
+                    throw std::runtime_error("WriteBatch RPC failed: " + status.error_message());
+                }
+                if (!response.success()) {
+                    LogMessage(LogLevel::Error, "WriteBatch had failed blocks: " + response.error());
+                }
+                
+                // Later enumerators are weaker guarantees
+                result.durability = std::max(result.durability, FromProtoDurability(response.durability()));
+                
+                for (const auto& protoStatus : response.statuses()) {
+                    BlockWriteStatus blockStatus;
+                    blockStatus.hash = protoStatus.hash();
+                    blockStatus.success = protoStatus.success();
+                    blockStatus.error = protoStatus.error();
+                    result.statuses.push_back(std::move(blockStatus));
+                }
+                
+                auto serialize_us = std::chrono::duration_cast<std::chrono::microseconds>(grpc_start - serialize_start).count();
+                auto grpc_call_us = std::chrono::duration_cast<std::chrono::microseconds>(grpc_end - grpc_start).count();
+                auto& metrics = result.server_metrics;
+                if (response.has_server_metrics()) {
+                    const auto& sm = response.server_metrics();
+                    metrics.storage_latency_us += sm.storage_latency_us();
+                    metrics.total_latency_us += sm.total_latency_us();
+                    metrics.overhead_us += sm.overhead_us();
+                    metrics.queue_wait_us += sm.queue_wait_us();
+                    metrics.network_us += grpc_call_us - sm.total_latency_us();
+                }
+                metrics.client_e2e_us += grpc_call_us;
+                metrics.serialize_us += serialize_us;
+                
+                if (logLevel_ >= LogLevel::Verbose) {
+                    std::cerr << "[WriteBatch] blocks=" << (next - first) << ", bytes=" << batchBytes
+                              << ", e2e=" << grpc_call_us << "us, ser=" << serialize_us << "us" << std::endl;
+                }
+            }
+            
+            return result;
+        });
+    }
+    
     // Streaming Read - reads multiple locations with reduced network overhead
     std::future<std::vector<std::tuple<bool, PromptChunk, ServerMetrics>>> StreamingReadAsync(
         const std::vector<std::string>& locations,
-        const std::string& completionId) {
+        const std::string& completionId,
+        StreamingReadCallback onChunk) {
         
-        return std::async(std::launch::async, [this, locations, completionId]() 
+        return std::async(std::launch::async, [this, locations, completionId, onChunk]() 
             -> std::vector<std::tuple<bool, PromptChunk, ServerMetrics>> {
             
             std::vector<std::tuple<bool, PromptChunk, ServerMetrics>> results;
@@ -463,24 +638,33 @@ public:
                 return results;
             }
             
-            // Send all requests first (pipelining)
-            for (const auto& location : locations) {
-                ReadRequest request;
-                request.set_resource_name(resourceName_);
-                request.set_container_name(containerName_);
-                request.set_location(location);
-                request.set_completion_id(completionId);
-                
-                if (!stream->Write(request)) {
-                    LogMessage(LogLevel::Error, "Failed to write request to stream");
-                    break;
+            // Send requests on their own thread while this one reads (pipelining), numbered so
+            // responses can arrive in any order. The server stops reading requests while a stream
+            // has too many unanswered, so writing everything before reading could deadlock.
+            std::thread writer([this, &stream, &locations, &completionId]() {
+                for (size_t i = 0; i < locations.size(); i++) {
+                    ReadRequest request;
+                    request.set_resource_name(resourceName_);
+                    request.set_container_name(containerName_);
+                    request.set_location(locations[i]);
+                    request.set_completion_id(completionId);
+                    request.set_sequence(i + 1);
+                    AddAcceptedCodecs(request);
+                    
+                    if (!stream->Write(request)) {
+                        LogMessage(LogLevel::Error, "Failed to write request to stream");
+                        break;
+                    }
                 }
-            }
-            
-            // Signal that we're done sending
-            stream->WritesDone();
-            
-            // Read all responses
+                
+                // Signal that we're done sending
+                stream->WritesDone();
+            });
+            
+            // Read all responses, each into its request's slot
+            results.resize(locations.size());
+            std::vector<bool> filled(locations.size(), false);
+            size_t next_unnumbered = 0;  // Servers without sequence support answer in request order
             ReadResponse response;
             size_t response_count = 0;
             int64_t total_storage_us = 0;
@@ -491,6 +675,20 @@ public:
             while (stream->Read(&response)) {
                 auto deser_start = std::chrono::high_resolution_clock::now();
                 
+                size_t index;
+                if (response.sequence() == 0) {
+                    while (next_unnumbered < filled.size() && filled[next_unnumbered]) {
+                        next_unnumbered++;
+                    }
+                    index = next_unnumbered;
+                } else {
+                    index = static_cast<size_t>(response.sequence() - 1);
+                }
+                if (index >= filled.size() || filled[index]) {
+                    LogMessage(LogLevel::Error, "StreamingRead response with unexpected sequence " + std::to_string(response.sequence()));
+                    continue;
+                }
+                
                 PromptChunk chunk;
                 ServerMetrics metrics;
                 bool found = response.found();
@@ -502,8 +700,10 @@ public:
                     chunk.parentHash = protoChunk.parent_hash();
                     chunk.completionId = protoChunk.completion_id();
                     
-                    const auto& bufferData = protoChunk.buffer();
-                    chunk.buffer.assign(bufferData.begin(), bufferData.end());
+                    if (!DecodePayload(protoChunk, chunk.buffer)) {
+                        LogMessage(LogLevel::Error, "Streaming read payload does not decode");
+                        found = false;
+                    }
                     chunk.bufferSize = chunk.buffer.size();
                     
                     chunk.tokens.reserve(protoChunk.tokens().size());
@@ -523,15 +723,23 @@ public:
                     metrics.storage_latency_us = sm.storage_latency_us();
                     metrics.total_latency_us = sm.total_latency_us();
                     metrics.overhead_us = sm.overhead_us();
+                    metrics.queue_wait_us = sm.queue_wait_us();
+                    metrics.bytes_copied = sm.bytes_copied();
                     total_storage_us += sm.storage_latency_us();
                     min_storage_us = std::min(min_storage_us, sm.storage_latency_us());
                     max_storage_us = std::max(max_storage_us, sm.storage_latency_us());
                 }
                 
-                results.emplace_back(found, std::move(chunk), metrics);
+                if (onChunk) {
+                    onChunk(index, found, chunk, metrics);
+                }
+                results[index] = std::make_tuple(found, std::move(chunk), metrics);
+                filled[index] = true;
                 response_count++;
             }
             
+            // Reads end with the call, after which any blocked Write fails and the writer returns
+            writer.join();
             Status status = stream->Finish();
             
             auto stream_end = std::chrono::high_resolution_clock::now();
@@ -576,11 +784,7 @@ public:
                 LogMessage(LogLevel::Error, "StreamingRead RPC failed: " + status.error_message());
             }
             
-            // Fill remaining slots if we got fewer responses than requests
-            while (results.size() < locations.size()) {
-                results.emplace_back(false, PromptChunk{}, ServerMetrics{});
-            }
-            
+            // Slots without a response stay not-found
             return results;
         });
     }
@@ -593,6 +797,10 @@ public:
         logLevel_ = level;
     }
     
+    void SetPayloadCompression(const payload::Options& options) {
+        compression_ = options;
+    }
+    
 private:
     void LogMessage(LogLevel level, const std::string& message) const {
         if (logCallback_ && level <= logLevel_) {
@@ -606,6 +814,7 @@ private:
     std::unique_ptr<KVStoreService::Stub> stub_;
     mutable std::function<void(LogLevel, const std::string&)> logCallback_;
     mutable LogLevel logLevel_ = LogLevel::Information;
+    payload::Options compression_;
 };
 
 // AzureStorageKVStoreLibV2 implementation
@@ -633,6 +842,10 @@ bool AzureStorageKVStoreLibV2::Initialize(const std::string& accountUrl,
     return pImpl_->Initialize(accountUrl, containerName, grpcServer);
 }
 
+void AzureStorageKVStoreLibV2::SetPayloadCompression(const payload::Options& options) {
+    pImpl_->SetPayloadCompression(options);
+}
+
 void AzureStorageKVStoreLibV2::SetLogCallback(LogCallback callback) {
     pImpl_->SetLogCallback(callback);
 }
@@ -646,8 +859,9 @@ LookupResult AzureStorageKVStoreLibV2::Lookup(const std::string& partitionKey,
                                                const std::string& completionId,
                                                TokenIterator tokensBegin,
                                                TokenIterator tokensEnd,
-                                               const std::vector<hash_t>& precomputedHashes) const {
-    return pImpl_->Lookup(partitionKey, completionId, tokensBegin, tokensEnd, precomputedHashes);
+                                               const std::vector<hash_t>& precomputedHashes,
+                                               ProbeStrategy probeStrategy) const {
+    return pImpl_->Lookup(partitionKey, completionId, tokensBegin, tokensEnd, precomputedHashes, probeStrategy);
 }
 
 std::future<std::tuple<bool, PromptChunk, ServerMetrics>> AzureStorageKVStoreLibV2::ReadAsync(
@@ -656,23 +870,29 @@ std::future<std::tuple<bool, PromptChunk, ServerMetrics>> AzureStorageKVStoreLib
     return pImpl_->ReadAsync(location, completionId);
 }
 
-std::future<ServerMetrics> AzureStorageKVStoreLibV2::WriteAsync(const PromptChunk& chunk) {
-    return pImpl_->WriteAsync(chunk);
+std::future<ServerMetrics> AzureStorageKVStoreLibV2::WriteAsync(const PromptChunk& chunk, WriteDurability durability) {
+    return pImpl_->WriteAsync(chunk, durability);
+}
+
+std::future<WriteBatchResult> AzureStorageKVStoreLibV2::WriteBatchAsync(const std::vector<PromptChunk>& chunks,
+                                                                        WriteDurability durability) {
+    return pImpl_->WriteBatchAsync(chunks, durability);
 }
 
 std::future<std::vector<std::tuple<bool, PromptChunk, ServerMetrics>>> AzureStorageKVStoreLibV2::StreamingReadAsync(
     const std::vector<std::string>& locations,
-    const std::string& completionId) const {
-    return pImpl_->StreamingReadAsync(locations, completionId);
+    const std::string& completionId,
+    StreamingReadCallback onChunk) const {
+    return pImpl_->StreamingReadAsync(locations, completionId, std::move(onChunk));
 }
 
 // Explicit template instantiations for common iterator types
 template LookupResult AzureStorageKVStoreLibV2::Lookup<std::vector<Token>::iterator>(
     const std::string&, const std::string&,
     std::vector<Token>::iterator, std::vector<Token>::iterator,
-    const std::vector<hash_t>&) const;
+    const std::vector<hash_t>&, ProbeStrategy) const;
 
 template LookupResult AzureStorageKVStoreLibV2::Lookup<std::vector<Token>::const_iterator>(
     const std::string&, const std::string&,
     std::vector<Token>::const_iterator, std::vector<Token>::const_iterator,
-    const std::vector<hash_t>&) const;
+    const std::vector<hash_t>&, ProbeStrategy) const;
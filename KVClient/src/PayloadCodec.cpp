@@ -0,0 +1,226 @@
+#include "PayloadCodec.h"
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#if defined(KVSTORE_WITH_LZ4)
+#include <lz4.h>
+#endif
+#if defined(KVSTORE_WITH_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace payload {
+namespace {
+
+// Shuffled copy of the input, reused per thread so a 1.2 MB chunk does not allocate every time
+std::vector<uint8_t>& Scratch(size_t size) {
+    thread_local std::vector<uint8_t> scratch;
+    if (scratch.size() < size) {
+        scratch.resize(size);
+    }
+    return scratch;
+}
+
+// Fixed element sizes (fp16/bf16, fp32) let the compiler unroll the lanes and vectorize
+template<size_t W>
+void ShuffleFixed(const uint8_t* in, size_t count, uint8_t* out) {
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t byte = 0; byte < W; ++byte) {
+            out[byte * count + i] = in[i * W + byte];
+        }
+    }
+}
+
+template<size_t W>
+void UnshuffleFixed(const uint8_t* in, size_t count, uint8_t* out) {
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t byte = 0; byte < W; ++byte) {
+            out[i * W + byte] = in[byte * count + i];
+        }
+    }
+}
+
+bool ShuffleEnabled(uint8_t shuffle, size_t size) {
+    return shuffle > 1 && shuffle <= kMaxShuffle && size >= shuffle;
+}
+
+// Compressed size, or 0 if the codec failed or is not compiled in
+size_t Compress(Codec codec, [[maybe_unused]] int level, [[maybe_unused]] const uint8_t* data,
+                [[maybe_unused]] size_t size, [[maybe_unused]] std::string& out) {
+    switch (codec) {
+#if defined(KVSTORE_WITH_LZ4)
+    case Codec::Lz4: {
+        if (size > static_cast<size_t>(LZ4_MAX_INPUT_SIZE)) {
+            return 0;
+        }
+        out.resize(static_cast<size_t>(LZ4_compressBound(static_cast<int>(size))));
+        int written = LZ4_compress_default(reinterpret_cast<const char*>(data), &out[0],
+                                           static_cast<int>(size), static_cast<int>(out.size()));
+        return written > 0 ? static_cast<size_t>(written) : 0;
+    }
+#endif
+#if defined(KVSTORE_WITH_ZSTD)
+    case Codec::Zstd: {
+        out.resize(ZSTD_compressBound(size));
+        size_t written = ZSTD_compress(&out[0], out.size(), data, size, level > 0 ? level : ZSTD_CLEVEL_DEFAULT);
+        return ZSTD_isError(written) ? 0 : written;
+    }
+#endif
+    default:
+        return 0;
+    }
+}
+
+bool Decompress(Codec codec, [[maybe_unused]] const uint8_t* data, [[maybe_unused]] size_t size,
+                [[maybe_unused]] uint8_t* out, [[maybe_unused]] size_t rawSize) {
+    switch (codec) {
+#if defined(KVSTORE_WITH_LZ4)
+    case Codec::Lz4: {
+        if (size > static_cast<size_t>(std::numeric_limits<int>::max())) {
+            return false;
+        }
+        int written = LZ4_decompress_safe(reinterpret_cast<const char*>(data), reinterpret_cast<char*>(out),
+                                          static_cast<int>(size), static_cast<int>(rawSize));
+        return written >= 0 && static_cast<size_t>(written) == rawSize;
+    }
+#endif
+#if defined(KVSTORE_WITH_ZSTD)
+    case Codec::Zstd: {
+        size_t written = ZSTD_decompress(out, rawSize, data, size);
+        return !ZSTD_isError(written) && written == rawSize;
+    }
+#endif
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+bool IsSupported(Codec codec) {
+    switch (codec) {
+    case Codec::None:
+        return true;
+    case Codec::Lz4:
+#if defined(KVSTORE_WITH_LZ4)
+        return true;
+#else
+        return false;
+#endif
+    case Codec::Zstd:
+#if defined(KVSTORE_WITH_ZSTD)
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+const char* CodecName(Codec codec) {
+    switch (codec) {
+    case Codec::None: return "none";
+    case Codec::Lz4: return "lz4";
+    case Codec::Zstd: return "zstd";
+    }
+    return "unknown";
+}
+
+bool ParseCodec(const std::string& name, Codec& codec) {
+    for (Codec candidate : {Codec::None, Codec::Lz4, Codec::Zstd}) {
+        if (name == CodecName(candidate)) {
+            codec = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+Encoding Encode(const uint8_t* data, size_t size, const Options& options, std::string& out) {
+    out.clear();
+    if (options.codec == Codec::None || !IsSupported(options.codec) || size == 0 || size > kMaxRawSize) {
+        return Encoding();
+    }
+
+    const uint8_t* source = data;
+    uint8_t shuffle = ShuffleEnabled(options.shuffle, size) ? options.shuffle : 0;
+    if (shuffle) {
+        auto& scratch = Scratch(size);
+        Shuffle(data, size, shuffle, scratch.data());
+        source = scratch.data();
+    }
+
+    size_t written = Compress(options.codec, options.level, source, size, out);
+    if (written == 0 || written >= size) {
+        out.clear();
+        return Encoding();
+    }
+    out.resize(written);
+
+    Encoding encoding;
+    encoding.codec = options.codec;
+    encoding.shuffle = shuffle;
+    encoding.rawSize = size;
+    return encoding;
+}
+
+bool Decode(const uint8_t* data, size_t size, const Encoding& encoding, uint8_t* out) {
+    if (encoding.IsRaw()) {
+        if (size != encoding.rawSize) {
+            return false;
+        }
+        if (size > 0) {
+            std::memcpy(out, data, size);
+        }
+        return true;
+    }
+    if (encoding.rawSize == 0 || encoding.rawSize > kMaxRawSize || encoding.shuffle > kMaxShuffle) {
+        return false;
+    }
+
+    size_t rawSize = static_cast<size_t>(encoding.rawSize);
+    if (!ShuffleEnabled(encoding.shuffle, rawSize)) {
+        return Decompress(encoding.codec, data, size, out, rawSize);
+    }
+    auto& scratch = Scratch(rawSize);
+    if (!Decompress(encoding.codec, data, size, scratch.data(), rawSize)) {
+        return false;
+    }
+    Unshuffle(scratch.data(), rawSize, encoding.shuffle, out);
+    return true;
+}
+
+void Shuffle(const uint8_t* in, size_t size, size_t elementSize, uint8_t* out) {
+    size_t count = size / elementSize;
+    switch (elementSize) {
+    case 2: ShuffleFixed<2>(in, count, out); break;
+    case 4: ShuffleFixed<4>(in, count, out); break;
+    default:
+        for (size_t byte = 0; byte < elementSize; ++byte) {
+            for (size_t i = 0; i < count; ++i) {
+                out[byte * count + i] = in[i * elementSize + byte];
+            }
+        }
+        break;
+    }
+    std::memcpy(out + count * elementSize, in + count * elementSize, size - count * elementSize);
+}
+
+void Unshuffle(const uint8_t* in, size_t size, size_t elementSize, uint8_t* out) {
+    size_t count = size / elementSize;
+    switch (elementSize) {
+    case 2: UnshuffleFixed<2>(in, count, out); break;
+    case 4: UnshuffleFixed<4>(in, count, out); break;
+    default:
+        for (size_t byte = 0; byte < elementSize; ++byte) {
+            for (size_t i = 0; i < count; ++i) {
+                out[i * elementSize + byte] = in[byte * count + i];
+            }
+        }
+        break;
+    }
+    std::memcpy(out + count * elementSize, in + count * elementSize, size - count * elementSize);
+}
+
+} // namespace payload
@@ -13,6 +13,8 @@
 #include <chrono>
 #include <thread>
 #include <mutex>
+#include <cstring>
+#include <iterator>
 #ifdef _WIN32
 #define NOMINMAX
 #include <windows.h>
@@ -22,6 +24,7 @@
 #endif
 #include "AzureStorageKVStoreLibV2.h"
 #include "KVTypes.h"
+#include "PayloadCodec.h"
 #include <nlohmann/json.hpp>
 #include <azure/core/diagnostics/logger.hpp>
 
@@ -411,7 +414,9 @@ struct TokenBufferManager {
                       << BLOCK_SIZE << " tokens each\n";
         }
         
-        std::vector<std::future<ServerMetrics>> writeFutures;
+        // The whole chain goes out as one WriteBatch; the server overlaps the uploads
+        std::vector<PromptChunk> batch;
+        batch.reserve(completedBlocks.size());
         
         hash_t currentParentHash = lastWrittenHash;  // Start with last written hash from previous flush
         
@@ -468,7 +473,7 @@ struct TokenBufferManager {
             chunk.hash = combinedHash;
             chunk.completionId = completionId;
             
-            writeFutures.push_back(kvStore.WriteAsync(chunk));
+            batch.push_back(std::move(chunk));
             
             // Save hash for lookup operations
             writtenBlockHashes.push_back(combinedHash);
@@ -482,16 +487,20 @@ struct TokenBufferManager {
             totalTokensWritten += BLOCK_SIZE;
         }
         
-        // Wait for all writes to complete
+        // Wait for the batch to complete
         if (verbose) {
-            std::cout << "[Buffer Flush] Waiting for " << writeFutures.size() << " write(s) to complete...\n";
+            std::cout << "[Buffer Flush] Waiting for batch write of " << batch.size() << " block(s) to complete...\n";
         }
         try {
-            for (size_t i = 0; i < writeFutures.size(); ++i) {
-                ServerMetrics serverMetrics = writeFutures[i].get();
-                // Use client E2E time from gRPC client measurement (not .get() time)
-                opStats.addWriteTime(serverMetrics.client_e2e_us);
-                opStats.addWriteServerMetrics(serverMetrics);
+            WriteBatchResult batchResult = kvStore.WriteBatchAsync(batch).get();
+            // One write sample per batch; use client E2E time from gRPC client measurement (not .get() time)
+            opStats.addWriteTime(batchResult.server_metrics.client_e2e_us);
+            opStats.addWriteServerMetrics(batchResult.server_metrics);
+            for (size_t i = 0; i < batchResult.statuses.size(); ++i) {
+                const auto& status = batchResult.statuses[i];
+                if (!status.success) {
+                    throw std::runtime_error("Block " + std::to_string(i + 1) + " write failed: " + status.error);
+                }
                 if (verbose) {
                     std::cout << "[Buffer Flush] Block " << (i + 1) << " write completed\n";
                 }
@@ -1257,6 +1266,99 @@ std::pair<int, OperationStats> runConversation(const std::vector<PrecomputedProm
     return {0, opStats};
 }
 
+// Compression ratio and single-thread throughput of each payload codec on one buffer
+void benchmarkCompression(const std::string& label, const std::vector<uint8_t>& data) {
+    const int rounds = 20;
+    std::cout << "\n" << label << " (" << data.size() << " bytes)\n";
+    std::cout << std::left << std::setw(8) << "codec" << std::setw(9) << "shuffle"
+              << std::right << std::setw(8) << "ratio" << std::setw(14) << "encode MB/s"
+              << std::setw(14) << "decode MB/s" << "\n";
+
+    for (auto codec : {payload::Codec::Lz4, payload::Codec::Zstd}) {
+        if (!payload::IsSupported(codec)) {
+            std::cout << std::left << std::setw(8) << payload::CodecName(codec) << "not built in\n";
+            continue;
+        }
+        for (uint8_t shuffle : {uint8_t(0), uint8_t(2)}) {
+            payload::Options options;
+            options.codec = codec;
+            options.shuffle = shuffle;
+
+            std::string encoded;
+            payload::Encoding encoding;
+            auto start = std::chrono::steady_clock::now();
+            for (int round = 0; round < rounds; ++round) {
+                encoding = payload::Encode(data.data(), data.size(), options, encoded);
+            }
+            double encodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            double decodeSeconds = 0;
+            double ratio = 1.0;
+            if (!encoding.IsRaw()) {
+                ratio = static_cast<double>(data.size()) / encoded.size();
+                std::vector<uint8_t> decoded(data.size());
+                start = std::chrono::steady_clock::now();
+                for (int round = 0; round < rounds; ++round) {
+                    if (!payload::Decode(reinterpret_cast<const uint8_t*>(encoded.data()), encoded.size(),
+                                         encoding, decoded.data())) {
+                        std::cerr << "Decode failed for " << payload::CodecName(codec) << "\n";
+                        break;
+                    }
+                }
+                decodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                if (decoded != data) {
+                    std::cerr << "Round trip mismatch for " << payload::CodecName(codec) << "\n";
+                }
+            }
+
+            double megabytes = static_cast<double>(data.size()) * rounds / (1024.0 * 1024.0);
+            std::cout << std::left << std::setw(8) << payload::CodecName(codec) << std::setw(9) << int(shuffle)
+                      << std::right << std::fixed << std::setprecision(3) << std::setw(8) << ratio
+                      << std::setprecision(0) << std::setw(14) << megabytes / encodeSeconds;
+            if (encoding.IsRaw()) {
+                std::cout << std::setw(14) << "stored raw" << "\n";
+            } else {
+                std::cout << std::setw(14) << megabytes / decodeSeconds << "\n";
+            }
+        }
+    }
+}
+
+// Synthetic bf16 activations: roughly normal values, so exponents cluster like real KV tensors
+std::vector<uint8_t> makeBf16Tensor(size_t bytes) {
+    std::vector<uint8_t> tensor(bytes);
+    uint32_t state = 12345;
+    for (size_t i = 0; i + 1 < bytes; i += 2) {
+        float sum = 0;
+        for (int k = 0; k < 4; ++k) {
+            state = state * 1664525u + 1013904223u;
+            sum += static_cast<float>(state >> 8) / 16777216.0f - 0.5f;
+        }
+        uint32_t bits;
+        std::memcpy(&bits, &sum, sizeof(bits));
+        tensor[i] = static_cast<uint8_t>(bits >> 16);
+        tensor[i + 1] = static_cast<uint8_t>(bits >> 24);
+    }
+    return tensor;
+}
+
+int runCompressionBenchmark(const std::string& file) {
+    std::cout << "\n=== Payload Compression Benchmark ===\n";
+    if (!file.empty()) {
+        std::ifstream input(file, std::ios::binary);
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        if (data.empty()) {
+            std::cerr << "ERROR: Could not read " << file << "\n";
+            return 1;
+        }
+        benchmarkCompression(file, data);
+    } else if (!g_binaryChunk.empty()) {
+        benchmarkCompression("chunk.bin", g_binaryChunk);
+    }
+    benchmarkCompression("synthetic bf16 tensor", makeBf16Tensor(g_binaryChunk.empty() ? 1200 * 1024 : g_binaryChunk.size()));
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     // Note: Using gRPC client - no need to disable Azure SDK logging
     // Azure::Core::Diagnostics::Logger::SetListener(nullptr);
@@ -1282,6 +1384,13 @@ int main(int argc, char* argv[]) {
         std::cerr << "Warning: chunk.bin not found, using empty buffers\n";
     }
     
+    // Offline codec benchmark, no server needed
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--bench-compression") {
+            return runCompressionBenchmark(i + 1 < argc ? argv[i + 1] : "");
+        }
+    }
+    
     // Parse command-line arguments
     std::string tokensFile;
     int iterations = 1;
@@ -1378,6 +1487,7 @@ int main(int argc, char* argv[]) {
         std::cout << "  --log-level, -l <level>    Set log level: error, information, verbose (default: information)\n";
         std::cout << "  --storage, -s <url>        Azure Storage account URL (default: https://azureaoaikv.blob.core.windows.net/)\n";
         std::cout << "  --container, -c <name>     Container name (default: gpt41-promptcache)\n";
+        std::cout << "  --bench-compression [file] Report payload codec ratio and throughput on chunk.bin (or file) and exit\n";
         std::cout << "\nExamples:\n";
         std::cout << "  " << argv[0] << " conversation_tokens.json 5 2 --verbose\n";
         std::cout << "  " << argv[0] << " conversation_tokens.json 5 2 --log-level error\n";
@@ -0,0 +1,75 @@
+// Per-block cost of blob-name generation (pack + base64url) and decode for each
+// instruction set the CPU supports. Lookup does this once per 128-token block,
+// so a 64-block prompt pays 64x the encode figure before issuing any storage call.
+//
+// Usage: BlobNameCodecBench [iterations]
+
+#include "BlobNameCodec.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t kBlockTokens = 128;
+constexpr size_t kDistinctBlocks = 256;   // Cycle through several blocks so one stays out of L1
+
+template<typename Fn>
+double NanosPerCall(size_t iterations, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        fn(i);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t iterations = argc > 1 ? static_cast<size_t>(std::strtoull(argv[1], nullptr, 10)) : 200000;
+
+    std::mt19937_64 rng(42);
+    std::vector<std::vector<Token>> blocks(kDistinctBlocks, std::vector<Token>(kBlockTokens));
+    std::vector<std::string> names(kDistinctBlocks);
+    for (size_t b = 0; b < kDistinctBlocks; ++b) {
+        for (auto& token : blocks[b]) {
+            token = static_cast<Token>(rng() % 200000);   // Typical tokenizer vocabulary range
+        }
+        names[b] = blobname::EncodeTokensToBlobName(blocks[b].cbegin(), blocks[b].cend());
+    }
+
+    std::printf("Blob name codec, %zu-token blocks, %zu iterations (detected: %s)\n",
+                kBlockTokens, iterations, blobname::CodecIsaName(blobname::DetectCodecIsa()));
+    std::printf("%-8s %14s %14s %14s %14s\n", "isa", "pack ns", "encode ns", "decode ns", "hash name ns");
+
+    size_t sink = 0;
+    for (auto isa : {blobname::CodecIsa::Scalar, blobname::CodecIsa::Sse41, blobname::CodecIsa::Avx2}) {
+        if (static_cast<int>(isa) > static_cast<int>(blobname::DetectCodecIsa())) {
+            continue;
+        }
+        blobname::ForceCodecIsa(isa);
+
+        uint8_t packed[blobname::PackedLength(kBlockTokens)];
+        double packNs = NanosPerCall(iterations, [&](size_t i) {
+            blobname::PackTokens(blocks[i % kDistinctBlocks].data(), kBlockTokens, packed);
+            sink += packed[i % sizeof(packed)];
+        });
+        double encodeNs = NanosPerCall(iterations, [&](size_t i) {
+            const auto& block = blocks[i % kDistinctBlocks];
+            sink += blobname::EncodeTokensToBlobName(block.cbegin(), block.cend()).size();
+        });
+        double decodeNs = NanosPerCall(iterations, [&](size_t i) {
+            sink += blobname::DecodeBlobNameToTokens(names[i % kDistinctBlocks]).size();
+        });
+        double hashNs = NanosPerCall(iterations, [&](size_t i) {
+            const auto& block = blocks[i % kDistinctBlocks];
+            sink += blobname::HashTokensToBlobName(block.cbegin(), block.cend())[0];
+        });
+        std::printf("%-8s %14.1f %14.1f %14.1f %14.1f\n", blobname::CodecIsaName(isa), packNs, encodeNs, decodeNs, hashNs);
+    }
+    return sink == 0 ? 1 : 0;
+}
@@ -0,0 +1,141 @@
+// End-to-end cost of one StreamingRead of a 64-block prompt against the in-memory engine,
+// and of a stream well past the server's per-stream in-flight limit, which exercises read
+// pausing and resumption. Server and client share the process and talk over loopback, so
+// storage time is negligible and the figures are dominated by the reactor, the request
+// executor and gRPC framing.
+//
+// Usage: StreamingReadBench [iterations] [payload bytes] [long stream reads]
+
+#include "KVStoreServiceImpl.h"
+#include "InMemoryAccountResolver.h"
+#include <grpcpp/grpcpp.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t kPromptBlocks = 64;
+constexpr size_t kBlockTokens = 128;
+const char* kResource = "bench";
+const char* kContainer = "bench";
+
+double Percentile(std::vector<double> samples, double p) {
+    std::sort(samples.begin(), samples.end());
+    size_t index = static_cast<size_t>(p * static_cast<double>(samples.size() - 1));
+    return samples[index];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t iterations = argc > 1 ? static_cast<size_t>(std::strtoull(argv[1], nullptr, 10)) : 2000;
+    size_t payloadBytes = argc > 2 ? static_cast<size_t>(std::strtoull(argv[2], nullptr, 10)) : 16384;
+    // Default is 8x the server's default --stream-max-inflight
+    size_t longStreamReads = argc > 3 ? static_cast<size_t>(std::strtoull(argv[3], nullptr, 10)) : 512;
+    size_t blocks = std::max(kPromptBlocks, longStreamReads);
+
+    kvstore::AccountResolverConfig config;
+    config.storageEngine = StorageEngineType::InMemory;
+    auto resolver = std::make_shared<kvstore::InMemoryAccountResolver>(config);
+    kvstore::KVStoreServiceImpl service(resolver);
+
+    int port = 0;
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(), &port);
+    builder.RegisterService(&service);
+    auto server = builder.BuildAndStart();
+    if (!server || port == 0) {
+        std::fprintf(stderr, "Failed to start server\n");
+        return 1;
+    }
+
+    // One prompt of chained blocks, written straight to the engine
+    auto store = resolver->ResolveStore(kResource, kContainer);
+    std::vector<Token> tokens(blocks * kBlockTokens);
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        tokens[i] = static_cast<Token>(i % 200000);
+    }
+    for (size_t b = 0; b < blocks; ++b) {
+        std::vector<Token> blockTokens(tokens.begin() + b * kBlockTokens, tokens.begin() + (b + 1) * kBlockTokens);
+        PromptChunk chunk(b + 1, kResource, b, ChunkBuffer(payloadBytes, static_cast<char>('a' + b % 26)), blockTokens);
+        store->WriteAsync(chunk).get();
+    }
+    auto lookup = store->Lookup(kResource, "", tokens.cbegin(), tokens.cend(), {});
+    if (lookup.locations.size() != blocks) {
+        std::fprintf(stderr, "Lookup found %zu of %zu blocks\n", lookup.locations.size(), blocks);
+        return 1;
+    }
+
+    auto channel = grpc::CreateChannel("127.0.0.1:" + std::to_string(port), grpc::InsecureChannelCredentials());
+    auto stub = kvstore::KVStoreService::NewStub(channel);
+
+    std::printf("StreamingRead, %zu-byte blocks, %zu iterations, default limits\n", payloadBytes, iterations);
+    std::printf("%-12s %12s %12s %12s %14s %12s\n", "reads", "mean us", "p50 us", "p99 us", "streams/s", "MB/s");
+
+    size_t failures = 0;
+    for (size_t reads : {kPromptBlocks, longStreamReads}) {
+        std::vector<double> latenciesUs;
+        latenciesUs.reserve(iterations);
+        auto benchStart = std::chrono::steady_clock::now();
+        for (size_t iter = 0; iter < iterations; ++iter) {
+            auto start = std::chrono::steady_clock::now();
+
+            grpc::ClientContext context;
+            auto stream = stub->StreamingRead(&context);
+            // Write while reading, as the client library does: past the in-flight limit the
+            // server waits for responses to drain before it reads more requests
+            std::thread writer([&]() {
+                for (size_t b = 0; b < reads; ++b) {
+                    kvstore::ReadRequest request;
+                    request.set_resource_name(kResource);
+                    request.set_container_name(kContainer);
+                    request.set_location(lookup.locations[b].location);
+                    request.set_sequence(b + 1);
+                    if (!stream->Write(request)) {
+                        break;
+                    }
+                }
+                stream->WritesDone();
+            });
+
+            kvstore::ReadResponse response;
+            size_t received = 0;
+            while (stream->Read(&response)) {
+                if (!response.success() || !response.found()) {
+                    ++failures;
+                }
+                ++received;
+            }
+            writer.join();
+            grpc::Status status = stream->Finish();
+            if (!status.ok() || received != reads) {
+                ++failures;
+            }
+
+            latenciesUs.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        }
+        double elapsedSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - benchStart).count();
+
+        double meanUs = 0;
+        for (double us : latenciesUs) {
+            meanUs += us;
+        }
+        meanUs /= static_cast<double>(latenciesUs.size());
+
+        std::printf("%-12zu %12.1f %12.1f %12.1f %14.1f %12.1f\n", reads,
+                    meanUs, Percentile(latenciesUs, 0.50), Percentile(latenciesUs, 0.99),
+                    static_cast<double>(iterations) / elapsedSec,
+                    static_cast<double>(iterations * reads * payloadBytes) / elapsedSec / (1024.0 * 1024.0));
+    }
+    if (failures > 0) {
+        std::printf("%zu failed reads or streams\n", failures);
+    }
+
+    server->Shutdown();
+    return failures > 0 ? 1 : 0;
+}
@@ -8,19 +8,23 @@
 #include <future>
 #include <functional>
 #include "KVTypes.h"
+#include "IKVStoreEngine.h"
+#include "BlobNameCodec.h"
+#include "BlockMetadataCache.h"
+#include "RecentWriteSet.h"
+#include "BloomFilter.h"
+#include "VersionReclaimer.h"
+#include "DiskChunkCache.h"
+#include "HotChunkCache.h"
+#include "SingleFlight.h"
 #include <azure/storage/blobs.hpp>
 #include <memory>
 #include <sstream>
 #include <iomanip>
-#include <azure/core/base64.hpp>
 #include <chrono>
-
-// Log levels
-enum class LogLevel {
-    Error = 0,      // Errors and failures
-    Information = 1, // Important operations and results (default)
-    Verbose = 2     // Detailed diagnostic information
-};
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 // HTTP Transport Protocol options
 enum class HttpTransportProtocol {
@@ -28,17 +32,65 @@ enum class HttpTransportProtocol {
     LibCurl   // Use libcurl for cross-platform compatibility
 };
 
-// Logging callback type - includes log level
-using LogCallback = std::function<void(LogLevel level, const std::string&)>;
+// Multi-part transfers for payloads too large for one TCP stream to move quickly
+struct ParallelTransferOptions {
+    uint64_t thresholdBytes = 4ull << 20;   // Larger payloads are split; 0 disables
+    uint64_t partBytes = 1ull << 20;        // Staged block / ranged GET size
+    size_t parallelism = 8;                 // Parts in flight per payload
+};
 
 // V2 API: Multi-version blob support with conflict detection
-class AzureStorageKVStoreLibV2 {
+// Azure Blob Storage implementation of IKVStoreEngine
+class AzureStorageKVStoreLibV2 : public IKVStoreEngine {
 public:
+    ~AzureStorageKVStoreLibV2() override;
+
     bool Initialize(const std::string& azureAccountUrl_, const std::string& containerName, HttpTransportProtocol transport = HttpTransportProtocol::WinHTTP, bool enableSdkLogging = true, bool enableMultiNic = false);
     
     // Logging configuration
-    void SetLogCallback(LogCallback callback) { logCallback_ = callback; }
-    void SetLogLevel(LogLevel level) { logLevel_ = level; }
+    void SetLogCallback(LogCallback callback) override { logCallback_ = callback; }
+    void SetLogLevel(LogLevel level) override { logLevel_ = level; }
+    
+    // Block metadata cache configuration (call before Initialize)
+    void SetMetadataCacheOptions(const BlockMetadataCacheOptions& options) { metadataCache_.Configure(options); }
+    BlockMetadataCacheStats GetMetadataCacheStats() const { return metadataCache_.GetStats(); }
+    
+    // Local SSD read-through cache shared across stores (optional, call before Initialize)
+    void SetChunkCache(std::shared_ptr<DiskChunkCache> cache) { chunkCache_ = std::move(cache); }
+    
+    // In-memory hot-chunk cache in front of the SSD cache and storage (optional, shared across stores)
+    void SetHotChunkCache(std::shared_ptr<HotChunkCache> cache) { hotChunkCache_ = std::move(cache); }
+    
+    // Blob naming for token blocks (call before Initialize). With legacyFallback, Hash mode
+    // also finds blocks stored under token names, so existing containers keep serving while
+    // new writes migrate them.
+    void SetBlobNaming(BlobNamingMode mode, bool legacyFallback) {
+        blobNaming_ = mode;
+        legacyNameFallback_ = legacyFallback;
+    }
+    
+    // Background deletion of evicted version blobs (call before Initialize)
+    void SetVersionReclaimerOptions(const VersionReclaimerOptions& options) { versionReclaimerOptions_ = options; }
+    
+    // Staged-block uploads and ranged downloads above a size threshold
+    void SetParallelTransferOptions(const ParallelTransferOptions& options) { transferOptions_ = options; }
+    
+    // Store new alternate versions by payload digest, so identical bytes are uploaded and cached
+    // once per block (call before Initialize). Off writes a private GUID blob per version as before.
+    void SetContentDedup(bool enabled) { contentDedup_ = enabled; }
+    
+    // Versions this server recently confirmed, answered without contacting storage (call before Initialize)
+    void SetRecentWriteOptions(const RecentWriteSetOptions& options) { recentWrites_.Configure(options); }
+    RecentWriteSetStats GetRecentWriteStats() const { return recentWrites_.GetStats(); }
+    
+    // Probe strategy used when a Lookup does not ask for one
+    void SetProbeStrategy(ProbeStrategy strategy) { probeStrategy_ = strategy; }
+    
+    // Blob-name Bloom filter configuration (call before Initialize)
+    void SetBloomFilterOptions(const BloomFilterOptions& options, std::chrono::seconds snapshotInterval) {
+        bloomFilterOptions_ = options;
+        bloomSnapshotInterval_ = snapshotInterval;
+    }
 
     // V2 API: Multi-version support with location-based reads
     template<typename TokenIterator>
@@ -47,52 +99,129 @@ public:
         const std::string& completionId,
         TokenIterator begin,
         TokenIterator end,
-        const std::vector<hash_t>& precomputedHashes
+        const std::vector<hash_t>& precomputedHashes,
+        ProbeStrategy probeStrategy = ProbeStrategy::Default
     ) const;
     
-    std::future<std::pair<bool, PromptChunk>> ReadAsync(const std::string& location, const std::string& completionId = "") const;
-    std::future<void> WriteAsync(const PromptChunk& chunk);
+    // IKVStoreEngine interface
+    LookupResult Lookup(
+        const std::string& partitionKey,
+        const std::string& completionId,
+        std::vector<Token>::const_iterator begin,
+        std::vector<Token>::const_iterator end,
+        const std::vector<hash_t>& precomputedHashes,
+        ProbeStrategy probeStrategy = ProbeStrategy::Default
+    ) const override;
+    
+    std::future<std::pair<bool, PromptChunk>> ReadAsync(const std::string& readLocation, const std::string& completionId = "") const override;
+    std::future<void> WriteAsync(const PromptChunk& chunk) override;
+    // Uploads the chain with at most the executor's per-request fan-out in flight
+    std::future<std::vector<BlockWriteStatus>> WriteBatchAsync(std::vector<PromptChunk> chunks) override;
 
 public:
     template<typename TokenIterator>
     std::string EncodeTokensToBlobName(TokenIterator begin, TokenIterator end) const {
-        std::vector<uint8_t> bytes;
-        for (auto it = begin; it != end; ++it) {
-            uint32_t token = static_cast<uint32_t>(*it);
-            bytes.push_back((token >> 24) & 0xFF);
-            bytes.push_back((token >> 16) & 0xFF);
-            bytes.push_back((token >> 8) & 0xFF);
-            bytes.push_back(token & 0xFF);
-        }
-        return Azure::Core::_internal::Base64Url::Base64UrlEncode(bytes);
+        return blobname::EncodeTokensToBlobName(begin, end);
     }
 
     // Reverse method: decode blob name back to token vector
     std::vector<Token> DecodeBlobNameToTokens(const std::string& blobName) const {
-        std::vector<uint8_t> bytes = Azure::Core::_internal::Base64Url::Base64UrlDecode(blobName);
-        std::vector<Token> tokens;
-        size_t n = bytes.size() / 4;
-        tokens.reserve(n);
-        for (size_t i = 0; i < n; ++i) {
-            uint32_t token = (static_cast<uint32_t>(bytes[i * 4]) << 24) |
-                             (static_cast<uint32_t>(bytes[i * 4 + 1]) << 16) |
-                             (static_cast<uint32_t>(bytes[i * 4 + 2]) << 8) |
-                             (static_cast<uint32_t>(bytes[i * 4 + 3]));
-            tokens.push_back(static_cast<Token>(token));
-        }
-        return tokens;
+        return blobname::DecodeBlobNameToTokens(blobName);
     }
 
 private:
-    mutable std::shared_mutex mutex_;
-    std::unordered_map<hash_t, PromptChunk> store_;
+    // Name of a token block's default blob under the configured naming mode
+    template<typename TokenIterator>
+    std::string BlobNameFor(TokenIterator begin, TokenIterator end) const {
+        return blobNaming_ == BlobNamingMode::Hash ? blobname::HashTokensToBlobName(begin, end)
+                                                   : blobname::EncodeTokensToBlobName(begin, end);
+    }
+
+    // GetProperties on the default blob; refreshes the metadata cache on success.
+    // For hash-named blobs, expectedTokens is checked against the "tokens" metadata so a
+    // hash collision reads as a miss instead of another prefix's data.
+    bool FetchBlockMetadata(const std::string& blobName, BlockMetadata& metadata, const std::string& expectedTokens = "") const;
+    
+    // Upload one block (default blob or a new GUID version); storage errors become a failed status.
+    // Known or probable existing blobs are checked before any payload is sent.
+    BlockWriteStatus WriteChunk(const PromptChunk& chunk);
+    BlockWriteStatus WriteChunkToStorage(const PromptChunk& chunk, const std::string& blobName);
+    
+    // One Upload call, or above the threshold parallel StageBlock calls and a CommitBlockList
+    // carrying the same metadata and access conditions
+    void UploadPayload(const Azure::Storage::Blobs::BlockBlobClient& client, const PromptChunk& chunk,
+                       const Azure::Storage::Blobs::UploadBlockBlobOptions& options) const;
+    // Whole blob into buffer; returns its metadata. Above the threshold the first GET learns the
+    // size and the rest arrives through parallel ranged GETs into the same buffer.
+    Azure::Storage::Metadata DownloadPayload(const Azure::Storage::Blobs::BlobClient& client, ChunkBuffer& buffer) const;
+    
+    // Upload a payload to its content-addressed blob, or touch the blob if it is already there;
+    // true if bytes were sent
+    bool UploadContent(const PromptChunk& chunk, const std::string& location, const ContentDigest& digest);
+    
+    // Body of ReadAsync below the memory cache
+    std::pair<bool, PromptChunk> ReadChunk(const std::string& location, const std::string& completionId, const std::string& cacheKey) const;
+    
+    // In-flight reads (by location) and writes (by blob name and version); duplicates wait for the first
+    mutable SingleFlight<std::pair<bool, PromptChunk>> readFlight_;
+    SingleFlight<BlockWriteStatus> writeFlight_;
+    SingleFlight<bool> contentFlight_;   // By content location
+
+    // Delete blobs with one Blob Batch request, falling back to single deletes if the batch is rejected
+    std::vector<bool> DeleteBlobBatch(const std::vector<std::string>& blobNames) const;
+    
+    // Content GC: deletes a content blob that no version of its block references and that has not
+    // been written within the grace period; anything else is kept or retried later
+    std::vector<bool> ReclaimContentBlobs(const std::vector<std::string>& blobNames) const;
+    
+    VersionReclaimerOptions versionReclaimerOptions_;
+    std::unique_ptr<VersionReclaimer> versionReclaimer_;
+    std::unique_ptr<VersionReclaimer> contentReclaimer_;   // Evicted content blobs, by location
+    
+    // Recently resolved block metadata, kept coherent by WriteAsync
+    mutable BlockMetadataCache metadataCache_;
+    
+    // Exact (blob, hash, parentHash) versions confirmed by WriteAsync; erased when this server evicts them
+    RecentWriteSet recentWrites_;
+    
+    std::shared_ptr<DiskChunkCache> chunkCache_;
+    std::shared_ptr<HotChunkCache> hotChunkCache_;
+    
+    BlobNamingMode blobNaming_ = BlobNamingMode::Tokens;
+    bool legacyNameFallback_ = false;
+    bool contentDedup_ = true;
+    ParallelTransferOptions transferOptions_;
+    
+    ProbeStrategy probeStrategy_ = ProbeStrategy::Parallel;
+    static constexpr size_t kInitialProbeWave = 4;
 
     std::string azureAccountUrl_;
     std::string azureContainerName_;
     std::shared_ptr<Azure::Storage::Blobs::BlobContainerClient> blobContainerClient_;
 
-    // std::unique_ptr<BloomFilter> blobNameFilter_;
+    // Bloom filter over every token-block blob name in the container
+    // Loaded from the snapshot blob at Initialize, updated on WriteAsync and merged back into
+    // the snapshot by a background thread. Other instances' writes become visible at their next
+    // snapshot, so Lookup confirms a negative with one probe before ending the chain on it.
+    // The snapshot is only trusted as complete if the last instance to write it shut down cleanly.
+    static constexpr const char* kBloomFilterBlobName = "__kvstore_bloomfilter";
+    void LoadBloomFilter();
+    void RebuildBloomFilter();
+    bool SnapshotBloomFilter(bool closing = false);
+    void BloomFilterSnapshotLoop(bool rebuild);
+    void StopBloomFilterSnapshots();
+    void AddToBloomFilter(const std::string& blobName) const;
+
+    BloomFilterOptions bloomFilterOptions_;
+    std::chrono::seconds bloomSnapshotInterval_{60};
+    std::unique_ptr<BloomFilter> blobNameFilter_;
     std::shared_ptr<Azure::Storage::Blobs::BlobClient> bloomFilterBlobClient_;
+    std::string bloomSnapshotETag_;              // ETag of the last snapshot we wrote or merged
+    mutable std::atomic<bool> bloomFilterDirty_{false};  // Names added since the last snapshot
+    std::thread bloomSnapshotThread_;
+    std::mutex bloomSnapshotMutex_;
+    std::condition_variable bloomSnapshotCv_;
+    bool bloomSnapshotStopping_ = false;
     
     // Logging
     LogLevel logLevel_ = LogLevel::Error;  // Default to Error level
@@ -134,5 +263,6 @@ extern template LookupResult AzureStorageKVStoreLibV2::Lookup<std::vector<Token>
     const std::string&,
     std::vector<Token>::const_iterator,
     std::vector<Token>::const_iterator,
-    const std::vector<hash_t>&
+    const std::vector<hash_t>&,
+    ProbeStrategy
 ) const;
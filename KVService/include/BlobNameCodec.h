@@ -0,0 +1,179 @@
+#pragma once
+
+#include "KVTypes.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+// How token blocks are named in blob storage
+enum class BlobNamingMode {
+    Tokens,   // base64url of the packed tokens (~683 characters per 128-token block)
+    Hash      // 32 hex characters of a 128-bit hash of the packed tokens
+};
+
+// Token block <-> blob name encoding shared by all storage engines
+// Tokens are packed as big-endian uint32 and base64url-encoded without padding,
+// which matches Azure::Core::_internal::Base64Url so existing containers keep their names.
+// The pointer-based kernels write into caller-provided buffers and are vectorized
+// (SSE4.1 / AVX2, picked at runtime from CPUID) with a scalar fallback; see BlobNameCodec.cpp.
+namespace blobname {
+
+enum class CodecIsa { Scalar, Sse41, Avx2 };
+
+// Best instruction set supported by this CPU, and the one the kernels currently use
+CodecIsa DetectCodecIsa();
+CodecIsa ActiveCodecIsa();
+// Pin the kernels to an instruction set (clamped to what the CPU supports); for benchmarks
+void ForceCodecIsa(CodecIsa isa);
+const char* CodecIsaName(CodecIsa isa);
+
+constexpr size_t kMaxStackTokens = 128;   // One token block; larger inputs fall back to the heap
+
+constexpr size_t PackedLength(size_t tokenCount) { return tokenCount * 4; }
+constexpr size_t EncodedLength(size_t byteCount) { return (byteCount * 4 + 2) / 3; }
+constexpr size_t DecodedLength(size_t charCount) { return charCount * 3 / 4; }
+
+// Low 32 bits of each token as big-endian bytes; out must hold PackedLength(count)
+void PackTokens(const Token* tokens, size_t count, uint8_t* out);
+// Inverse of PackTokens; out must hold count tokens
+void UnpackTokens(const uint8_t* bytes, size_t count, Token* out);
+
+// out must hold EncodedLength(length) characters; returns the number written
+size_t Base64UrlEncode(const uint8_t* bytes, size_t length, char* out);
+// Unpadded base64url; out must hold DecodedLength(length) bytes.
+// Returns false if the input contains characters outside the alphabet.
+bool Base64UrlDecode(const char* text, size_t length, uint8_t* out, size_t* written);
+
+inline std::string Base64UrlEncode(const std::vector<uint8_t>& bytes) {
+    std::string out(EncodedLength(bytes.size()), '\0');
+    out.resize(Base64UrlEncode(bytes.data(), bytes.size(), &out[0]));
+    return out;
+}
+
+// Returns an empty vector if the input contains characters outside the base64url alphabet
+inline std::vector<uint8_t> Base64UrlDecode(const std::string& text) {
+    size_t length = std::min(text.find('='), text.size());
+    std::vector<uint8_t> out(DecodedLength(length));
+    size_t written = 0;
+    if (!Base64UrlDecode(text.data(), length, out.data(), &written)) {
+        return {};
+    }
+    out.resize(written);
+    return out;
+}
+
+std::string EncodeTokensToBlobName(const Token* tokens, size_t count);
+std::vector<Token> DecodeBlobNameToTokens(const std::string& blobName);
+
+namespace detail {
+
+// Calls fn(const Token*, size_t) on the range, without copying when it is contiguous
+template<typename TokenIterator, typename Fn>
+auto WithContiguousTokens(TokenIterator begin, TokenIterator end, Fn&& fn) {
+    constexpr bool contiguous = std::is_same_v<TokenIterator, std::vector<Token>::const_iterator> ||
+                                std::is_same_v<TokenIterator, std::vector<Token>::iterator> ||
+                                std::is_same_v<TokenIterator, const Token*> ||
+                                std::is_same_v<TokenIterator, Token*>;
+    if constexpr (contiguous) {
+        size_t count = static_cast<size_t>(std::distance(begin, end));
+        return fn(count ? &*begin : nullptr, count);
+    } else {
+        std::vector<Token> tokens(begin, end);
+        return fn(tokens.data(), tokens.size());
+    }
+}
+
+} // namespace detail
+
+template<typename TokenIterator>
+std::vector<uint8_t> PackTokens(TokenIterator begin, TokenIterator end) {
+    return detail::WithContiguousTokens(begin, end, [](const Token* tokens, size_t count) {
+        std::vector<uint8_t> bytes(PackedLength(count));
+        PackTokens(tokens, count, bytes.data());
+        return bytes;
+    });
+}
+
+template<typename TokenIterator>
+std::string EncodeTokensToBlobName(TokenIterator begin, TokenIterator end) {
+    return detail::WithContiguousTokens(begin, end, [](const Token* tokens, size_t count) {
+        return EncodeTokensToBlobName(tokens, count);
+    });
+}
+
+// MurmurHash3 x64_128 (public domain, Austin Appleby). Input is read as little-endian
+// words regardless of host byte order, so names are identical on every platform.
+inline std::pair<uint64_t, uint64_t> Hash128(const uint8_t* data, size_t length, uint64_t seed = 0) {
+    auto rotl = [](uint64_t x, int r) { return (x << r) | (x >> (64 - r)); };
+    auto fmix = [](uint64_t k) {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ULL;
+        k ^= k >> 33;
+        return k;
+    };
+    auto load = [](const uint8_t* p, size_t n) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < n; ++i) {
+            value |= static_cast<uint64_t>(p[i]) << (8 * i);
+        }
+        return value;
+    };
+
+    const uint64_t c1 = 0x87c37b91114253d5ULL;
+    const uint64_t c2 = 0x4cf5ad432745937fULL;
+    uint64_t h1 = seed;
+    uint64_t h2 = seed;
+
+    size_t blocks = length / 16;
+    for (size_t i = 0; i < blocks; ++i) {
+        uint64_t k1 = load(data + i * 16, 8);
+        uint64_t k2 = load(data + i * 16 + 8, 8);
+
+        k1 *= c1; k1 = rotl(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = rotl(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+
+        k2 *= c2; k2 = rotl(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = rotl(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    const uint8_t* tail = data + blocks * 16;
+    size_t remaining = length & 15;
+    if (remaining > 8) {
+        uint64_t k2 = load(tail + 8, remaining - 8);
+        k2 *= c2; k2 = rotl(k2, 33); k2 *= c1; h2 ^= k2;
+    }
+    if (remaining > 0) {
+        uint64_t k1 = load(tail, remaining < 8 ? remaining : 8);
+        k1 *= c1; k1 = rotl(k1, 31); k1 *= c2; h1 ^= k1;
+    }
+
+    h1 ^= length;
+    h2 ^= length;
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix(h1);
+    h2 = fmix(h2);
+    h1 += h2;
+    h2 += h1;
+    return {h1, h2};
+}
+
+// Fixed-width name for BlobNamingMode::Hash: 32 lowercase hex characters.
+// Never collides with token names (those are base64url and far longer) or "16hex-16hex" version GUIDs.
+std::string HashTokensToBlobName(const Token* tokens, size_t count);
+
+template<typename TokenIterator>
+std::string HashTokensToBlobName(TokenIterator begin, TokenIterator end) {
+    return detail::WithContiguousTokens(begin, end, [](const Token* tokens, size_t count) {
+        return HashTokensToBlobName(tokens, count);
+    });
+}
+
+} // namespace blobname
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "KVTypes.h"
+#include "VersionIndex.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Version metadata of one token-block blob, as stored on the default blob
+struct BlockMetadata {
+    hash_t hash = 0;
+    hash_t parentHash = 0;
+    VersionIndex additionalVersions;
+};
+
+struct BlockMetadataCacheOptions {
+    size_t maxEntries = 262144;  // 0 disables the cache
+    // Bound on staleness when other server instances write to the same container
+    std::chrono::milliseconds ttl = std::chrono::milliseconds(60000);
+};
+
+struct BlockMetadataCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+};
+
+// Bounded, sharded LRU cache of block metadata keyed by blob name
+// Lets Lookup skip the per-block GetProperties for recently resolved prefixes.
+// Only positive results are cached; a block written by another instance shows up
+// after the cached chain stops matching (Lookup then falls back to storage) or the TTL expires.
+class BlockMetadataCache {
+public:
+    static constexpr size_t kShardCount = 64;
+
+    explicit BlockMetadataCache(const BlockMetadataCacheOptions& options = {});
+
+    // Drops all entries and applies new limits (call before the cache is shared)
+    void Configure(const BlockMetadataCacheOptions& options);
+
+    bool Enabled() const { return maxEntriesPerShard_ > 0; }
+
+    bool Get(const std::string& blobName, BlockMetadata& metadata);
+    void Put(const std::string& blobName, BlockMetadata metadata);
+    void Invalidate(const std::string& blobName);
+
+    BlockMetadataCacheStats GetStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        std::string blobName;
+        BlockMetadata metadata;
+        Clock::time_point expiresAt;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> lru;  // Most recently used first
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    };
+
+    Shard& GetShard(const std::string& blobName);
+
+    std::array<Shard, kShardCount> shards_;
+    size_t maxEntriesPerShard_ = 0;
+    std::chrono::milliseconds ttl_{0};
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+};
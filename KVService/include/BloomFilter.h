@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct BloomFilterOptions {
+    bool enabled = true;
+    size_t expectedBlobs = 8 * 1024 * 1024;   // ~10 MB per container at 10 bits per blob
+    size_t bitsPerBlob = 10;                  // ~1% false positive rate
+    size_t shardCount = 64;
+};
+
+// Sharded, cache-line-blocked Bloom filter over token-block blob names
+// Each name maps to one 64-byte block (8 x uint64) in one shard and sets one bit per word,
+// so a query touches a single cache line. Bits are set with atomic OR, so Add/MightContain
+// need no locks. Hashes are stable across processes so snapshots can be shared and merged.
+class BloomFilter {
+public:
+    static constexpr size_t kWordsPerBlock = 8;
+
+    explicit BloomFilter(const BloomFilterOptions& options);
+
+    void Add(const std::string& blobName);
+    bool MightContain(const std::string& blobName) const;
+
+    // A complete filter has seen every blob name in the container, so a negative answer
+    // is definite. Filters that started on a non-empty container without a snapshot are not.
+    bool IsComplete() const { return complete_.load(std::memory_order_acquire); }
+    void SetComplete(bool complete) { complete_.store(complete, std::memory_order_release); }
+
+    // Snapshot format (host byte order): "KVBF", version, flags, shardCount, wordsPerShard, words
+    std::vector<uint8_t> Serialize() const;
+    static std::unique_ptr<BloomFilter> Deserialize(const std::vector<uint8_t>& data);
+
+    // OR another filter's bits into this one; false if the geometry differs.
+    // Merging a complete filter makes this one complete (it becomes a superset).
+    bool Merge(const BloomFilter& other);
+
+    bool SameGeometry(const BloomFilter& other) const;
+    size_t SizeBytes() const { return shardCount_ * wordsPerShard_ * sizeof(uint64_t); }
+
+private:
+    struct alignas(64) Block {
+        std::atomic<uint64_t> words[kWordsPerBlock];
+    };
+
+    BloomFilter(size_t shardCount, size_t blocksPerShard);
+
+    static uint64_t HashName(const std::string& blobName);
+    Block& LocateBlock(uint64_t hash) const;
+
+    size_t shardCount_;
+    size_t blocksPerShard_;
+    size_t wordsPerShard_;
+    mutable std::vector<std::vector<Block>> shards_;
+    std::atomic<bool> complete_{false};
+};
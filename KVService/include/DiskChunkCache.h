@@ -0,0 +1,71 @@
+#pragma once
+
+#include "IKVStoreEngine.h"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct DiskChunkCacheOptions {
+    std::string path = "kvstore-chunk-cache";
+    uint64_t maxBytes = 0;   // 0 disables the cache
+};
+
+struct DiskChunkCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t bytes = 0;
+    size_t entries = 0;
+};
+
+// Read-through chunk cache on local SSD, shared by all Azure stores of a server
+// Chunks are immutable once written (token-named blobs are created with IfNoneMatch and
+// version blobs get fresh GUIDs), so entries never need invalidation - only eviction.
+// The LRU index lives in memory and is rebuilt from the file headers at Initialize.
+// Layout: <path>/<xx>/<fnv64(key)>.chunk, written to a temp file and renamed into place.
+class DiskChunkCache {
+public:
+    DiskChunkCache() = default;
+
+    void SetLogCallback(LogCallback callback) { logCallback_ = std::move(callback); }
+
+    // Creates the directory and loads the index, evicting down to the byte budget
+    bool Initialize(const DiskChunkCacheOptions& options);
+
+    bool Get(const std::string& key, PromptChunk& chunk);
+    void Put(const std::string& key, const PromptChunk& chunk);
+
+    DiskChunkCacheStats GetStats() const;
+
+private:
+    struct Entry {
+        std::filesystem::path path;
+        uint64_t bytes = 0;
+        std::list<std::string>::iterator lruIt;
+    };
+
+    std::filesystem::path PathForKey(const std::string& key) const;
+    void Insert(const std::string& key, const std::filesystem::path& path, uint64_t bytes);
+    void Erase(const std::string& key);
+    // Caller holds mutex_; returns the files to delete once the lock is released
+    std::vector<std::filesystem::path> EvictToBudget();
+
+    DiskChunkCacheOptions options_;
+    std::filesystem::path root_;
+
+    mutable std::mutex mutex_;
+    std::list<std::string> lru_;   // Most recently used first
+    std::unordered_map<std::string, Entry> index_;
+    uint64_t bytes_ = 0;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+
+    LogCallback logCallback_;
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "KVTypes.h"
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct HotChunkCacheOptions {
+    uint64_t maxBytes = 0;          // 0 disables the cache
+    double windowFraction = 0.01;   // Share of the budget for the admission window
+};
+
+struct HotChunkCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t rejections = 0;        // Candidates refused by the frequency filter
+    uint64_t bytes = 0;
+    size_t entries = 0;
+};
+
+// In-memory cache of the hottest chunks, shared by all Azure stores of a server
+// W-TinyLFU: new chunks enter a small LRU window; when they leave it they are only admitted
+// to the main segmented LRU (probation/protected) if a count-min sketch says they are read
+// more often than the entry they would displace. One-off conversation tails therefore
+// pass through the window without flushing shared system-prompt chunks.
+// Chunks are shared immutably, so Get never copies under the lock.
+class HotChunkCache {
+public:
+    explicit HotChunkCache(const HotChunkCacheOptions& options);
+
+    std::shared_ptr<const PromptChunk> Get(const std::string& key);
+    void Put(const std::string& key, std::shared_ptr<const PromptChunk> chunk);
+
+    HotChunkCacheStats GetStats() const;
+
+private:
+    // 4-row count-min sketch of 4-bit-saturating counters, halved periodically so
+    // the frequencies track recent popularity
+    class FrequencySketch {
+    public:
+        explicit FrequencySketch(size_t expectedEntries);
+        void Increment(uint64_t hash);
+        uint8_t Estimate(uint64_t hash) const;
+
+    private:
+        static constexpr size_t kDepth = 4;
+        static constexpr uint8_t kMaxCount = 15;
+        size_t Index(uint64_t hash, size_t row) const;
+
+        std::vector<uint8_t> counters_;
+        size_t widthMask_;
+        size_t samples_ = 0;
+        size_t sampleLimit_;
+    };
+
+    enum class Segment : uint8_t { Window, Probation, Protected };
+
+    struct Region {
+        std::list<std::string> lru;   // Most recently used first
+        uint64_t bytes = 0;
+    };
+
+    struct Entry {
+        std::shared_ptr<const PromptChunk> chunk;
+        uint64_t bytes = 0;
+        Segment segment = Segment::Window;
+        std::list<std::string>::iterator lruIt;
+    };
+
+    static uint64_t HashKey(const std::string& key);
+    Region& RegionFor(Segment segment);
+    void MoveTo(Entry& entry, Segment segment);
+    void Remove(const std::string& key);
+    // Window overflow goes through the admission filter into probation
+    void Admit(const std::string& key);
+
+    uint64_t windowCapacity_;
+    uint64_t mainCapacity_;
+    uint64_t protectedCapacity_;
+
+    mutable std::mutex mutex_;
+    FrequencySketch sketch_;
+    Region window_;
+    Region probation_;
+    Region protected_;
+    std::unordered_map<std::string, Entry> index_;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> rejections_{0};
+};
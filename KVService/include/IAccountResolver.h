@@ -1,6 +1,6 @@
 #pragma once
 
-#include "AzureStorageKVStoreLibV2.h"
+#include "IKVStoreEngine.h"
 #include <memory>
 #include <string>
 
@@ -16,15 +16,15 @@ struct AccountInfo {
 
 // Interface for resolving resource names to KVStore instances
 // This abstraction allows different resolution strategies:
-// - InMemoryAccountResolver: Simple DNS suffix appending
-// - Future: DatabaseAccountResolver for complex account lookups
+// - InMemoryAccountResolver: Simple DNS suffix appending (any storage engine)
+// - StorageDatabaseResolver: Account lookup through the configuration store
 class IAccountResolver {
 public:
     virtual ~IAccountResolver() = default;
 
     // Resolve a resource name and container to a KVStore instance
     // Returns nullptr if resolution fails
-    virtual std::shared_ptr<AzureStorageKVStoreLibV2> ResolveStore(
+    virtual std::shared_ptr<IKVStoreEngine> ResolveStore(
         const std::string& resourceName,
         const std::string& containerName) = 0;
 
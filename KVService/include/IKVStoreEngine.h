@@ -0,0 +1,81 @@
+#pragma once
+
+#include "KVTypes.h"
+#include <string>
+#include <vector>
+#include <future>
+#include <functional>
+#include <exception>
+#include <utility>
+
+// Log levels
+enum class LogLevel {
+    Error = 0,      // Errors and failures
+    Information = 1, // Important operations and results (default)
+    Verbose = 2     // Detailed diagnostic information
+};
+
+// Logging callback type - includes log level
+using LogCallback = std::function<void(LogLevel level, const std::string&)>;
+
+// Storage engine implementations that can back a resolved store
+enum class StorageEngineType {
+    AzureBlob,  // Azure Blob Storage (AzureStorageKVStoreLibV2, default)
+    InMemory,   // Sharded in-process maps - no persistence, for load testing
+    LocalDisk   // Local filesystem - low-latency local tier
+};
+
+// Storage engine interface behind the gRPC reactors
+// All engines keep the V2 multi-version semantics: one default version per token block
+// plus additional (hash, parentHash) versions at separate locations, resolved by parent chain
+class IKVStoreEngine {
+public:
+    virtual ~IKVStoreEngine() = default;
+
+    // Logging configuration
+    virtual void SetLogCallback(LogCallback callback) = 0;
+    virtual void SetLogLevel(LogLevel level) = 0;
+
+    // Find the longest cached prefix of 128-token blocks and the location of each block
+    // probeStrategy only affects engines backed by remote storage
+    virtual LookupResult Lookup(
+        const std::string& partitionKey,
+        const std::string& completionId,
+        std::vector<Token>::const_iterator begin,
+        std::vector<Token>::const_iterator end,
+        const std::vector<hash_t>& precomputedHashes,
+        ProbeStrategy probeStrategy = ProbeStrategy::Default
+    ) const = 0;
+
+    // Read a chunk from a location returned by Lookup
+    virtual std::future<std::pair<bool, PromptChunk>> ReadAsync(const std::string& location, const std::string& completionId = "") const = 0;
+
+    // Write a chunk; adds a new version when the block exists with a different parent
+    virtual std::future<void> WriteAsync(const PromptChunk& chunk) = 0;
+
+    // Write an ordered block chain (each chunk's parentHash already links to the previous one)
+    // and report one status per chunk, in order. The default issues WriteAsync per chunk and
+    // completes once all of them have; engines backed by remote storage bound the parallelism.
+    virtual std::future<std::vector<BlockWriteStatus>> WriteBatchAsync(std::vector<PromptChunk> chunks) {
+        std::vector<std::future<void>> writes;
+        writes.reserve(chunks.size());
+        for (const auto& chunk : chunks) {
+            writes.push_back(WriteAsync(chunk));
+        }
+
+        std::vector<BlockWriteStatus> statuses;
+        statuses.reserve(chunks.size());
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            try {
+                writes[i].get();
+                statuses.emplace_back(chunks[i].hash, true);
+            } catch (const std::exception& e) {
+                statuses.emplace_back(chunks[i].hash, false, e.what());
+            }
+        }
+
+        std::promise<std::vector<BlockWriteStatus>> promise;
+        promise.set_value(std::move(statuses));
+        return promise.get_future();
+    }
+};
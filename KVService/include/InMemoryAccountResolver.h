@@ -1,6 +1,7 @@
 #pragma once
 
 #include "IAccountResolver.h"
+#include "AzureStorageKVStoreLibV2.h"
 #include <unordered_map>
 #include <shared_mutex>
 #include <functional>
@@ -26,11 +27,51 @@ struct AccountResolverConfig {
     
     // Log level for KVStore instances
     LogLevel logLevel = LogLevel::Error;
+    
+    // Block metadata cache for Azure stores
+    BlockMetadataCacheOptions metadataCache;
+    
+    // Lookup probe strategy for Azure stores, with per-container overrides
+    ::ProbeStrategy probeStrategy = ::ProbeStrategy::Parallel;
+    std::unordered_map<std::string, ::ProbeStrategy> containerProbeStrategies;
+    
+    // Blob-name Bloom filter for Azure stores and how often it is snapshotted to the container
+    BloomFilterOptions bloomFilter;
+    std::chrono::seconds bloomSnapshotInterval = std::chrono::seconds(60);
+    
+    // Local SSD chunk cache shared by all Azure stores (null disables)
+    std::shared_ptr<DiskChunkCache> chunkCache;
+    
+    // In-memory hot-chunk cache shared by all Azure stores (null disables)
+    std::shared_ptr<HotChunkCache> hotChunkCache;
+    
+    // Blob naming for Azure stores; legacy fallback also finds token-named blobs in Hash mode
+    BlobNamingMode blobNaming = BlobNamingMode::Tokens;
+    bool legacyNameFallback = true;
+    
+    // Batching and rate limit for deleting evicted version blobs in Azure stores
+    VersionReclaimerOptions versionReclaimer;
+    
+    // Content-addressed storage of additional version payloads in Azure stores
+    bool contentDedup = true;
+    
+    // Staged-block uploads and ranged downloads of large payloads in Azure stores
+    ParallelTransferOptions parallelTransfer;
+    
+    // Recently confirmed block versions whose rewrites Azure stores answer locally
+    RecentWriteSetOptions recentWrites;
+    
+    // Storage engine created for each resolved store
+    StorageEngineType storageEngine = StorageEngineType::AzureBlob;
+    
+    // Root directory for the LocalDisk engine (one subdirectory per resource/container)
+    std::string localStoragePath = "kvstore-data";
 };
 
 // In-memory implementation of IAccountResolver
 // Resolves resource names by appending configured DNS suffix
 // Caches KVStore instances for reuse
+// With a non-Azure storageEngine, each resource/container gets its own offline engine
 class InMemoryAccountResolver : public IAccountResolver {
 public:
     using LogCallback = std::function<void(LogLevel, const std::string&)>;
@@ -39,7 +80,7 @@ public:
     ~InMemoryAccountResolver() override = default;
 
     // IAccountResolver interface
-    std::shared_ptr<AzureStorageKVStoreLibV2> ResolveStore(
+    std::shared_ptr<IKVStoreEngine> ResolveStore(
         const std::string& resourceName,
         const std::string& containerName) override;
 
@@ -64,7 +105,8 @@ private:
     std::string GetStoreKey(const std::string& resourceName, const std::string& containerName) const;
 
     // Create a new KVStore instance
-    std::shared_ptr<AzureStorageKVStoreLibV2> CreateStore(
+    std::shared_ptr<IKVStoreEngine> CreateStore(
+        const std::string& resourceName,
         const std::string& accountUrl,
         const std::string& containerName);
 
@@ -77,7 +119,7 @@ private:
 
     // Cache of KVStore instances
     mutable std::shared_mutex storesMutex_;
-    std::unordered_map<std::string, std::shared_ptr<AzureStorageKVStoreLibV2>> stores_;
+    std::unordered_map<std::string, std::shared_ptr<IKVStoreEngine>> stores_;
 
     // Last error
     mutable std::string lastError_;
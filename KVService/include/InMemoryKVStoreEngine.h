@@ -0,0 +1,34 @@
+#pragma once
+
+#include "LocalKVStoreEngine.h"
+#include <array>
+#include <shared_mutex>
+#include <unordered_map>
+
+// Sharded in-memory storage engine
+// Nothing is persisted; intended for measuring reactor, gRPC and serialization
+// overhead without storage noise. Reads and writes complete on the calling thread.
+class InMemoryKVStoreEngine : public LocalKVStoreEngine {
+public:
+    InMemoryKVStoreEngine() = default;
+    ~InMemoryKVStoreEngine() override = default;
+
+    std::future<std::pair<bool, PromptChunk>> ReadAsync(const std::string& location, const std::string& completionId = "") const override;
+    std::future<void> WriteAsync(const PromptChunk& chunk) override;
+
+protected:
+    bool PutPayload(const std::string& location, const PromptChunk& chunk) override;
+    bool GetPayload(const std::string& location, PromptChunk& chunk) const override;
+    void RemovePayload(const std::string& location) override;
+
+private:
+    struct PayloadShard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, PromptChunk> payloads;
+    };
+
+    PayloadShard& GetPayloadShard(const std::string& location);
+    const PayloadShard& GetPayloadShard(const std::string& location) const;
+
+    std::array<PayloadShard, kShardCount> payloadShards_;
+};
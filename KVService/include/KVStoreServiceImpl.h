@@ -3,7 +3,12 @@
 #include <grpcpp/grpcpp.h>
 #include "kvstore.grpc.pb.h"
 #include "IAccountResolver.h"
+#include "WriteBehindQueue.h"
+#include "PayloadCodec.h"
+#include <atomic>
 #include <memory>
+#include <string>
+#include <unordered_map>
 
 namespace kvstore {
 
@@ -11,8 +16,19 @@ namespace kvstore {
 class LookupReactor;
 class ReadReactor;
 class WriteReactor;
+class WriteBatchReactor;
 class StreamingReadReactor;
 
+// Backpressure for StreamingRead (0 = unlimited)
+struct StreamingReadLimits {
+    // Requests a stream may have accepted but not yet written back; further reads wait
+    size_t maxInFlightPerStream = 64;
+    // Payload bytes of read responses waiting to be written, across all streams. A stream over
+    // budget stops reading requests until its own responses drain, but one with nothing
+    // outstanding may always take one more so no stream stalls on the others.
+    size_t responseBudgetBytes = 1024ull * 1024 * 1024;
+};
+
 // KV Store gRPC Service Implementation (Async Callback API)
 // This service provides high-performance, low-latency access to the KV Store
 // Uses async callback API for better performance (no thread pool blocking)
@@ -27,6 +43,7 @@ public:
     friend class LookupReactor;
     friend class ReadReactor;
     friend class WriteReactor;
+    friend class WriteBatchReactor;
     friend class StreamingReadReactor;
 
     // Lookup operation - finds cached blocks matching the token sequence (async callback)
@@ -47,6 +64,12 @@ public:
         const WriteRequest* request,
         WriteResponse* response) override;
 
+    // WriteBatch operation - stores an ordered block chain in one call (async callback)
+    grpc::ServerUnaryReactor* WriteBatch(
+        grpc::CallbackServerContext* context,
+        const WriteBatchRequest* request,
+        WriteBatchResponse* response) override;
+
     // Streaming Read operation - retrieves multiple chunks with pipelined requests
     grpc::ServerBidiReactor<ReadRequest, ReadResponse>* StreamingRead(
         grpc::CallbackServerContext* context) override;
@@ -58,9 +81,38 @@ public:
     // Get the account resolver (for reactors to use)
     IAccountResolver* GetAccountResolver() { return accountResolver_.get(); }
 
+    // Write-behind queue for Write/WriteBatch requests that ask for early acknowledgement (optional)
+    void SetWriteBehindQueue(std::shared_ptr<WriteBehindQueue> queue) { writeBehind_ = std::move(queue); }
+    WriteBehindQueue* GetWriteBehindQueue() { return writeBehind_.get(); }
+
+    // Payload compression for stored chunks: a default plus per-container overrides (call before serving)
+    void SetPayloadOptions(const payload::Options& defaults,
+                           const std::unordered_map<std::string, payload::Options>& containers = {}) {
+        payloadDefaults_ = defaults;
+        containerPayloadOptions_ = containers;
+    }
+    const payload::Options& GetPayloadOptions(const std::string& containerName) const {
+        auto it = containerPayloadOptions_.find(containerName);
+        return it != containerPayloadOptions_.end() ? it->second : payloadDefaults_;
+    }
+
+    // StreamingRead backpressure (call before serving)
+    void SetStreamingReadLimits(const StreamingReadLimits& limits);
+    const StreamingReadLimits& GetStreamingReadLimits() const { return streamingReadLimits_; }
+
+    // Global StreamingRead response budget: charge when a response is queued, release once written
+    bool ResponseBudgetExceeded() const;
+    void ChargeResponseBytes(size_t bytes);
+    void ReleaseResponseBytes(size_t bytes);
+
 private:
     // Account resolver for resource name -> KVStore mapping
     std::shared_ptr<IAccountResolver> accountResolver_;
+    std::shared_ptr<WriteBehindQueue> writeBehind_;
+    payload::Options payloadDefaults_;
+    std::unordered_map<std::string, payload::Options> containerPayloadOptions_;
+    StreamingReadLimits streamingReadLimits_;
+    std::atomic<size_t> bufferedResponseBytes_{0};
 
     // Configuration
     LogLevel logLevel_ = LogLevel::Error;
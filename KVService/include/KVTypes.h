@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <vector>
 #include <string>
+#include "PayloadCodec.h"
 
 // Type representing an inference token
 using Token = int64_t;
@@ -13,23 +14,34 @@ using hash_t = uint64_t;
 // Type representing a vector of hash values                
 using HashVector = std::vector<hash_t>;
 
+// Chunk payload bytes. Protobuf bytes fields are std::string, so a payload read from
+// storage can be moved into a gRPC response without copying.
+using ChunkBuffer = std::string;
+
 // Struct representing a prompt chunk
 struct PromptChunk {
     hash_t hash;
     std::string partitionKey;
     hash_t parentHash;
-    std::vector<uint8_t> buffer; // binary buffer
+    ChunkBuffer buffer;          // binary buffer
     size_t bufferSize;           // size of the buffer
     std::vector<Token> tokens;   // vector of tokens for this chunk
     std::string completionId;    // completion/run identifier for logging
+    size_t bytesCopied;          // Payload bytes copied in memory while serving this read
+    payload::Encoding encoding;  // How buffer is encoded (raw unless compressed); engines store it with the payload
 
     PromptChunk()
-        : hash(0), partitionKey(), parentHash(0), buffer(), bufferSize(0), tokens(), completionId() {}
+        : hash(0), partitionKey(), parentHash(0), buffer(), bufferSize(0), tokens(), completionId(), bytesCopied(0), encoding() {}
 
-    PromptChunk(hash_t h, const std::string& pk, hash_t ph, const std::vector<uint8_t>& buf, const std::vector<Token>& toks = {}, const std::string& cid = "")
-        : hash(h), partitionKey(pk), parentHash(ph), buffer(buf), bufferSize(buf.size()), tokens(toks), completionId(cid) {}
+    PromptChunk(hash_t h, const std::string& pk, hash_t ph, const ChunkBuffer& buf, const std::vector<Token>& toks = {}, const std::string& cid = "")
+        : hash(h), partitionKey(pk), parentHash(ph), buffer(buf), bufferSize(buf.size()), tokens(toks), completionId(cid), bytesCopied(0), encoding() {}
 };
 
+// Payload data as the byte pointer the storage SDK expects
+inline const uint8_t* ChunkData(const ChunkBuffer& buffer) {
+    return reinterpret_cast<const uint8_t*>(buffer.data());
+}
+
 // V2 API: Block location (token-based blob name OR GUID for multi-version)
 struct BlockLocation {
     hash_t hash;
@@ -39,12 +51,34 @@ struct BlockLocation {
     BlockLocation(hash_t h, const std::string& loc) : hash(h), location(loc) {}
 };
 
+// Outcome of one block of a batch write
+struct BlockWriteStatus {
+    hash_t hash;
+    bool success;        // Stored, or an identical version already existed
+    std::string error;   // Set when success is false
+    bool permanent = false;   // The same write would fail again (e.g. a blob name collision)
+
+    BlockWriteStatus() : hash(0), success(false), error() {}
+    BlockWriteStatus(hash_t h, bool ok, const std::string& err = "") : hash(h), success(ok), error(err) {}
+};
+
+// How Lookup probes storage for the cached prefix
+enum class ProbeStrategy {
+    Default,    // Use the store's configured strategy
+    Parallel,   // Probe every block at once (one round trip, wasteful for short prefixes)
+    Waves,      // Contiguous waves that double in size until the chain breaks
+    Galloping,  // Exponential search for the first missing block, then binary search
+    Binary      // Binary search for the first missing block between the first and last block
+};
+
 // V2 API: Lookup result with locations
 struct LookupResult {
     int cachedBlocks;
     hash_t lastHash;
     std::vector<BlockLocation> locations;
+    int probesIssued;   // Storage metadata requests made by this lookup
+    int probesWasted;   // Probes past the block that ended the chain
     
-    LookupResult() : cachedBlocks(0), lastHash(0), locations() {}
-    LookupResult(int blocks, hash_t hash) : cachedBlocks(blocks), lastHash(hash), locations() {}
+    LookupResult() : cachedBlocks(0), lastHash(0), locations(), probesIssued(0), probesWasted(0) {}
+    LookupResult(int blocks, hash_t hash) : cachedBlocks(blocks), lastHash(hash), locations(), probesIssued(0), probesWasted(0) {}
 };
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "LocalKVStoreEngine.h"
+#include <filesystem>
+
+// Local filesystem storage engine
+// Layout under the root directory:
+//   index/<fnv64(blobName)>.meta  - version record for one token block (small, rewritten on change)
+//   chunks/<location>.chunk       - payload + chunk metadata, written once
+// The in-memory index is rebuilt from index/ at Initialize. Files are written to a
+// temporary name and renamed into place so a crash never leaves a torn record.
+class LocalDiskKVStoreEngine : public LocalKVStoreEngine {
+public:
+    LocalDiskKVStoreEngine() = default;
+    ~LocalDiskKVStoreEngine() override = default;
+
+    // Open (creating if needed) the store rooted at rootPath and load its index
+    bool Initialize(const std::string& rootPath);
+
+    std::future<std::pair<bool, PromptChunk>> ReadAsync(const std::string& location, const std::string& completionId = "") const override;
+    std::future<void> WriteAsync(const PromptChunk& chunk) override;
+
+protected:
+    bool PutPayload(const std::string& location, const PromptChunk& chunk) override;
+    bool GetPayload(const std::string& location, PromptChunk& chunk) const override;
+    void RemovePayload(const std::string& location) override;
+    void OnRecordUpdated(const std::string& blobName, const LocalBlockRecord& record) override;
+
+private:
+    static bool IsChunkLocation(const std::string& location);
+    std::filesystem::path ChunkPath(const std::string& location) const;
+    std::filesystem::path IndexPath(const std::string& blobName) const;
+
+    std::filesystem::path root_;
+    std::filesystem::path indexDir_;
+    std::filesystem::path chunkDir_;
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "IKVStoreEngine.h"
+#include <array>
+#include <shared_mutex>
+#include <unordered_map>
+#include <string>
+#include <vector>
+
+// One stored version of a token block
+struct LocalBlockVersion {
+    hash_t hash = 0;
+    hash_t parentHash = 0;
+    std::string location;   // Payload location returned by Lookup and passed to ReadAsync
+};
+
+// Index record for one token-block blob name
+struct LocalBlockRecord {
+    LocalBlockVersion defaultVersion;
+    std::vector<LocalBlockVersion> additionalVersions;  // FIFO order, oldest first
+};
+
+// Shared base for the offline engines (in-memory and local disk)
+// Keeps the blob-name -> version index in sharded maps and implements the same
+// multi-version Lookup/Write semantics as AzureStorageKVStoreLibV2.
+// Derived engines only decide where payloads live.
+class LocalKVStoreEngine : public IKVStoreEngine {
+public:
+    static constexpr size_t kBlockSize = 128;
+    static constexpr size_t kMaxVersions = 60;   // Same FIFO cap as the Azure engine
+    static constexpr size_t kShardCount = 64;
+
+    ~LocalKVStoreEngine() override = default;
+
+    // IKVStoreEngine interface
+    void SetLogCallback(LogCallback callback) override { logCallback_ = std::move(callback); }
+    void SetLogLevel(LogLevel level) override { logLevel_ = level; }
+
+    LookupResult Lookup(
+        const std::string& partitionKey,
+        const std::string& completionId,
+        std::vector<Token>::const_iterator begin,
+        std::vector<Token>::const_iterator end,
+        const std::vector<hash_t>& precomputedHashes,
+        ProbeStrategy probeStrategy = ProbeStrategy::Default
+    ) const override;
+
+protected:
+    // Payload storage hooks implemented by each engine
+    // PutPayload is called before the version is published to the index, so readers
+    // never observe a location whose payload is missing
+    virtual bool PutPayload(const std::string& location, const PromptChunk& chunk) = 0;
+    virtual bool GetPayload(const std::string& location, PromptChunk& chunk) const = 0;
+    virtual void RemovePayload(const std::string& location) = 0;
+
+    // Persistence hook - called with the shard lock held whenever a record changes
+    virtual void OnRecordUpdated(const std::string& /*blobName*/, const LocalBlockRecord& /*record*/) {}
+
+    // Synchronous operations wrapped by the derived engines' ReadAsync/WriteAsync
+    std::pair<bool, PromptChunk> Read(const std::string& location, const std::string& completionId) const;
+    void Write(const PromptChunk& chunk);
+
+    // Insert a record without touching payloads (index rebuild at startup)
+    void LoadRecord(const std::string& blobName, LocalBlockRecord record);
+
+    void Log(LogLevel level, const std::string& message, const std::string& completionId = "") const;
+
+private:
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, LocalBlockRecord> records;
+    };
+
+    Shard& GetShard(const std::string& blobName);
+    const Shard& GetShard(const std::string& blobName) const;
+
+    static bool HasVersion(const LocalBlockRecord& record, hash_t hash, hash_t parentHash);
+    static std::string GenerateLocation();
+
+    std::array<Shard, kShardCount> shards_;
+
+    LogLevel logLevel_ = LogLevel::Error;
+    LogCallback logCallback_;
+};
@@ -2,7 +2,10 @@
 
 #include <string>
 #include <atomic>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
 
 namespace kvstore {
 
@@ -19,6 +22,14 @@ public:
     void RecordOverhead(const std::string& method, double overhead_ms);
     void IncrementRequestCount(const std::string& method, bool success);
     
+    // Named counters and gauges for storage-layer components (executors, caches, ...)
+    // RecordLatency accumulates "<name>.count" and "<name>.total_us" counters
+    void IncrementCounter(const std::string& name, uint64_t delta = 1);
+    void SetGauge(const std::string& name, int64_t value);
+    void RecordLatency(const std::string& name, int64_t latency_us);
+    uint64_t GetCounter(const std::string& name) const;
+    int64_t GetGauge(const std::string& name) const;
+    
     bool IsInitialized() const { return initialized_; }
     
     // Get aggregated stats
@@ -31,6 +42,12 @@ private:
     MetricsHelper(const MetricsHelper&) = delete;
     MetricsHelper& operator=(const MetricsHelper&) = delete;
     
+    // Returns the slot for a name, creating it on first use
+    std::atomic<int64_t>& GetSlot(std::unordered_map<std::string, std::unique_ptr<std::atomic<int64_t>>>& slots,
+                                  const std::string& name);
+    int64_t ReadSlot(const std::unordered_map<std::string, std::unique_ptr<std::atomic<int64_t>>>& slots,
+                     const std::string& name) const;
+    
     std::mutex mutex_;
     bool initialized_ = false;
     std::string endpoint_;
@@ -39,6 +56,11 @@ private:
     // Simple atomic counters for basic stats
     std::atomic<uint64_t> request_count_{0};
     std::atomic<uint64_t> error_count_{0};
+    
+    // Named counters/gauges - slots are never removed, so references stay valid
+    mutable std::shared_mutex slotsMutex_;
+    std::unordered_map<std::string, std::unique_ptr<std::atomic<int64_t>>> counters_;
+    std::unordered_map<std::string, std::unique_ptr<std::atomic<int64_t>>> gauges_;
 };
 
 } // namespace kvstore
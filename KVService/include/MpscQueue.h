@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Unbounded multi-producer, single-consumer queue
+// Producers push onto a lock-free stack with one CAS; the consumer detaches everything
+// pushed so far with one exchange and restores arrival order, so it never contends with
+// producers item by item. Only one thread at a time may call PopAll.
+template<typename T>
+class MpscQueue {
+public:
+    MpscQueue() = default;
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    ~MpscQueue() {
+        Free(head_.exchange(nullptr, std::memory_order_acquire));
+    }
+
+    void Push(T value) {
+        Node* node = new Node{std::move(value), head_.load(std::memory_order_relaxed)};
+        while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    bool Empty() const {
+        return head_.load(std::memory_order_acquire) == nullptr;
+    }
+
+    // Move every queued item, oldest first, into out (any container with push_back)
+    // Returns the number of items taken.
+    template<typename Container>
+    size_t PopAll(Container& out) {
+        Node* newest = head_.exchange(nullptr, std::memory_order_acquire);
+        Node* oldest = nullptr;
+        size_t count = 0;
+        while (newest) {
+            Node* next = newest->next;
+            newest->next = oldest;
+            oldest = newest;
+            newest = next;
+            ++count;
+        }
+        while (oldest) {
+            Node* next = oldest->next;
+            out.push_back(std::move(oldest->value));
+            delete oldest;
+            oldest = next;
+        }
+        return count;
+    }
+
+private:
+    struct Node {
+        T value;
+        Node* next;
+    };
+
+    static void Free(Node* node) {
+        while (node) {
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    std::atomic<Node*> head_{nullptr};
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Optional compression of chunk payloads (KV cache tensors, ~1.2 MB per block)
+// LZ4 favours speed and zstd ratio. The byte-shuffle pre-filter regroups the bytes of
+// fixed-size elements (2 for fp16/bf16, 4 for fp32) so that all high bytes, which hold the
+// sign and exponent and repeat a lot, sit next to each other; both codecs gain noticeably on
+// tensor data from it. Codecs not compiled in (KVSTORE_WITH_LZ4 / KVSTORE_WITH_ZSTD) report
+// unsupported, and payloads then stay raw. KVClient carries an identical copy of this codec.
+namespace payload {
+
+enum class Codec : uint8_t {
+    None = 0,
+    Lz4 = 1,
+    Zstd = 2
+};
+
+// How a stored or transmitted payload is encoded
+struct Encoding {
+    Codec codec = Codec::None;
+    uint8_t shuffle = 0;     // Element size the bytes were shuffled by (0 = not shuffled)
+    uint64_t rawSize = 0;    // Decoded size; only meaningful when codec is not None
+
+    bool IsRaw() const { return codec == Codec::None; }
+};
+
+// What a writer asks for
+struct Options {
+    Codec codec = Codec::None;
+    uint8_t shuffle = 0;     // Element size for the shuffle pre-filter, 0 or 1 disables
+    int level = 0;           // zstd level (0 = zstd default); LZ4 ignores it
+};
+
+constexpr uint8_t kMaxShuffle = 16;
+constexpr uint64_t kMaxRawSize = 1ull << 30;   // Decode refuses anything larger
+
+bool IsSupported(Codec codec);
+const char* CodecName(Codec codec);
+// Accepts "none", "lz4" and "zstd"
+bool ParseCodec(const std::string& name, Codec& codec);
+
+// Compress size bytes into out. Returns the encoding applied, which is raw (out left empty)
+// when the codec is unavailable or would not make the payload smaller.
+Encoding Encode(const uint8_t* data, size_t size, const Options& options, std::string& out);
+
+// Decode size bytes into out, which must hold encoding.rawSize bytes.
+// False if the codec is unavailable or the data does not decode to exactly rawSize bytes.
+bool Decode(const uint8_t* data, size_t size, const Encoding& encoding, uint8_t* out);
+
+// Byte transpose of size / elementSize elements; trailing bytes are copied as they are
+void Shuffle(const uint8_t* in, size_t size, size_t elementSize, uint8_t* out);
+void Unshuffle(const uint8_t* in, size_t size, size_t elementSize, uint8_t* out);
+
+} // namespace payload
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "KVTypes.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+struct RecentWriteSetOptions {
+    size_t maxEntries = 262144;   // Per store, 0 disables the set
+    // Bound on staleness when another instance evicts a version this one recorded
+    std::chrono::milliseconds ttl = std::chrono::milliseconds(60000);
+};
+
+struct RecentWriteSetStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    size_t entries = 0;
+};
+
+// Block versions (blob name, hash, parentHash) this server recently confirmed in storage
+// Lets a rewrite of a shared prefix return before any HEAD or payload is sent. Unlike the
+// block metadata cache, which holds whole version indexes and follows Lookup traffic, an
+// entry here is a 24-byte key: a 64-bit blob-name hash plus the exact hash and parentHash,
+// so a false match needs a name-hash collision between blocks with identical version hashes.
+// Each shard keeps two generations: the newer one is demoted when it fills up or turns ttl/2
+// old, and the older one is dropped at that point or once it started more than ttl ago.
+class RecentWriteSet {
+public:
+    static constexpr size_t kShardCount = 64;
+
+    explicit RecentWriteSet(const RecentWriteSetOptions& options = {});
+
+    // Drops all entries and applies new limits (call before the set is shared)
+    void Configure(const RecentWriteSetOptions& options);
+
+    bool Enabled() const { return maxEntriesPerGeneration_ > 0; }
+
+    bool Contains(const std::string& blobName, hash_t hash, hash_t parentHash);
+    void Insert(const std::string& blobName, hash_t hash, hash_t parentHash);
+    // Called when this server evicts the version from the block's index
+    void Erase(const std::string& blobName, hash_t hash, hash_t parentHash);
+
+    RecentWriteSetStats GetStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Key {
+        uint64_t nameHash;
+        hash_t hash;
+        hash_t parentHash;
+
+        bool operator==(const Key& other) const {
+            return nameHash == other.nameHash && hash == other.hash && parentHash == other.parentHash;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_set<Key, KeyHash> current;
+        std::unordered_set<Key, KeyHash> previous;
+        Clock::time_point currentSince;
+        Clock::time_point previousSince;
+    };
+
+    static Key MakeKey(const std::string& blobName, hash_t hash, hash_t parentHash);
+    Shard& GetShard(const Key& key);
+    // Shard lock held
+    void Rotate(Shard& shard, Clock::time_point now);
+
+    std::array<Shard, kShardCount> shards_;
+    size_t maxEntriesPerGeneration_ = 0;
+    std::chrono::milliseconds ttl_{0};
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "RequestPriority.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct RequestExecutorOptions {
+    size_t threads = 0;              // 0 = one per processor; the server passes --threads
+    size_t maxQueueDepth = 4096;     // Across all nodes; beyond this TrySubmit rejects
+    bool numaAware = true;           // Per-node queues and worker affinity; false = one shared queue
+    // A lower-class task queued this long is taken ahead of higher classes
+    std::chrono::milliseconds starvationLimit = kDefaultStarvationLimit;
+};
+
+struct RequestExecutorStats {
+    size_t nodes = 0;
+    size_t threads = 0;
+    size_t queueDepth = 0;
+    std::array<size_t, kRequestPriorityCount> queueDepthByPriority{};
+    size_t peakQueueDepth = 0;
+    int64_t recentQueueWaitUs = 0;   // Moving average of enqueue -> start wait
+    uint64_t tasksExecuted = 0;
+    uint64_t tasksStolen = 0;        // Run by a worker of another node
+    uint64_t tasksRejected = 0;      // Refused by a full queue
+    uint64_t tasksPromoted = 0;      // Taken ahead of a higher class after the starvation limit
+};
+
+// Server-wide pool that runs the blocking part of every RPC
+// Replaces a detached std::thread per request in the reactors. Workers are grouped per NUMA
+// node and pinned to its processors; a task is queued on the node of the thread submitting it
+// (where the request was decoded) and idle workers steal from other nodes before sleeping.
+// Each node queues per RequestPriority class; workers take the highest class queued on any
+// node, so a Lookup never waits behind queued writes, and run the task at that class.
+// Storage calls made by a task still fan out on StorageIoExecutor. Queue depth and wait time
+// are published to MetricsHelper as request_executor.* metrics.
+class RequestExecutor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static RequestExecutor& GetInstance();
+
+    // Call before the first request; later calls only change the queue limit
+    void Configure(const RequestExecutorOptions& options);
+
+    // Queue a task; false (task not run) if the queue is full or the executor is stopping
+    bool TrySubmit(std::function<void()> task, RequestPriority priority = RequestPriority::Normal);
+
+    RequestExecutorStats GetStats() const;
+
+    ~RequestExecutor();
+
+private:
+    struct QueuedTask {
+        std::function<void()> fn;
+        Clock::time_point enqueuedAt;
+        RequestPriority priority = RequestPriority::Normal;
+    };
+
+    struct Node {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::array<std::deque<QueuedTask>, kRequestPriorityCount> queues;
+        size_t queued = 0;            // Across all classes
+        size_t idle = 0;              // Workers waiting on cv
+        size_t stealRequests = 0;     // Wakeups asking an idle worker to look at other nodes
+        uint32_t osNode = 0;
+        size_t workers = 0;
+        // Processors of the node within the process affinity; empty = workers are not pinned
+        std::vector<uint32_t> cpus;   // Linux CPU ids
+        uint16_t group = 0;           // Windows processor group and mask
+        uint64_t groupMask = 0;
+    };
+
+    RequestExecutor() = default;
+    RequestExecutor(const RequestExecutor&) = delete;
+    RequestExecutor& operator=(const RequestExecutor&) = delete;
+
+    // Detect nodes and start workers; startMutex_ held
+    void Start();
+    void WorkerLoop(size_t node);
+    bool TryTake(size_t node, QueuedTask& task, bool& stolen);
+    // Node of the calling thread's current processor (round-robin if unknown)
+    size_t SubmitNode();
+    void Run(QueuedTask& task, bool stolen);
+
+    std::mutex startMutex_;
+    RequestExecutorOptions options_;
+    std::vector<std::unique_ptr<Node>> nodes_;
+    std::vector<int32_t> cpuToNode_;   // Processor index -> node index, -1 if outside the process mask
+    std::vector<std::thread> workers_;
+    std::atomic<bool> started_{false};
+    std::atomic<bool> stopping_{false};
+
+    std::atomic<size_t> maxQueueDepth_{4096};
+    std::atomic<size_t> queued_{0};
+    std::array<std::atomic<size_t>, kRequestPriorityCount> queuedByPriority_{};
+    std::atomic<size_t> peakQueueDepth_{0};
+    std::atomic<int64_t> recentQueueWaitUs_{0};
+    std::atomic<size_t> nextNode_{0};
+
+    std::atomic<uint64_t> tasksExecuted_{0};
+    std::atomic<uint64_t> tasksStolen_{0};
+    std::atomic<uint64_t> tasksRejected_{0};
+    std::atomic<uint64_t> tasksPromoted_{0};
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Scheduling class of a request, highest first
+// Lookup is on the time-to-first-token path, so by default it runs High, reads Normal and
+// writes Low; a client can override this per request. The request executor and the storage
+// I/O executor both serve higher classes first, and storage calls inherit the class of the
+// request that issued them. Work outside any request (write-behind flushes, reclaim) is Low.
+enum class RequestPriority : uint8_t {
+    High = 0,
+    Normal = 1,
+    Low = 2
+};
+
+constexpr size_t kRequestPriorityCount = 3;
+
+// A queued task that has waited this long is served ahead of higher classes
+constexpr auto kDefaultStarvationLimit = std::chrono::milliseconds(250);
+
+inline const char* RequestPriorityName(RequestPriority priority) {
+    switch (priority) {
+    case RequestPriority::High: return "high";
+    case RequestPriority::Normal: return "normal";
+    default: return "low";
+    }
+}
+
+// "high", "normal" or "low"; false (priority untouched) for anything else
+inline bool ParseRequestPriority(const std::string& text, RequestPriority& priority) {
+    for (size_t i = 0; i < kRequestPriorityCount; ++i) {
+        auto candidate = static_cast<RequestPriority>(i);
+        if (text == RequestPriorityName(candidate)) {
+            priority = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+namespace detail {
+inline thread_local RequestPriority t_requestPriority = RequestPriority::Low;
+}
+
+// Class of the request the calling thread is working for
+inline RequestPriority CurrentRequestPriority() {
+    return detail::t_requestPriority;
+}
+
+// Sets the calling thread's class for a scope (executors do this around each task)
+class ScopedRequestPriority {
+public:
+    explicit ScopedRequestPriority(RequestPriority priority) : previous_(detail::t_requestPriority) {
+        detail::t_requestPriority = priority;
+    }
+    ~ScopedRequestPriority() {
+        detail::t_requestPriority = previous_;
+    }
+    ScopedRequestPriority(const ScopedRequestPriority&) = delete;
+    ScopedRequestPriority& operator=(const ScopedRequestPriority&) = delete;
+
+private:
+    RequestPriority previous_;
+};
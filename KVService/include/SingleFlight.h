@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+// Coalesces concurrent calls for the same key into one execution
+// The first caller runs fn; callers arriving while it is in flight wait for its result (or
+// exception) and get a copy. Results are only copied when somebody actually waited, and a key
+// is forgotten as soon as its call completes, so later calls run again.
+template<typename T>
+class SingleFlight {
+public:
+    // coalesced (optional) is set to true when this call reused another caller's result
+    template<typename F>
+    T Do(const std::string& key, F&& fn, bool* coalesced = nullptr) {
+        std::promise<T> promise;
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = inFlight_.find(key);
+        if (it != inFlight_.end()) {
+            ++it->second.waiters;
+            std::shared_future<T> result = it->second.result;
+            lock.unlock();
+            if (coalesced) {
+                *coalesced = true;
+            }
+            return result.get();
+        }
+        inFlight_.emplace(key, Flight{promise.get_future().share(), 0});
+        lock.unlock();
+        if (coalesced) {
+            *coalesced = false;
+        }
+
+        try {
+            T result = fn();
+            if (Retire(key) > 0) {
+                promise.set_value(result);
+            }
+            return result;
+        } catch (...) {
+            if (Retire(key) > 0) {
+                promise.set_exception(std::current_exception());
+            }
+            throw;
+        }
+    }
+
+private:
+    struct Flight {
+        std::shared_future<T> result;
+        size_t waiters;
+    };
+
+    // Remove the key; returns how many callers are waiting on its result
+    size_t Retire(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = inFlight_.find(key);
+        size_t waiters = it->second.waiters;
+        inFlight_.erase(it);
+        return waiters;
+    }
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, Flight> inFlight_;
+};
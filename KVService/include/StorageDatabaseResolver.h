@@ -1,6 +1,7 @@
 #pragma once
 
 #include "IAccountResolver.h"
+#include "AzureStorageKVStoreLibV2.h"
 #include "ServiceConfig.h"
 #include <unordered_map>
 #include <shared_mutex>
@@ -28,6 +29,39 @@ struct StorageDatabaseResolverConfig {
     
     // Log level for KVStore instances
     LogLevel logLevel = LogLevel::Error;
+    
+    // Block metadata cache for Azure stores
+    BlockMetadataCacheOptions metadataCache;
+    
+    // Lookup probe strategy for Azure stores, with per-container overrides
+    ::ProbeStrategy probeStrategy = ::ProbeStrategy::Parallel;
+    std::unordered_map<std::string, ::ProbeStrategy> containerProbeStrategies;
+    
+    // Blob-name Bloom filter for Azure stores and how often it is snapshotted to the container
+    BloomFilterOptions bloomFilter;
+    std::chrono::seconds bloomSnapshotInterval = std::chrono::seconds(60);
+    
+    // Local SSD chunk cache shared by all Azure stores (null disables)
+    std::shared_ptr<DiskChunkCache> chunkCache;
+    
+    // In-memory hot-chunk cache shared by all Azure stores (null disables)
+    std::shared_ptr<HotChunkCache> hotChunkCache;
+    
+    // Blob naming for Azure stores; legacy fallback also finds token-named blobs in Hash mode
+    BlobNamingMode blobNaming = BlobNamingMode::Tokens;
+    bool legacyNameFallback = true;
+    
+    // Batching and rate limit for deleting evicted version blobs in Azure stores
+    VersionReclaimerOptions versionReclaimer;
+    
+    // Content-addressed storage of additional version payloads in Azure stores
+    bool contentDedup = true;
+    
+    // Staged-block uploads and ranged downloads of large payloads in Azure stores
+    ParallelTransferOptions parallelTransfer;
+    
+    // Recently confirmed block versions whose rewrites Azure stores answer locally
+    RecentWriteSetOptions recentWrites;
 };
 
 // Parsed account configuration from the config store
@@ -54,7 +88,7 @@ public:
     ~StorageDatabaseResolver() override = default;
 
     // IAccountResolver interface
-    std::shared_ptr<AzureStorageKVStoreLibV2> ResolveStore(
+    std::shared_ptr<IKVStoreEngine> ResolveStore(
         const std::string& resourceName,
         const std::string& containerName) override;
 
@@ -119,7 +153,7 @@ private:
 
     // Cache of KVStore instances (resourceName|containerName -> KVStore)
     mutable std::shared_mutex storesMutex_;
-    std::unordered_map<std::string, std::shared_ptr<AzureStorageKVStoreLibV2>> stores_;
+    std::unordered_map<std::string, std::shared_ptr<IKVStoreEngine>> stores_;
 
     // Last error
     mutable std::string lastError_;
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "RequestPriority.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+struct StorageIoExecutorOptions {
+    size_t threads = 128;              // Storage calls block on the network, so size for concurrency
+    size_t maxQueueDepth = 4096;       // Beyond this, Submit runs the task on the calling thread
+    size_t maxFanOutPerRequest = 32;   // Parallel storage calls a single Lookup may issue
+    // A lower-class call queued this long is started ahead of higher classes
+    std::chrono::milliseconds starvationLimit = kDefaultStarvationLimit;
+};
+
+struct StorageIoExecutorStats {
+    size_t queueDepth = 0;
+    std::array<size_t, kRequestPriorityCount> queueDepthByPriority{};
+    size_t peakQueueDepth = 0;
+    int64_t recentQueueWaitUs = 0;     // Moving average of enqueue -> start wait
+    uint64_t tasksExecuted = 0;
+    uint64_t tasksRunInline = 0;       // Rejected by a full queue and run by the caller
+    uint64_t tasksPromoted = 0;        // Started ahead of a higher class after the starvation limit
+};
+
+// Shared, bounded thread pool for blocking storage I/O
+// Replaces one std::async thread per storage call in the engines. Workers start on
+// first use; a full queue pushes work back onto the caller instead of growing without bound.
+// Calls queue under the RequestPriority of the submitting thread and workers start the highest
+// class first, so a Lookup's probes are not stuck behind queued payload uploads.
+// Queue depth and wait time are published to MetricsHelper as storage_io.* metrics.
+class StorageIoExecutor {
+public:
+    static StorageIoExecutor& GetInstance();
+
+    // Call before the first storage operation; later calls only change the limits, not the thread count
+    void Configure(const StorageIoExecutorOptions& options);
+
+    // Run a task on the pool and return its future
+    template<typename F>
+    auto Submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>>;
+
+    // Run body(i) for i in [0, count) with at most maxParallelism calls in flight
+    // (0 = configured per-request fan-out). The caller works through items too, so this
+    // never deadlocks when called from a pool thread. Rethrows the first exception from body.
+    void ParallelFor(size_t count, size_t maxParallelism, const std::function<void(size_t)>& body);
+
+    StorageIoExecutorStats GetStats() const;
+
+    ~StorageIoExecutor();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct QueuedTask {
+        std::function<void()> fn;
+        Clock::time_point enqueuedAt;
+        RequestPriority priority = RequestPriority::Low;
+    };
+
+    StorageIoExecutor() = default;
+    StorageIoExecutor(const StorageIoExecutor&) = delete;
+    StorageIoExecutor& operator=(const StorageIoExecutor&) = delete;
+
+    // Queues at the calling thread's class; returns false if the queue is full
+    bool TryEnqueue(std::function<void()> fn);
+    // Next task to start, highest class first; mutex_ held and queued_ > 0
+    QueuedTask PopNext(Clock::time_point now);
+    void RecordRunInline();
+    void StartWorkers();
+    void WorkerLoop();
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::array<std::deque<QueuedTask>, kRequestPriorityCount> queues_;
+    size_t queued_ = 0;
+    std::vector<std::thread> workers_;
+    bool stopping_ = false;
+
+    StorageIoExecutorOptions options_;
+    size_t peakQueueDepth_ = 0;
+    int64_t recentQueueWaitUs_ = 0;
+
+    std::atomic<uint64_t> tasksExecuted_{0};
+    std::atomic<uint64_t> tasksRunInline_{0};
+    std::atomic<uint64_t> tasksPromoted_{0};
+};
+
+template<typename F>
+auto StorageIoExecutor::Submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+    using Result = std::invoke_result_t<std::decay_t<F>>;
+
+    // std::function needs a copyable target, so the packaged_task lives behind a shared_ptr
+    auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+    auto future = packaged->get_future();
+
+    if (!TryEnqueue([packaged]() { (*packaged)(); })) {
+        RecordRunInline();
+        (*packaged)();
+    }
+    return future;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "ContentHash.h"
+#include "KVTypes.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Where an alternate version's payload is stored
+enum class VersionPayload : uint8_t {
+    Guid = 0,      // Its own GUID-named blob, deleted when the version is evicted
+    Content = 1,   // Content-addressed blob shared by the block's versions with the same bytes
+    Default = 2    // Byte-identical to the block's default blob
+};
+
+// One alternate version of a token block
+struct VersionRecord {
+    hash_t hash = 0;
+    hash_t parentHash = 0;
+    VersionPayload payload = VersionPayload::Guid;
+    uint64_t locationHigh = 0;   // Guid: location "16hex-16hex" as two 64-bit halves
+    uint64_t locationLow = 0;
+    ContentDigest content;       // Content: digest of the stored payload
+
+    // Blob holding the payload; defaultBlobName is the block's own blob
+    std::string Location(const std::string& defaultBlobName) const;
+    // Location Lookup hands out. Default and Content payloads are shared with other versions, so
+    // "#<hash>-<parentHash>" (16 hex digits each) is appended for reads to report this version
+    // instead of what the payload blob's metadata says.
+    std::string ReadLocation(const std::string& defaultBlobName) const;
+    // Payload blob and version of a ReadLocation; false (blobName = location) if it has no version
+    static bool SplitReadLocation(const std::string& location, std::string& blobName, hash_t& hash, hash_t& parentHash);
+    // False unless location has the "16hex-16hex" shape GenerateGuid produces
+    static bool ParseLocation(const std::string& location, uint64_t& high, uint64_t& low);
+    // Name of a block's content-addressed blob for a payload digest. Scoped to the block, so every
+    // version that references it is in that block's index and GC can check them all in one read.
+    static std::string ContentLocation(const std::string& defaultBlobName, const ContentDigest& digest);
+    // Block and digest of a ContentLocation; false for any other name
+    static bool ParseContentLocation(const std::string& location, std::string& defaultBlobName, ContentDigest& digest);
+};
+
+// Alternate versions of a token block, kept in the default blob's metadata
+// Encoded as base64url of a format byte plus fixed 32-byte records (hash, parentHash,
+// location halves, host byte order) in FIFO order, so 60 versions take ~2.5 KB of header
+// and decode with two allocations. Lookups binary-search a parent-hash ordering built at decode.
+// Indexes holding content-addressed versions use format 2: 49-byte records with a payload kind
+// byte and a 32-byte location (GUID halves or digest); GUID-only indexes keep format 1 so
+// servers without content addressing still read them.
+// The older "additionalversions" JSON is still read; writers replace it with "versionindex".
+class VersionIndex {
+public:
+    static constexpr const char* kMetadataKey = "versionindex";
+    static constexpr const char* kLegacyMetadataKey = "additionalversions";
+    static constexpr size_t kMaxVersions = 60;
+    static constexpr size_t kRecordSize = 32;
+    static constexpr size_t kContentRecordSize = 49;
+
+    // False (and an empty index) if the value is malformed
+    static bool Decode(const std::string& encoded, VersionIndex& index);
+    static bool DecodeLegacyJson(const std::string& json, VersionIndex& index);
+    std::string Encode() const;
+
+    size_t size() const { return records_.size(); }
+    bool empty() const { return records_.empty(); }
+    const std::vector<VersionRecord>& Records() const { return records_; }   // Oldest first
+
+    // Oldest version whose parent is parentHash, or nullptr
+    const VersionRecord* FindByParent(hash_t parentHash) const;
+    bool Contains(hash_t hash, hash_t parentHash) const;
+    // A content-addressed version whose payload has this digest, or nullptr
+    const VersionRecord* FindByContent(const ContentDigest& digest) const;
+
+    // Add the newest version, evicting the oldest beyond maxVersions; returns the evicted records
+    std::vector<VersionRecord> Append(const VersionRecord& record, size_t maxVersions = kMaxVersions);
+
+private:
+    static constexpr uint8_t kFormatVersion = 1;
+    static constexpr uint8_t kContentFormatVersion = 2;
+    static constexpr size_t kMaxRecords = 255;   // Decode bound; keeps the parent order in uint8
+
+    void RebuildParentOrder();
+
+    std::vector<VersionRecord> records_;
+    std::vector<uint8_t> byParent_;   // Indexes into records_, sorted by parentHash then age
+};
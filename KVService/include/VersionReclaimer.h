@@ -0,0 +1,85 @@
+#pragma once
+
+#include "IKVStoreEngine.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct VersionReclaimerOptions {
+    size_t batchSize = 256;                        // Blob Batch limit per request
+    double deletesPerSecond = 200;                 // 0 = unlimited
+    size_t maxAttempts = 5;
+    std::chrono::milliseconds retryDelay{1000};    // Multiplied by the attempt number
+    size_t maxBacklog = 1 << 20;                   // Names beyond this are dropped (left orphaned)
+};
+
+struct VersionReclaimerStats {
+    size_t backlog = 0;
+    uint64_t deleted = 0;
+    uint64_t retries = 0;
+    uint64_t failed = 0;     // Gave up after maxAttempts
+    uint64_t dropped = 0;    // Backlog full, or still pending at Stop
+};
+
+// Background deleter for evicted version blobs of one container
+// Writers hand over GUID blob names once the version index no longer references them and
+// return without waiting; a worker thread (started on first use) deletes them in rate-limited
+// batches and retries failures with a growing delay.
+// Metrics: version_gc.backlog gauge (all containers), version_gc.{deleted,retries,failed,dropped}
+// counters and version_gc.batch_us latency.
+class VersionReclaimer {
+public:
+    // Deletes the named blobs; returns one flag per name (a blob that no longer exists counts as deleted)
+    using DeleteBatchFn = std::function<std::vector<bool>(const std::vector<std::string>& blobNames)>;
+
+    VersionReclaimer(const VersionReclaimerOptions& options, DeleteBatchFn deleteBatch);
+    ~VersionReclaimer();
+
+    void SetLogCallback(LogCallback callback) { logCallback_ = std::move(callback); }
+
+    void Enqueue(const std::vector<std::string>& blobNames);
+
+    // Delete what is ready within timeout, then stop; anything left is dropped
+    void Stop(std::chrono::milliseconds timeout = std::chrono::milliseconds(5000));
+
+    VersionReclaimerStats GetStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Pending {
+        std::string blobName;
+        size_t attempts = 0;
+        Clock::time_point notBefore;
+    };
+
+    void Loop();
+    std::vector<Pending> TakeBatch(Clock::time_point now);
+    void AdjustBacklog(int64_t delta);
+    void Log(LogLevel level, const std::string& message) const;
+
+    VersionReclaimerOptions options_;
+    DeleteBatchFn deleteBatch_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Pending> ready_;
+    std::deque<Pending> retrying_;
+    bool stopping_ = false;
+    Clock::time_point stopDeadline_;
+    std::thread worker_;
+
+    std::atomic<uint64_t> deleted_{0};
+    std::atomic<uint64_t> retries_{0};
+    std::atomic<uint64_t> failed_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    LogCallback logCallback_;
+};
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "IKVStoreEngine.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// When a write is acknowledged to the client
+enum class WriteDurability {
+    Storage,      // After the store confirms the upload (default)
+    LocalCache,   // After the chunks are journaled on local disk; survives a server restart
+    Receipt       // As soon as the chunks are queued in memory
+};
+
+struct WriteBehindOptions {
+    uint64_t maxQueuedBytes = 0;   // Payload bytes waiting for upload; 0 disables write-behind
+    size_t flushThreads = 16;
+    std::string journalPath;       // Directory for LocalCache writes; empty makes them wait for storage
+    std::chrono::milliseconds drainTimeout{30000};
+    size_t maxAttempts = 3;        // Uploads per unjournaled block before it is dropped
+    std::chrono::milliseconds retryDelay{100};       // Doubled after each failed attempt...
+    std::chrono::milliseconds maxRetryDelay{30000};  // ...up to this
+};
+
+struct WriteBehindStats {
+    size_t queuedEntries = 0;
+    uint64_t queuedBytes = 0;
+    uint64_t flushedBlocks = 0;
+    uint64_t retries = 0;          // Entries re-queued after a failed upload
+    uint64_t droppedBlocks = 0;    // Acknowledged but never stored
+    uint64_t overflows = 0;        // Rejected by a full queue and written synchronously instead
+};
+
+// Bounded write-behind queue shared by all stores of a server
+// Write and WriteBatch requests that ask for Receipt or LocalCache durability are queued here and
+// acknowledged immediately; flush threads upload them through the store's WriteBatchAsync.
+// LocalCache entries are journaled first (one fsynced file per entry under journalPath) and deleted
+// once uploaded, so entries still queued at a crash or a timed-out drain are replayed at the next start.
+// Blocks that fail to upload are re-queued with a growing delay. Journaled blocks are retried until
+// they are stored; only a permanent per-block error (a blob name collision) drops them. Unjournaled
+// blocks are dropped after maxAttempts.
+// Metrics: write_behind.{queue_depth,queue_bytes} gauges, write_behind.{enqueued_blocks,
+// flushed_blocks,retries,dropped_blocks,overflows} counters and write_behind.flush_lag_us latency.
+class WriteBehindQueue {
+public:
+    // Resolves the store of a journaled entry during replay
+    using StoreResolver = std::function<std::shared_ptr<IKVStoreEngine>(const std::string& resourceName,
+                                                                        const std::string& containerName)>;
+
+    WriteBehindQueue(const WriteBehindOptions& options, StoreResolver resolver);
+    ~WriteBehindQueue();
+
+    void SetLogCallback(LogCallback callback) { logCallback_ = std::move(callback); }
+
+    // Creates the journal directory, queues journal entries left by a previous run and starts the flush threads
+    bool Initialize();
+
+    bool Enabled() const { return options_.maxQueuedBytes > 0; }
+    bool Journaled() const { return Enabled() && !options_.journalPath.empty(); }
+
+    // Queue an ordered chain for background upload (journaled first for LocalCache).
+    // Returns false if nothing was queued - queue full, draining, or the journal write failed -
+    // in which case chunks are left untouched and the caller must write synchronously.
+    bool Enqueue(std::shared_ptr<IKVStoreEngine> store,
+                 const std::string& resourceName,
+                 const std::string& containerName,
+                 std::vector<PromptChunk>& chunks,
+                 WriteDurability durability);
+
+    // Stop accepting writes and flush what is queued, waiting up to drainTimeout.
+    // Unjournaled entries still queued afterwards are dropped; journaled ones stay on disk.
+    void Drain();
+
+    WriteBehindStats GetStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        std::shared_ptr<IKVStoreEngine> store;
+        std::string resourceName;
+        std::string containerName;
+        std::vector<PromptChunk> chunks;
+        uint64_t bytes = 0;
+        std::filesystem::path journalFile;   // Empty unless journaled
+        Clock::time_point enqueuedAt;
+        size_t attempts = 0;
+        Clock::time_point notBefore;         // Retries only
+    };
+
+    static uint64_t PayloadBytes(const std::vector<PromptChunk>& chunks);
+
+    bool WriteJournal(const Entry& entry, std::filesystem::path& file);
+    bool ReadJournal(const std::filesystem::path& file, Entry& entry) const;
+    void ReplayJournal();
+
+    void FlushLoop();
+    // One upload attempt; true if the entry kept blocks to retry (entry.chunks/bytes/notBefore updated)
+    bool Flush(Entry& entry);
+    void PublishDepth(size_t entries, uint64_t bytes) const;
+
+    void Log(LogLevel level, const std::string& message) const;
+
+    WriteBehindOptions options_;
+    StoreResolver resolver_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable workCv_;
+    std::condition_variable idleCv_;
+    std::deque<Entry> queue_;
+    std::deque<Entry> retrying_;   // Failed entries waiting for their notBefore
+    uint64_t queuedBytes_ = 0;
+    size_t inFlight_ = 0;
+    size_t pendingEnqueues_ = 0;   // Reserved but still being journaled
+    bool accepting_ = false;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+
+    std::atomic<uint64_t> nextJournalSeq_{0};
+    std::atomic<uint64_t> flushedBlocks_{0};
+    std::atomic<uint64_t> retries_{0};
+    std::atomic<uint64_t> droppedBlocks_{0};
+    std::atomic<uint64_t> overflows_{0};
+
+    LogCallback logCallback_;
+};
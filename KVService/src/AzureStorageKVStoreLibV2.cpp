@@ -1,4 +1,6 @@
 #include "AzureStorageKVStoreLibV2.h"
+#include "StorageIoExecutor.h"
+#include "MetricsHelper.h"
 #include <future>
 #include <azure/storage/blobs.hpp>
 #include <azure/identity/default_azure_credential.hpp>
@@ -21,13 +23,15 @@
 #include <cstring>
 #include <cerrno>
 #endif
-#include <cassert>
+#include <algorithm>
 #include <sstream>
 #include <iomanip>
 #include <iostream>
 #include <random>
 #include <mutex>
 #include <atomic>
+#include <optional>
+#include <stdexcept>
 #include <curl/curl.h>
 
 // Build flavor detection: USE_LOCAL_AZURE_SDK enables custom features for local SDK builds
@@ -227,59 +231,6 @@ static void MultiNicCurlCallback(void* curlHandle) {
 }
 #endif  // USE_LOCAL_AZURE_SDK
 
-// Simple JSON parser for additionalVersions metadata
-// Format: [{"hash":"123","parentHash":"456","location":"guid"},...]
-struct AdditionalVersion {
-    hash_t hash;
-    hash_t parentHash;
-    std::string location;
-};
-
-std::vector<AdditionalVersion> ParseAdditionalVersions(const std::string& jsonStr) {
-    std::vector<AdditionalVersion> versions;
-    if (jsonStr.empty() || jsonStr == "[]") {
-        return versions;
-    }
-    
-    // Simple parser: split by "},{"
-    size_t pos = 0;
-    while (pos < jsonStr.length()) {
-        // Find next object
-        size_t start = jsonStr.find("{\"hash\":", pos);
-        if (start == std::string::npos) break;
-        
-        size_t end = jsonStr.find("}", start);
-        if (end == std::string::npos) break;
-        
-        std::string obj = jsonStr.substr(start, end - start + 1);
-        
-        // Extract hash
-        size_t hashStart = obj.find("\"hash\":\"") + 8;
-        size_t hashEnd = obj.find("\"", hashStart);
-        std::string hashStr = obj.substr(hashStart, hashEnd - hashStart);
-        
-        // Extract parentHash
-        size_t parentStart = obj.find("\"parentHash\":\"") + 14;
-        size_t parentEnd = obj.find("\"", parentStart);
-        std::string parentStr = obj.substr(parentStart, parentEnd - parentStart);
-        
-        // Extract location
-        size_t locStart = obj.find("\"location\":\"") + 12;
-        size_t locEnd = obj.find("\"", locStart);
-        std::string location = obj.substr(locStart, locEnd - locStart);
-        
-        AdditionalVersion version;
-        version.hash = std::stoull(hashStr);
-        version.parentHash = std::stoull(parentStr);
-        version.location = location;
-        versions.push_back(version);
-        
-        pos = end + 1;
-    }
-    
-    return versions;
-}
-
 // Generate a simple GUID-like string for versioned blobs
 std::string GenerateGuid() {
     std::random_device rd;
@@ -295,23 +246,9 @@ std::string GenerateGuid() {
     return ss.str();
 }
 
-// Serialize additionalVersions array to JSON string
-std::string SerializeAdditionalVersions(const std::vector<AdditionalVersion>& versions) {
-    if (versions.empty()) {
-        return "[]";
-    }
-    
-    std::stringstream ss;
-    ss << "[";
-    for (size_t i = 0; i < versions.size(); ++i) {
-        if (i > 0) ss << ",";
-        ss << "{\"hash\":\"" << versions[i].hash << "\""
-           << ",\"parentHash\":\"" << versions[i].parentHash << "\""
-           << ",\"location\":\"" << versions[i].location << "\"}";
-    }
-    ss << "]";
-    return ss.str();
-}
+// How long a content blob must go unwritten before GC may delete it. A writer touches (or uploads)
+// the content blob before the index CAS that references it, so this must cover that window.
+static constexpr std::chrono::hours kContentGracePeriod{1};
 
 bool AzureStorageKVStoreLibV2::Initialize(const std::string& accountUrl, const std::string& containerName, HttpTransportProtocol transport, bool enableSdkLogging, bool enableMultiNic) {
     azureAccountUrl_ = accountUrl;
@@ -460,6 +397,23 @@ bool AzureStorageKVStoreLibV2::Initialize(const std::string& accountUrl, const s
             accountUrl + "/" + containerName, credential, clientOptions);
         
         Log(LogLevel::Information, "[KVStore V2] Initialized with Azure account: " + accountUrl + ", container: " + containerName);
+        
+        versionReclaimer_ = std::make_unique<VersionReclaimer>(versionReclaimerOptions_,
+            [this](const std::vector<std::string>& blobNames) { return DeleteBlobBatch(blobNames); });
+        versionReclaimer_->SetLogCallback([this](LogLevel level, const std::string& message) { Log(level, message); });
+        
+        // Content blobs are rechecked no sooner than the grace period after a recent write
+        VersionReclaimerOptions contentReclaimerOptions = versionReclaimerOptions_;
+        contentReclaimerOptions.retryDelay = kContentGracePeriod;
+        contentReclaimer_ = std::make_unique<VersionReclaimer>(contentReclaimerOptions,
+            [this](const std::vector<std::string>& blobNames) { return ReclaimContentBlobs(blobNames); });
+        contentReclaimer_->SetLogCallback([this](LogLevel level, const std::string& message) { Log(level, message); });
+        
+        if (bloomFilterOptions_.enabled) {
+            bloomFilterBlobClient_ = std::make_shared<Azure::Storage::Blobs::BlobClient>(
+                blobContainerClient_->GetBlobClient(kBloomFilterBlobName));
+            LoadBloomFilter();
+        }
         return true;
     }
     catch (const std::exception& e) {
@@ -468,6 +422,376 @@ bool AzureStorageKVStoreLibV2::Initialize(const std::string& accountUrl, const s
     }
 }
 
+AzureStorageKVStoreLibV2::~AzureStorageKVStoreLibV2() {
+    if (versionReclaimer_) {
+        versionReclaimer_->Stop();
+    }
+    if (contentReclaimer_) {
+        contentReclaimer_->Stop();
+    }
+    StopBloomFilterSnapshots();
+}
+
+std::vector<bool> AzureStorageKVStoreLibV2::DeleteBlobBatch(const std::vector<std::string>& blobNames) const {
+    // A blob that is already gone needs no retry
+    auto deletedOrMissing = [](const Azure::Storage::StorageException& ex) {
+        return ex.StatusCode == Azure::Core::Http::HttpStatusCode::NotFound;
+    };
+    
+    std::vector<bool> deleted(blobNames.size(), false);
+    try {
+        auto batch = blobContainerClient_->CreateBatch();
+        std::vector<decltype(batch.DeleteBlob(std::string()))> responses;
+        responses.reserve(blobNames.size());
+        for (const auto& blobName : blobNames) {
+            responses.push_back(batch.DeleteBlob(blobName));
+        }
+        blobContainerClient_->SubmitBatch(batch);
+        for (size_t i = 0; i < responses.size(); ++i) {
+            try {
+                responses[i].GetResponse();
+                deleted[i] = true;
+            } catch (const Azure::Storage::StorageException& ex) {
+                deleted[i] = deletedOrMissing(ex);
+            }
+        }
+        return deleted;
+    } catch (const Azure::Storage::StorageException& ex) {
+        Log(LogLevel::Verbose, "[KVStore V2 GC] Blob batch rejected (" + std::string(ex.what()) + ") - deleting one by one");
+    }
+    
+    for (size_t i = 0; i < blobNames.size(); ++i) {
+        try {
+            blobContainerClient_->GetBlobClient(blobNames[i]).Delete();
+            deleted[i] = true;
+        } catch (const Azure::Storage::StorageException& ex) {
+            deleted[i] = deletedOrMissing(ex);
+        }
+    }
+    return deleted;
+}
+
+// Snapshot metadata set while an instance that loaded the snapshot is running. Names added
+// after its last snapshot are lost if it crashes, so an open snapshot is never complete;
+// only the snapshot written at a clean shutdown leaves it out.
+static constexpr const char* kBloomSnapshotOpenKey = "open";
+
+// Downloads and parses the Bloom filter snapshot; returns false if the blob does not exist.
+// filter is left null if the snapshot exists but cannot be parsed.
+static bool DownloadBloomFilterSnapshot(const Azure::Storage::Blobs::BlobClient& client,
+                                        std::unique_ptr<BloomFilter>& filter, std::string& etag) {
+    try {
+        auto downloadResponse = client.Download();
+        std::vector<uint8_t> buffer(static_cast<size_t>(downloadResponse.Value.BlobSize));
+        downloadResponse.Value.BodyStream->ReadToCount(buffer.data(), buffer.size());
+        etag = downloadResponse.Value.Details.ETag.ToString();
+        filter = BloomFilter::Deserialize(buffer);
+        const auto& metadata = downloadResponse.Value.Details.Metadata;
+        if (filter && metadata.find(kBloomSnapshotOpenKey) != metadata.end()) {
+            filter->SetComplete(false);
+        }
+        return true;
+    } catch (const Azure::Storage::StorageException& ex) {
+        if (ex.StatusCode == Azure::Core::Http::HttpStatusCode::NotFound) {
+            return false;
+        }
+        throw;
+    }
+}
+
+void AzureStorageKVStoreLibV2::LoadBloomFilter() {
+    std::unique_ptr<BloomFilter> snapshot;
+    try {
+        if (DownloadBloomFilterSnapshot(*bloomFilterBlobClient_, snapshot, bloomSnapshotETag_) && !snapshot) {
+            Log(LogLevel::Error, "[KVStore V2 Bloom] Snapshot blob is unreadable - it will be replaced");
+        }
+    } catch (const Azure::Storage::StorageException& ex) {
+        Log(LogLevel::Error, "[KVStore V2 Bloom] Failed to load snapshot: " + std::string(ex.what()));
+    }
+    
+    // Mark the snapshot open until StopBloomFilterSnapshots, so a crash before then makes the
+    // next load rebuild instead of trusting names that never reached the snapshot
+    if (snapshot) {
+        try {
+            Azure::Storage::Metadata openMetadata;
+            openMetadata[kBloomSnapshotOpenKey] = "1";
+            Azure::Storage::Blobs::SetBlobMetadataOptions openOptions;
+            openOptions.AccessConditions.IfMatch = Azure::ETag(bloomSnapshotETag_);
+            bloomSnapshotETag_ = bloomFilterBlobClient_->SetMetadata(openMetadata, openOptions).Value.ETag.ToString();
+        } catch (const Azure::Storage::StorageException& ex) {
+            Log(LogLevel::Error, "[KVStore V2 Bloom] Failed to mark snapshot open: " + std::string(ex.what()));
+        }
+    }
+    
+    // A snapshot's geometry wins over local options so every instance can merge into it
+    blobNameFilter_ = snapshot ? std::move(snapshot) : std::make_unique<BloomFilter>(bloomFilterOptions_);
+    
+    // Without a complete snapshot, negatives are only trustworthy if the container is empty
+    bool rebuild = false;
+    if (!blobNameFilter_->IsComplete()) {
+        try {
+            Azure::Storage::Blobs::ListBlobsOptions listOptions;
+            listOptions.PageSizeHint = 2;
+            auto page = blobContainerClient_->ListBlobs(listOptions);
+            bool empty = std::all_of(page.Blobs.begin(), page.Blobs.end(),
+                [](const auto& item) { return item.Name == kBloomFilterBlobName; });
+            if (empty) {
+                blobNameFilter_->SetComplete(true);
+            } else {
+                rebuild = true;
+            }
+        } catch (const Azure::Storage::StorageException& ex) {
+            Log(LogLevel::Error, "[KVStore V2 Bloom] Failed to list container: " + std::string(ex.what()));
+            rebuild = true;
+        }
+    }
+    
+    Log(LogLevel::Information, "[KVStore V2 Bloom] Filter ready (" + std::to_string(blobNameFilter_->SizeBytes() / 1024) + " KB, " +
+        (blobNameFilter_->IsComplete() ? "complete" : "incomplete - rebuilding in background") + ")");
+    
+    bloomSnapshotThread_ = std::thread(&AzureStorageKVStoreLibV2::BloomFilterSnapshotLoop, this, rebuild);
+}
+
+// Adds every blob name in the container; Lookup ignores the filter until this completes
+void AzureStorageKVStoreLibV2::RebuildBloomFilter() {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    size_t names = 0;
+    try {
+        for (auto page = blobContainerClient_->ListBlobs(); page.HasPage(); page.MoveToNextPage()) {
+            {
+                std::lock_guard<std::mutex> lock(bloomSnapshotMutex_);
+                if (bloomSnapshotStopping_) {
+                    return;
+                }
+            }
+            for (const auto& item : page.Blobs) {
+                if (item.Name != kBloomFilterBlobName) {
+                    blobNameFilter_->Add(item.Name);
+                    names++;
+                }
+            }
+        }
+    } catch (const Azure::Storage::StorageException& ex) {
+        Log(LogLevel::Error, "[KVStore V2 Bloom] Rebuild failed after " + std::to_string(names) + " blobs: " + std::string(ex.what()));
+        return;
+    }
+    
+    blobNameFilter_->SetComplete(true);
+    bloomFilterDirty_ = true;
+    
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+    Log(LogLevel::Information, "[KVStore V2 Bloom] Rebuilt from " + std::to_string(names) + " blobs (" + std::to_string(duration) + "ms)");
+    SnapshotBloomFilter();
+}
+
+// Merges the stored snapshot (other instances' names) into the local filter and, if we have
+// names it lacks, writes the union back under an ETag condition. Only the closing snapshot
+// is written without the open marker.
+bool AzureStorageKVStoreLibV2::SnapshotBloomFilter(bool closing) {
+    const int maxRetries = 5;
+    for (int retry = 0; retry < maxRetries; ++retry) {
+        try {
+            std::string remoteETag;
+            bool exists = true;
+            try {
+                remoteETag = bloomFilterBlobClient_->GetProperties().Value.ETag.ToString();
+            } catch (const Azure::Storage::StorageException& ex) {
+                if (ex.StatusCode != Azure::Core::Http::HttpStatusCode::NotFound) {
+                    throw;
+                }
+                exists = false;
+            }
+            
+            if (exists && remoteETag != bloomSnapshotETag_) {
+                std::unique_ptr<BloomFilter> remote;
+                if (DownloadBloomFilterSnapshot(*bloomFilterBlobClient_, remote, remoteETag) && remote &&
+                    !blobNameFilter_->Merge(*remote)) {
+                    Log(LogLevel::Error, "[KVStore V2 Bloom] Snapshot geometry differs from the local filter - not merging");
+                    return false;
+                }
+            }
+            bloomSnapshotETag_ = remoteETag;
+            
+            if (!bloomFilterDirty_.exchange(false)) {
+                return true;
+            }
+            
+            std::vector<uint8_t> bytes = blobNameFilter_->Serialize();
+            Azure::Core::IO::MemoryBodyStream contentStream(bytes.data(), bytes.size());
+            Azure::Storage::Blobs::UploadBlockBlobOptions uploadOptions;
+            if (!closing) {
+                uploadOptions.Metadata[kBloomSnapshotOpenKey] = "1";
+            }
+            if (exists) {
+                uploadOptions.AccessConditions.IfMatch = Azure::ETag(remoteETag);
+            } else {
+                uploadOptions.AccessConditions.IfNoneMatch = Azure::ETag::Any();
+            }
+            auto uploadResponse = bloomFilterBlobClient_->AsBlockBlobClient().Upload(contentStream, uploadOptions);
+            bloomSnapshotETag_ = uploadResponse.Value.ETag.ToString();
+            Log(LogLevel::Verbose, "[KVStore V2 Bloom] Snapshot written (" + std::to_string(bytes.size()) + " bytes)");
+            return true;
+            
+        } catch (const Azure::Storage::StorageException& ex) {
+            bloomFilterDirty_ = true;
+            // Another instance wrote a snapshot in between - merge it and try again
+            if ((ex.StatusCode == Azure::Core::Http::HttpStatusCode::PreconditionFailed ||
+                 ex.StatusCode == Azure::Core::Http::HttpStatusCode::Conflict) && retry < maxRetries - 1) {
+                continue;
+            }
+            Log(LogLevel::Error, "[KVStore V2 Bloom] Snapshot failed: " + std::string(ex.what()));
+            return false;
+        }
+    }
+    return false;
+}
+
+void AzureStorageKVStoreLibV2::BloomFilterSnapshotLoop(bool rebuild) {
+    if (rebuild) {
+        RebuildBloomFilter();
+    }
+    
+    std::unique_lock<std::mutex> lock(bloomSnapshotMutex_);
+    while (!bloomSnapshotStopping_) {
+        if (bloomSnapshotCv_.wait_for(lock, bloomSnapshotInterval_, [this] { return bloomSnapshotStopping_; })) {
+            break;
+        }
+        lock.unlock();
+        SnapshotBloomFilter();
+        lock.lock();
+    }
+}
+
+// Stops the snapshot thread and writes a closing snapshot, which also clears the open marker
+void AzureStorageKVStoreLibV2::StopBloomFilterSnapshots() {
+    if (!bloomSnapshotThread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(bloomSnapshotMutex_);
+        bloomSnapshotStopping_ = true;
+    }
+    bloomSnapshotCv_.notify_all();
+    bloomSnapshotThread_.join();
+    
+    bloomFilterDirty_ = true;
+    SnapshotBloomFilter(true);
+}
+
+void AzureStorageKVStoreLibV2::AddToBloomFilter(const std::string& blobName) const {
+    if (blobNameFilter_ && !blobNameFilter_->MightContain(blobName)) {
+        blobNameFilter_->Add(blobName);
+        bloomFilterDirty_ = true;
+    }
+}
+
+// Alternate versions from default blob metadata: the binary index, else the legacy JSON.
+// False (and an empty index) if the binary index cannot be decoded, e.g. a format written by a
+// newer server; such metadata must never be rewritten, or every version it lists is lost.
+template<typename MetadataMap>
+static bool ReadVersionIndex(const MetadataMap& metadata, VersionIndex& index) {
+    auto indexIt = metadata.find(VersionIndex::kMetadataKey);
+    if (indexIt != metadata.end()) {
+        return VersionIndex::Decode(indexIt->second, index);
+    }
+    auto legacyIt = metadata.find(VersionIndex::kLegacyMetadataKey);
+    if (legacyIt != metadata.end()) {
+        VersionIndex::DecodeLegacyJson(legacyIt->second, index);
+    }
+    return true;
+}
+
+// Read hash/parenthash/version index from default blob metadata
+static BlockMetadata ParseBlockMetadata(const Azure::Storage::Metadata& metadata) {
+    BlockMetadata blockMetadata;
+    
+    auto hashIt = metadata.find("hash");
+    if (hashIt != metadata.end()) {
+        blockMetadata.hash = std::stoull(hashIt->second);
+    }
+    
+    auto parentIt = metadata.find("parenthash");
+    if (parentIt != metadata.end()) {
+        blockMetadata.parentHash = std::stoull(parentIt->second);
+    }
+    
+    // Lookup treats an unreadable index as no alternate versions; only writes refuse it
+    ReadVersionIndex(metadata, blockMetadata.additionalVersions);
+    return blockMetadata;
+}
+
+// True if the default blob or one of its additional versions is (hash, parentHash)
+static bool HasVersion(const BlockMetadata& metadata, hash_t hash, hash_t parentHash) {
+    if (metadata.hash == hash && metadata.parentHash == parentHash) {
+        return true;
+    }
+    return metadata.additionalVersions.Contains(hash, parentHash);
+}
+
+// Payload encoding of a chunk blob ("codec", "shuffle", "rawsize"); blobs without "codec" are raw
+static void SetEncodingMetadata(Azure::Storage::Metadata& metadata, const payload::Encoding& encoding) {
+    if (encoding.IsRaw()) {
+        return;
+    }
+    metadata["codec"] = payload::CodecName(encoding.codec);
+    metadata["shuffle"] = std::to_string(encoding.shuffle);
+    metadata["rawsize"] = std::to_string(encoding.rawSize);
+}
+
+static payload::Encoding ReadEncodingMetadata(const Azure::Storage::Metadata& metadata) {
+    payload::Encoding encoding;
+    auto codecIt = metadata.find("codec");
+    auto rawSizeIt = metadata.find("rawsize");
+    if (codecIt == metadata.end() || rawSizeIt == metadata.end() || !payload::ParseCodec(codecIt->second, encoding.codec)) {
+        return payload::Encoding();
+    }
+    encoding.rawSize = std::stoull(rawSizeIt->second);
+    auto shuffleIt = metadata.find("shuffle");
+    if (shuffleIt != metadata.end()) {
+        encoding.shuffle = static_cast<uint8_t>(std::min<unsigned long long>(std::stoull(shuffleIt->second), 255));
+    }
+    return encoding;
+}
+
+// Digest of a stored payload: plain SHA-256 for raw bytes; encoded payloads also cover the
+// codec header, so equal bytes under different encodings never share a content blob
+static constexpr const char* kContentHashMetadataKey = "contenthash";
+
+static ContentDigest PayloadDigest(const PromptChunk& chunk) {
+    Sha256 hash;
+    if (!chunk.encoding.IsRaw()) {
+        uint8_t header[10] = {static_cast<uint8_t>(chunk.encoding.codec), chunk.encoding.shuffle};
+        for (int i = 0; i < 8; ++i) {
+            header[2 + i] = static_cast<uint8_t>(chunk.encoding.rawSize >> (i * 8));
+        }
+        hash.Update(header, sizeof(header));
+    }
+    hash.Update(ChunkData(chunk.buffer), chunk.bufferSize);
+    return hash.Finish();
+}
+
+bool AzureStorageKVStoreLibV2::FetchBlockMetadata(const std::string& blobName, BlockMetadata& metadata, const std::string& expectedTokens) const {
+    try {
+        auto blobClient = blobContainerClient_->GetBlobClient(blobName);
+        auto properties = blobClient.GetProperties();
+        if (!expectedTokens.empty()) {
+            auto tokensIt = properties.Value.Metadata.find("tokens");
+            if (tokensIt != properties.Value.Metadata.end() && tokensIt->second != expectedTokens) {
+                Log(LogLevel::Error, "[KVStore V2 Lookup]   ✗ Blob name hash collision on " + blobName);
+                kvstore::MetricsHelper::GetInstance().IncrementCounter("blob_naming.hash_collisions");
+                return false;
+            }
+        }
+        metadata = ParseBlockMetadata(properties.Value.Metadata);
+        metadataCache_.Put(blobName, metadata);
+        AddToBloomFilter(blobName);
+        return true;
+    } catch (const Azure::Storage::StorageException& ex) {
+        return false;
+    }
+}
+
 // V2 API: Lookup - Returns block locations for multi-version support
 template<typename TokenIterator>
 LookupResult AzureStorageKVStoreLibV2::Lookup(
@@ -475,7 +799,8 @@ LookupResult AzureStorageKVStoreLibV2::Lookup(
     const std::string& completionId,
     TokenIterator begin,
     TokenIterator end,
-    const std::vector<hash_t>& precomputedHashes
+    const std::vector<hash_t>& precomputedHashes,
+    ProbeStrategy probeStrategy
 ) const {
     auto startTime = std::chrono::high_resolution_clock::now();
     
@@ -493,118 +818,81 @@ LookupResult AzureStorageKVStoreLibV2::Lookup(
     
     // Prepare block information
     struct BlockInfo {
-        std::string blobName;
+        std::string blobName;        // Name the block was found under (hash name until a legacy fallback hits)
+        std::string tokenBlobName;   // Hash mode only: token name, for collision checks and legacy fallback
         hash_t expectedHash;
     };
     std::vector<BlockInfo> blocks(numFullBlocks);
     
     // Prepare all block blob names first
+    bool hashNames = blobNaming_ == BlobNamingMode::Hash;
+    bool legacyFallback = hashNames && legacyNameFallback_;
     for (size_t i = 0; i < numFullBlocks; ++i) {
         auto blockBegin = begin + (i * blockSize);
         auto blockEnd = blockBegin + blockSize;
-        blocks[i].blobName = EncodeTokensToBlobName(blockBegin, blockEnd);
+        blocks[i].blobName = BlobNameFor(blockBegin, blockEnd);
+        if (hashNames) {
+            blocks[i].tokenBlobName = EncodeTokensToBlobName(blockBegin, blockEnd);
+        }
         blocks[i].expectedHash = (i < precomputedHashes.size()) ? precomputedHashes[i] : 0;
     }
     
-    // Launch all GetProperties calls in parallel
-    std::vector<std::future<std::tuple<bool, hash_t, hash_t, std::string, std::string>>> futures;
-    for (const auto& block : blocks) {
-        futures.push_back(std::async(std::launch::async, [this, block]() -> std::tuple<bool, hash_t, hash_t, std::string, std::string> {
-            try {
-                auto blobClient = blobContainerClient_->GetBlobClient(block.blobName);
-                auto properties = blobClient.GetProperties();
-                
-                hash_t storedHash = 0;
-                hash_t parentHash = 0;
-                std::string multiVersion = "";
-                std::string additionalVersions = "";
-                
-                auto hashIt = properties.Value.Metadata.find("hash");
-                if (hashIt != properties.Value.Metadata.end()) {
-                    storedHash = std::stoull(hashIt->second);
-                }
-                
-                auto parentIt = properties.Value.Metadata.find("parenthash");
-                if (parentIt != properties.Value.Metadata.end()) {
-                    parentHash = std::stoull(parentIt->second);
-                }
-                
-                auto multiVerIt = properties.Value.Metadata.find("multiversion");
-                if (multiVerIt != properties.Value.Metadata.end()) {
-                    multiVersion = multiVerIt->second;
-                }
-                
-                auto additionalIt = properties.Value.Metadata.find("additionalversions");
-                if (additionalIt != properties.Value.Metadata.end()) {
-                    additionalVersions = additionalIt->second;
-                }
-                
-                return {true, storedHash, parentHash, multiVersion, additionalVersions};
-            } catch (const Azure::Storage::StorageException& ex) {
-                return {false, 0, 0, "", ""};
-            }
-        }));
-    }
+    // Metadata of block i from the cache, trying the legacy token name during migration
+    auto getCached = [&](size_t i, BlockMetadata& metadata) {
+        if (metadataCache_.Get(blocks[i].blobName, metadata)) {
+            return true;
+        }
+        if (legacyFallback && metadataCache_.Get(blocks[i].tokenBlobName, metadata)) {
+            blocks[i].blobName = blocks[i].tokenBlobName;
+            return true;
+        }
+        return false;
+    };
+    
+    // Metadata of block i from storage; a legacy hit switches the block to its token name
+    auto fetchBlock = [&](size_t i, BlockMetadata& metadata) {
+        if (FetchBlockMetadata(blocks[i].blobName, metadata, blocks[i].tokenBlobName)) {
+            return true;
+        }
+        if (legacyFallback && FetchBlockMetadata(blocks[i].tokenBlobName, metadata)) {
+            blocks[i].blobName = blocks[i].tokenBlobName;
+            kvstore::MetricsHelper::GetInstance().IncrementCounter("blob_naming.legacy_hits");
+            return true;
+        }
+        return false;
+    };
     
-    // Process results sequentially to validate chain
+    // Process blocks sequentially to validate chain
     LookupResult result;
     hash_t expectedParentHash = 0;
     
-    for (size_t blockNum = 0; blockNum < numFullBlocks; ++blockNum) {
-        auto [found, storedHash, parentHash, multiVersion, additionalVersions] = futures[blockNum].get();
-        
-        if (!found) {
-            Log(LogLevel::Error, "[KVStore V2 Lookup]   ✗ Block " + std::to_string(blockNum) + " not found, breaking chain", completionId);
-            break;
-        }
-        
+    // Picks the version of a block whose parent matches the chain so far
+    auto resolveBlock = [&](size_t blockNum, const BlockMetadata& metadata) -> bool {
         std::string locationToRead = blocks[blockNum].blobName;  // Default to token-based blob name
-        hash_t blockHash = storedHash;
+        hash_t blockHash = metadata.hash;
         
         // Debug: Log metadata values
-        Log(LogLevel::Verbose, "[KVStore V2 Lookup]   Block " + std::to_string(blockNum) + " metadata: multiVersion='" + multiVersion + 
-            "', additionalVersions.size=" + std::to_string(additionalVersions.size()) + 
-            ", parentHash=" + std::to_string(parentHash) + ", expectedParent=" + std::to_string(expectedParentHash), completionId);
+        Log(LogLevel::Verbose, "[KVStore V2 Lookup]   Block " + std::to_string(blockNum) + " metadata: additionalVersions.count=" + 
+            std::to_string(metadata.additionalVersions.size()) + 
+            ", parentHash=" + std::to_string(metadata.parentHash) + ", expectedParent=" + std::to_string(expectedParentHash), completionId);
         
-        // Check if this is a multi-version blob (simplified: just check if additionalVersions exists)
-        if (!additionalVersions.empty()) {
-            Log(LogLevel::Verbose, "[KVStore V2 Lookup]   Multi-version blob detected for block " + std::to_string(blockNum), completionId);
+        // Check default version first
+        if (blockNum == 0 || metadata.parentHash == expectedParentHash) {
+            Log(LogLevel::Verbose, "[KVStore V2 Lookup]   ✓ Using default version (parent match)", completionId);
+        } else if (!metadata.additionalVersions.empty()) {
+            Log(LogLevel::Verbose, "[KVStore V2 Lookup]   Default parent doesn't match, searching " + 
+                std::to_string(metadata.additionalVersions.size()) + " additional versions...", completionId);
             
-            // Check default version first
-            if (blockNum == 0 || parentHash == expectedParentHash) {
-                // Default version matches, use default location
-                Log(LogLevel::Verbose, "[KVStore V2 Lookup]   ✓ Using default version (parent match)", completionId);
-            } else {
-                // Parse additionalVersions and find matching parent
-                                Log(LogLevel::Verbose, "[KVStore V2 Lookup]   Default parent doesn't match, searching additional versions...", completionId);
-                auto versions = ParseAdditionalVersions(additionalVersions);
-                Log(LogLevel::Verbose, "[KVStore V2 Lookup]   Found " + std::to_string(versions.size()) + " additional versions", completionId);
-                
-                bool foundMatch = false;
-                for (const auto& version : versions) {
-                    if (version.parentHash == expectedParentHash) {
-                        // Found matching version!
-                        locationToRead = version.location;
-                        blockHash = version.hash;
-                        foundMatch = true;
-                        Log(LogLevel::Verbose, "[KVStore V2 Lookup]   ✓ Found matching version: hash=" + std::to_string(version.hash) + 
-                            ", parentHash=" + std::to_string(version.parentHash) + ", location=" + version.location, completionId);
-                        break;
-                    }
-                }
-                
-                if (!foundMatch) {
-                    Log(LogLevel::Error, "[KVStore V2 Lookup]   ✗ No version found with matching parent hash " + std::to_string(expectedParentHash), completionId);
-                    Log(LogLevel::Error, "[KVStore V2 Lookup]   Breaking chain - cache miss", completionId);
-                    break;
-                }
+            const VersionRecord* version = metadata.additionalVersions.FindByParent(expectedParentHash);
+            if (!version) {
+                return false;
             }
+            locationToRead = version->ReadLocation(blocks[blockNum].blobName);
+            blockHash = version->hash;
+            Log(LogLevel::Verbose, "[KVStore V2 Lookup]   ✓ Found matching version: hash=" + std::to_string(version->hash) + 
+                ", parentHash=" + std::to_string(version->parentHash) + ", location=" + locationToRead, completionId);
         } else {
-            // Single version blob - validate parent
-            if (blockNum > 0 && parentHash != expectedParentHash) {
-                Log(LogLevel::Error, "[KVStore V2 Lookup]   ✗ Parent chain mismatch at block " + std::to_string(blockNum), completionId);
-                break;
-            }
+            return false;
         }
         
         // Add location to result
@@ -612,6 +900,184 @@ LookupResult AzureStorageKVStoreLibV2::Lookup(
         result.cachedBlocks++;
         result.lastHash = blockHash;
         expectedParentHash = blockHash;
+        return true;
+    };
+    
+    // Serve the prefix from the metadata cache while the cached chain holds
+    size_t blockNum = 0;
+    for (; blockNum < numFullBlocks; ++blockNum) {
+        BlockMetadata metadata;
+        if (!getCached(blockNum, metadata) || !resolveBlock(blockNum, metadata)) {
+            break;
+        }
+    }
+    size_t cacheHits = blockNum;
+    
+    // A complete Bloom filter says the chain cannot extend past the first block it has never
+    // seen, so nothing beyond that block is probed. The filter can lag other instances' writes,
+    // so the negative block itself is still probed before the chain ends on it.
+    auto firstFilterMiss = [&](size_t from) {
+        if (blobNameFilter_ && blobNameFilter_->IsComplete()) {
+            for (size_t i = from; i < numFullBlocks; ++i) {
+                if (!blobNameFilter_->MightContain(blocks[i].blobName) &&
+                    !(legacyFallback && blobNameFilter_->MightContain(blocks[i].tokenBlobName))) {
+                    return i;
+                }
+            }
+        }
+        return numFullBlocks;
+    };
+    size_t filterMiss = firstFilterMiss(blockNum);
+    size_t probeLimit = std::min(filterMiss + 1, numFullBlocks);
+    
+    // Remaining blocks (including a cached block whose chain did not match, which may be stale)
+    // come from storage - GetProperties calls run on the shared I/O executor with bounded fan-out
+    enum class ProbeState : char { Unknown, Found, Missing };
+    std::vector<BlockMetadata> fetched(numFullBlocks);
+    std::vector<ProbeState> probeStates(numFullBlocks, ProbeState::Unknown);
+    
+    auto probe = [&](std::vector<size_t> indices) {
+        indices.erase(std::remove_if(indices.begin(), indices.end(),
+            [&](size_t i) { return probeStates[i] != ProbeState::Unknown; }), indices.end());
+        StorageIoExecutor::GetInstance().ParallelFor(indices.size(), 0, [&](size_t k) {
+            size_t i = indices[k];
+            probeStates[i] = fetchBlock(i, fetched[i]) ? ProbeState::Found : ProbeState::Missing;
+        });
+        result.probesIssued += static_cast<int>(indices.size());
+    };
+    auto probeRange = [&](size_t first, size_t last) {
+        std::vector<size_t> indices;
+        for (size_t i = first; i < last; ++i) {
+            indices.push_back(i);
+        }
+        probe(std::move(indices));
+    };
+    
+    // Extends the chain over probed blocks up to limit; false once the chain ends
+    bool chainIntact = true;
+    auto walkTo = [&](size_t limit) {
+        for (; chainIntact && blockNum < limit; ++blockNum) {
+            if (probeStates[blockNum] != ProbeState::Found) {
+                Log(LogLevel::Error, "[KVStore V2 Lookup]   ✗ Block " + std::to_string(blockNum) + " not found, breaking chain", completionId);
+                chainIntact = false;
+            } else if (!resolveBlock(blockNum, fetched[blockNum])) {
+                Log(LogLevel::Error, "[KVStore V2 Lookup]   ✗ No version found with matching parent hash " + std::to_string(expectedParentHash) + 
+                    " at block " + std::to_string(blockNum), completionId);
+                Log(LogLevel::Error, "[KVStore V2 Lookup]   Breaking chain - cache miss", completionId);
+                chainIntact = false;
+            }
+            if (!chainIntact) {
+                break;
+            }
+        }
+        return chainIntact;
+    };
+    
+    // Galloping/binary search for the first missing block: a miss at index m bounds the prefix
+    // to m, so only blocks below the bound are fetched. Hits found while searching are reused.
+    auto searchFirstMiss = [&](size_t start, bool gallop) -> size_t {
+        probe({start});
+        if (probeStates[start] == ProbeState::Missing) {
+            return start;
+        }
+        size_t lastHit = start;
+        size_t firstMiss = probeLimit;
+        if (gallop) {
+            for (size_t step = 1; lastHit + 1 < probeLimit; step *= 2) {
+                size_t next = std::min(lastHit + step, probeLimit - 1);
+                probe({next});
+                if (probeStates[next] == ProbeState::Missing) {
+                    firstMiss = next;
+                    break;
+                }
+                lastHit = next;
+            }
+        } else if (lastHit + 1 < probeLimit) {
+            probe({probeLimit - 1});
+            if (probeStates[probeLimit - 1] == ProbeState::Missing) {
+                firstMiss = probeLimit - 1;
+            }
+        }
+        while (firstMiss < probeLimit && firstMiss - lastHit > 1) {
+            size_t mid = lastHit + (firstMiss - lastHit) / 2;
+            probe({mid});
+            if (probeStates[mid] == ProbeState::Missing) {
+                firstMiss = mid;
+            } else {
+                lastHit = mid;
+            }
+        }
+        return firstMiss;
+    };
+    
+    if (probeStrategy == ProbeStrategy::Default) {
+        probeStrategy = probeStrategy_;
+    }
+    
+    while (blockNum < probeLimit) {
+        switch (probeStrategy) {
+        case ProbeStrategy::Waves: {
+            // Contiguous waves that double in size until the chain breaks
+            size_t waveSize = kInitialProbeWave;
+            while (blockNum < probeLimit) {
+                size_t waveEnd = std::min(blockNum + waveSize, probeLimit);
+                probeRange(blockNum, waveEnd);
+                if (!walkTo(waveEnd)) {
+                    break;
+                }
+                waveSize *= 2;
+            }
+            break;
+        }
+        case ProbeStrategy::Galloping:
+        case ProbeStrategy::Binary: {
+            size_t bound = searchFirstMiss(blockNum, probeStrategy == ProbeStrategy::Galloping);
+            probeRange(blockNum, bound);
+            if (walkTo(bound) && bound < probeLimit) {
+                walkTo(bound + 1);  // Records the miss at the bound
+            }
+            break;
+        }
+        case ProbeStrategy::Parallel:
+        default:
+            probeRange(blockNum, probeLimit);
+            walkTo(probeLimit);
+            break;
+        }
+        
+        if (filterMiss == numFullBlocks || probeStates[filterMiss] != ProbeState::Found) {
+            break;
+        }
+        // Storage has a block the filter had not seen yet (the probe added it) - keep going
+        Log(LogLevel::Verbose, "[KVStore V2 Lookup]   Block " + std::to_string(filterMiss) + 
+            " missing from Bloom filter but found in storage", completionId);
+        kvstore::MetricsHelper::GetInstance().IncrementCounter("bloom_filter.false_negatives");
+        if (!chainIntact) {
+            break;
+        }
+        filterMiss = firstFilterMiss(blockNum);
+        probeLimit = std::min(filterMiss + 1, numFullBlocks);
+    }
+    
+    if (filterMiss < numFullBlocks && probeStates[filterMiss] == ProbeState::Missing) {
+        Log(LogLevel::Verbose, "[KVStore V2 Lookup]   Block " + std::to_string(filterMiss) + 
+            " not in Bloom filter or storage, nothing probed past it", completionId);
+        kvstore::MetricsHelper::GetInstance().IncrementCounter("bloom_filter.definite_misses");
+    }
+    
+    // A probe is wasted if it lies past the block that ended the chain
+    for (size_t i = static_cast<size_t>(result.cachedBlocks) + 1; i < numFullBlocks; ++i) {
+        if (probeStates[i] != ProbeState::Unknown) {
+            result.probesWasted++;
+        }
+    }
+    
+    Log(LogLevel::Verbose, "[KVStore V2 Lookup]   Probes issued=" + std::to_string(result.probesIssued) + 
+        ", wasted=" + std::to_string(result.probesWasted), completionId);
+    
+    if (cacheHits > 0) {
+        Log(LogLevel::Verbose, "[KVStore V2 Lookup]   " + std::to_string(cacheHits) + "/" + std::to_string(numFullBlocks) + 
+            " blocks served from metadata cache", completionId);
     }
     
     auto endTime = std::chrono::high_resolution_clock::now();
@@ -621,252 +1087,718 @@ LookupResult AzureStorageKVStoreLibV2::Lookup(
     return result;
 }
 
+// IKVStoreEngine: Lookup over a token vector (dispatches to the iterator template)
+LookupResult AzureStorageKVStoreLibV2::Lookup(
+    const std::string& partitionKey,
+    const std::string& completionId,
+    std::vector<Token>::const_iterator begin,
+    std::vector<Token>::const_iterator end,
+    const std::vector<hash_t>& precomputedHashes,
+    ProbeStrategy probeStrategy
+) const {
+    return Lookup<std::vector<Token>::const_iterator>(partitionKey, completionId, begin, end, precomputedHashes, probeStrategy);
+}
+
 // V2 API: ReadAsync - Read from location directly
-std::future<std::pair<bool, PromptChunk>> AzureStorageKVStoreLibV2::ReadAsync(const std::string& location, const std::string& completionId) const {
-    return std::async(std::launch::async, [this, location, completionId]() -> std::pair<bool, PromptChunk> {
-        auto startTime = std::chrono::high_resolution_clock::now();
-        
-        try {
-            auto blobClient = blobContainerClient_->GetBlobClient(location);
-            
-            // Download includes metadata
-            auto downloadResponse = blobClient.Download();
-            
-            // Extract metadata from download response
-            std::string partitionKey;
-            hash_t parentHash = 0;
-            hash_t hash = 0;
-            
-            const auto& metadata = downloadResponse.Value.Details.Metadata;
-            auto metaIt = metadata.find("partitionKey");
-            if (metaIt != metadata.end()) {
-                partitionKey = metaIt->second;
+std::future<std::pair<bool, PromptChunk>> AzureStorageKVStoreLibV2::ReadAsync(const std::string& readLocation, const std::string& completionId) const {
+    // A shared payload (default blob or content blob) is read and cached once under its blob
+    // name; the version Lookup resolved comes from the location, not the blob's metadata
+    std::string location;
+    hash_t versionHash = 0;
+    hash_t versionParentHash = 0;
+    bool versioned = VersionRecord::SplitReadLocation(readLocation, location, versionHash, versionParentHash);
+    auto setVersion = [versioned, versionHash, versionParentHash](std::pair<bool, PromptChunk>& result) {
+        if (versioned && result.first) {
+            result.second.hash = versionHash;
+            result.second.parentHash = versionParentHash;
+        }
+    };
+    
+    // Locations are immutable, so a cached copy never goes stale
+    std::string cacheKey;
+    if (hotChunkCache_ || chunkCache_) {
+        cacheKey = azureAccountUrl_ + "/" + azureContainerName_ + "/" + location;
+    }
+    
+    // Memory hits complete on the calling thread without an executor hop
+    if (hotChunkCache_) {
+        if (auto cached = hotChunkCache_->Get(cacheKey)) {
+            Log(LogLevel::Information, "[KVStore V2 Read] ✓ Read from memory chunk cache: " + location, completionId);
+            // The cache keeps its copy, so the caller gets one of its own
+            std::pair<bool, PromptChunk> result{true, *cached};
+            result.second.bytesCopied = result.second.buffer.size();
+            setVersion(result);
+            std::promise<std::pair<bool, PromptChunk>> ready;
+            ready.set_value(std::move(result));
+            return ready.get_future();
+        }
+    }
+    
+    return StorageIoExecutor::GetInstance().Submit([this, location, completionId, cacheKey, setVersion]() {
+        // Concurrent reads of one location share a single cache lookup and download
+        bool coalesced = false;
+        auto result = readFlight_.Do(location, [&]() { return ReadChunk(location, completionId, cacheKey); }, &coalesced);
+        if (coalesced) {
+            kvstore::MetricsHelper::GetInstance().IncrementCounter("read.coalesced");
+            result.second.bytesCopied += result.second.buffer.size();
+        }
+        setVersion(result);
+        return result;
+    });
+}
+
+// Chunk cache, then storage; fills both cache tiers on a storage hit
+std::pair<bool, PromptChunk> AzureStorageKVStoreLibV2::ReadChunk(const std::string& location, const std::string& completionId, const std::string& cacheKey) const {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    
+    if (chunkCache_) {
+        PromptChunk cached;
+        if (chunkCache_->Get(cacheKey, cached)) {
+            if (hotChunkCache_) {
+                hotChunkCache_->Put(cacheKey, std::make_shared<const PromptChunk>(cached));
+                cached.bytesCopied = cached.buffer.size();
             }
-            auto parentIt = metadata.find("parentHash");
-            if (parentIt != metadata.end()) {
-                parentHash = std::stoull(parentIt->second);
+            auto endTime = std::chrono::high_resolution_clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+            Log(LogLevel::Information, "[KVStore V2 Read] ✓ Read from local chunk cache: " + location + " (" + std::to_string(duration) + "us)", completionId);
+            return {true, std::move(cached)};
+        }
+    }
+    
+    try {
+        auto blobClient = blobContainerClient_->GetBlobClient(location);
+        
+        // Download straight into the buffer that is later moved into the response
+        PromptChunk chunk;
+        auto metadata = DownloadPayload(blobClient, chunk.buffer);
+        chunk.bufferSize = chunk.buffer.size();
+        
+        // Extract metadata from download response
+        std::string partitionKey;
+        hash_t parentHash = 0;
+        hash_t hash = 0;
+        
+        auto metaIt = metadata.find("partitionKey");
+        if (metaIt != metadata.end()) {
+            partitionKey = metaIt->second;
+        }
+        auto parentIt = metadata.find("parentHash");
+        if (parentIt != metadata.end()) {
+            parentHash = std::stoull(parentIt->second);
+        }
+        auto hashIt = metadata.find("hash");
+        if (hashIt != metadata.end()) {
+            hash = std::stoull(hashIt->second);
+        }
+        
+        chunk.partitionKey = partitionKey;
+        chunk.parentHash = parentHash;
+        chunk.hash = hash;
+        chunk.encoding = ReadEncodingMetadata(metadata);   // Stays encoded; the reactor decodes for the client if needed
+        
+        // Both cache tiers share one copy; the disk fill runs off the read path
+        if (hotChunkCache_ || chunkCache_) {
+            auto shared = std::make_shared<const PromptChunk>(chunk);
+            chunk.bytesCopied = chunk.buffer.size();
+            if (hotChunkCache_) {
+                hotChunkCache_->Put(cacheKey, shared);
             }
-            auto hashIt = metadata.find("hash");
-            if (hashIt != metadata.end()) {
-                hash = std::stoull(hashIt->second);
+            if (chunkCache_) {
+                StorageIoExecutor::GetInstance().Submit([cache = chunkCache_, cacheKey, shared]() {
+                    cache->Put(cacheKey, *shared);
+                });
             }
-            
-            // Read blob content
-            auto& bodyStream = downloadResponse.Value.BodyStream;
-            std::vector<uint8_t> buffer;
-            buffer.resize(static_cast<size_t>(downloadResponse.Value.BlobSize));
-            bodyStream->ReadToCount(buffer.data(), buffer.size());
-            
-            PromptChunk chunk;
-            chunk.partitionKey = partitionKey;
-            chunk.parentHash = parentHash;
-            chunk.hash = hash;
-            chunk.buffer = buffer;
-            chunk.bufferSize = buffer.size();
-            
-            auto endTime = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
-            Log(LogLevel::Information, "[KVStore V2 Read] ✓ Read successful from location: " + location + " (" + std::to_string(duration) + "ms)", completionId);
-            
-            return {true, chunk};
-        } catch (const Azure::Storage::StorageException& ex) {
-            auto endTime = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
-            Log(LogLevel::Error, "[KVStore V2 Read] ✗ Read failed from location: " + location + " - " + std::string(ex.what()) + " (" + std::to_string(duration) + "ms)", completionId);
-            return {false, PromptChunk()};
         }
-    });
+        
+        auto endTime = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+        Log(LogLevel::Information, "[KVStore V2 Read] ✓ Read successful from location: " + location + " (" + std::to_string(duration) + "ms)", completionId);
+        
+        return {true, std::move(chunk)};
+    } catch (const Azure::Storage::StorageException& ex) {
+        auto endTime = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+        Log(LogLevel::Error, "[KVStore V2 Read] ✗ Read failed from location: " + location + " - " + std::string(ex.what()) + " (" + std::to_string(duration) + "ms)", completionId);
+        return {false, PromptChunk()};
+    }
 }
 
 // V2 API: WriteAsync - Multi-version blob support with conflict detection
 std::future<void> AzureStorageKVStoreLibV2::WriteAsync(const PromptChunk& chunk) {
-    return std::async(std::launch::async, [this, chunk]() {
-        try {
-            // Encode blob name from tokens
-            std::string blobName = EncodeTokensToBlobName(chunk.tokens.cbegin(), chunk.tokens.cend());
-            auto blockBlobClient = blobContainerClient_->GetBlobClient(blobName).AsBlockBlobClient();
-            
-            Log(LogLevel::Verbose, "[KVStore V2 Write] Writing chunk - Hash: " + std::to_string(chunk.hash) + 
-                ", Parent: " + std::to_string(chunk.parentHash) + ", Blob: " + blobName, chunk.completionId);
+    return StorageIoExecutor::GetInstance().Submit([this, chunk]() {
+        // Same failures WriteBatch reports per block; the future carries them to the caller
+        BlockWriteStatus status = WriteChunk(chunk);
+        if (!status.success) {
+            throw std::runtime_error(status.error);
+        }
+    });
+}
 
-            // Try to upload as first version using IfNoneMatch to detect server-side conflicts
-            bool blobExists = false;
-            std::string currentETag;
-            std::unordered_map<std::string, std::string> metadata;
-            
+// Blocks of a chain are independent blobs (parents are only metadata), so they upload in
+// parallel; a concurrent Lookup simply stops at the first block not yet written
+std::future<std::vector<BlockWriteStatus>> AzureStorageKVStoreLibV2::WriteBatchAsync(std::vector<PromptChunk> chunks) {
+    return StorageIoExecutor::GetInstance().Submit([this, chunks = std::move(chunks)]() {
+        auto startTime = std::chrono::high_resolution_clock::now();
+        std::vector<BlockWriteStatus> statuses(chunks.size());
+        StorageIoExecutor::GetInstance().ParallelFor(chunks.size(), 0, [&](size_t i) {
+            try {
+                statuses[i] = WriteChunk(chunks[i]);
+            } catch (const std::exception& e) {
+                statuses[i] = BlockWriteStatus(chunks[i].hash, false, e.what());
+            }
+        });
+
+        size_t failed = 0;
+        for (const auto& status : statuses) {
+            failed += status.success ? 0 : 1;
+        }
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - startTime).count();
+        Log(failed ? LogLevel::Error : LogLevel::Information, "[KVStore V2 WriteBatch] Wrote " +
+            std::to_string(chunks.size() - failed) + "/" + std::to_string(chunks.size()) + " blocks (" +
+            std::to_string(duration) + "ms)", chunks.empty() ? "" : chunks.front().completionId);
+        return statuses;
+    });
+}
+
+// Synchronous single-block write shared by WriteAsync and WriteBatchAsync
+BlockWriteStatus AzureStorageKVStoreLibV2::WriteChunk(const PromptChunk& chunk) {
+    // Encode blob name from tokens (new writes always use the configured naming mode)
+    std::string blobName = BlobNameFor(chunk.tokens.cbegin(), chunk.tokens.cend());
+    
+    // Shared prefixes are rewritten constantly; a version confirmed here moments ago needs no round trip
+    if (recentWrites_.Contains(blobName, chunk.hash, chunk.parentHash)) {
+        Log(LogLevel::Verbose, "[KVStore V2 Write]   ✓ Version recently written, skipping: " + blobName, chunk.completionId);
+        auto& metrics = kvstore::MetricsHelper::GetInstance();
+        metrics.IncrementCounter("write.recent_skips");
+        metrics.IncrementCounter("write.bytes_saved", chunk.bufferSize);
+        return BlockWriteStatus(chunk.hash, true);
+    }
+    
+    // Identical concurrent writes (same block, same version) share one upload and metadata
+    // update instead of racing each other through the ETag retry loop
+    std::string flightKey = blobName + "|" + std::to_string(chunk.hash) + "|" + std::to_string(chunk.parentHash);
+    bool coalesced = false;
+    auto status = writeFlight_.Do(flightKey, [&]() { return WriteChunkToStorage(chunk, blobName); }, &coalesced);
+    if (coalesced) {
+        Log(LogLevel::Verbose, "[KVStore V2 Write]   ✓ Joined an identical in-flight write: " + blobName, chunk.completionId);
+        kvstore::MetricsHelper::GetInstance().IncrementCounter("write.coalesced");
+    }
+    if (status.success) {
+        recentWrites_.Insert(blobName, chunk.hash, chunk.parentHash);
+    }
+    return status;
+}
+
+BlockWriteStatus AzureStorageKVStoreLibV2::WriteChunkToStorage(const PromptChunk& chunk, const std::string& blobName) {
+    std::string tokenBlobName = blobNaming_ == BlobNamingMode::Hash
+        ? EncodeTokensToBlobName(chunk.tokens.cbegin(), chunk.tokens.cend()) : std::string();
+    try {
+        auto blockBlobClient = blobContainerClient_->GetBlobClient(blobName).AsBlockBlobClient();
+        
+        Log(LogLevel::Verbose, "[KVStore V2 Write] Writing chunk - Hash: " + std::to_string(chunk.hash) + 
+            ", Parent: " + std::to_string(chunk.parentHash) + ", Blob: " + blobName, chunk.completionId);
+
+        auto& metrics = kvstore::MetricsHelper::GetInstance();
+        std::string currentETag;
+        std::unordered_map<std::string, std::string> metadata;
+        
+        // Avoid sending the payload only to get a 409 back: a cached entry means the default blob
+        // exists (and may already hold this version), and a Bloom hit is worth a HEAD first
+        std::optional<Azure::Storage::Blobs::Models::BlobProperties> properties;
+        bool payloadSent = false;   // A first-version upload went out and got a 409
+        // write.bytes_saved counts only writes whose payload never left this server
+        auto countSaved = [&]() {
+            if (!payloadSent) {
+                metrics.IncrementCounter("write.bytes_saved", chunk.bufferSize);
+            }
+        };
+        BlockMetadata cached;
+        bool cachedHit = metadataCache_.Get(blobName, cached);
+        if (cachedHit && HasVersion(cached, chunk.hash, chunk.parentHash)) {
+            Log(LogLevel::Information, "[KVStore V2 Write]   ✓ Identical version cached - skipping upload", chunk.completionId);
+            metrics.IncrementCounter("write.bytes_saved", chunk.bufferSize);
+            return BlockWriteStatus(chunk.hash, true);
+        }
+        if (cachedHit || (blobNameFilter_ && blobNameFilter_->MightContain(blobName))) {
+            try {
+                properties = blockBlobClient.GetProperties().Value;
+            } catch (const Azure::Storage::StorageException& ex) {
+                if (ex.StatusCode != Azure::Core::Http::HttpStatusCode::NotFound) {
+                    throw;
+                }
+                metadataCache_.Invalidate(blobName);
+                metrics.IncrementCounter("write.precheck_misses");
+            }
+        }
+        
+        if (!properties) {
+            // Upload as first version using IfNoneMatch to detect server-side conflicts
             try {
-                // Use Upload API with IfNoneMatch=Any() for server-side conflict detection
-                Azure::Core::IO::MemoryBodyStream contentStream(chunk.buffer.data(), chunk.bufferSize);
                 Azure::Storage::Blobs::UploadBlockBlobOptions uploadOptions;
                 uploadOptions.Metadata["hash"] = std::to_string(chunk.hash);
                 uploadOptions.Metadata["parenthash"] = std::to_string(chunk.parentHash);
                 uploadOptions.Metadata["location"] = blobName;
+                if (!tokenBlobName.empty()) {
+                    uploadOptions.Metadata["tokens"] = tokenBlobName;  // Collision check for hash names
+                }
+                SetEncodingMetadata(uploadOptions.Metadata, chunk.encoding);
+                if (contentDedup_) {
+                    // Lets a later version with the same bytes point here instead of uploading
+                    uploadOptions.Metadata[kContentHashMetadataKey] = PayloadDigest(chunk).Hex();
+                }
                 uploadOptions.AccessConditions.IfNoneMatch = Azure::ETag::Any();  // Only succeed if blob doesn't exist
 
-                auto uploadResponse = blockBlobClient.Upload(contentStream, uploadOptions);
+                UploadPayload(blockBlobClient, chunk, uploadOptions);
                 Log(LogLevel::Information, "[KVStore V2 Write]   ✓ First version uploaded successfully", chunk.completionId);
-                return;
+                AddToBloomFilter(blobName);
+                
+                BlockMetadata written;
+                written.hash = chunk.hash;
+                written.parentHash = chunk.parentHash;
+                metadataCache_.Put(blobName, std::move(written));
+                return BlockWriteStatus(chunk.hash, true);
                 
             } catch (const Azure::Storage::StorageException& ex) {
                 // 409 Conflict means blob already exists - fall through to multi-version logic
                 if (ex.StatusCode != Azure::Core::Http::HttpStatusCode::Conflict) {
                     throw;  // Re-throw if not a conflict
                 }
-                blobExists = true;
+                AddToBloomFilter(blobName);
+                payloadSent = true;
+                metrics.IncrementCounter("write.conflict_uploads");
                 Log(LogLevel::Verbose, "[KVStore V2 Write]   ⚠ Blob exists (conflict detected) - checking for version conflict", chunk.completionId);
             }
-            
-            // Blob exists - get metadata and check for version conflict
-            auto propertiesResponse = blockBlobClient.GetProperties();
-            currentETag = propertiesResponse.Value.ETag.ToString();
-            // Convert CaseInsensitiveMap to unordered_map
-            for (const auto& [key, value] : propertiesResponse.Value.Metadata) {
-                metadata[key] = value;
-                Log(LogLevel::Verbose, "[KVStore V2 Write]   → Read metadata key='" + key + "', value='" + value + "'", chunk.completionId);
+            properties = blockBlobClient.GetProperties().Value;
+        }
+        
+        // Blob exists - check its metadata for a version conflict
+        const auto& propertiesValue = *properties;
+        currentETag = propertiesValue.ETag.ToString();
+        if (!tokenBlobName.empty()) {
+            auto tokensIt = propertiesValue.Metadata.find("tokens");
+            if (tokensIt != propertiesValue.Metadata.end() && tokensIt->second != tokenBlobName) {
+                Log(LogLevel::Error, "[KVStore V2 Write]   ✗ Blob name hash collision on " + blobName + " - not writing", chunk.completionId);
+                kvstore::MetricsHelper::GetInstance().IncrementCounter("blob_naming.hash_collisions");
+                BlockWriteStatus collision(chunk.hash, false, "Blob name hash collision on " + blobName);
+                collision.permanent = true;
+                return collision;
             }
-            
-            // Log metadata immediately after reading
-            Log(LogLevel::Verbose, "[KVStore V2 Write]   → Metadata after GetProperties: hash=" + 
-                (metadata.find("hash") != metadata.end() ? metadata["hash"] : "NOT_FOUND") + 
-                ", parenthash=" + 
-                (metadata.find("parenthash") != metadata.end() ? metadata["parenthash"] : "NOT_FOUND"), chunk.completionId);
-
-            // Check if same (hash, parentHash) already exists
-            auto hashIt = metadata.find("hash");
-            auto parentHashIt = metadata.find("parenthash");
-            if (hashIt != metadata.end() && parentHashIt != metadata.end()) {
-                if (hashIt->second == std::to_string(chunk.hash) && 
-                    parentHashIt->second == std::to_string(chunk.parentHash)) {
-                    Log(LogLevel::Information, "[KVStore V2 Write]   ✓ Identical version already exists - skipping", chunk.completionId);
-                    return;
-                }
+        }
+        metadataCache_.Put(blobName, ParseBlockMetadata(propertiesValue.Metadata));
+        // Convert CaseInsensitiveMap to unordered_map
+        for (const auto& [key, value] : propertiesValue.Metadata) {
+            metadata[key] = value;
+            Log(LogLevel::Verbose, "[KVStore V2 Write]   → Read metadata key='" + key + "', value='" + value + "'", chunk.completionId);
+        }
+        
+        // Log metadata immediately after reading
+        Log(LogLevel::Verbose, "[KVStore V2 Write]   → Metadata after GetProperties: hash=" + 
+            (metadata.find("hash") != metadata.end() ? metadata["hash"] : "NOT_FOUND") + 
+            ", parenthash=" + 
+            (metadata.find("parenthash") != metadata.end() ? metadata["parenthash"] : "NOT_FOUND"), chunk.completionId);
+
+        // Check if same (hash, parentHash) already exists
+        auto hashIt = metadata.find("hash");
+        auto parentHashIt = metadata.find("parenthash");
+        if (hashIt != metadata.end() && parentHashIt != metadata.end()) {
+            if (hashIt->second == std::to_string(chunk.hash) && 
+                parentHashIt->second == std::to_string(chunk.parentHash)) {
+                Log(LogLevel::Information, "[KVStore V2 Write]   ✓ Identical version already exists - skipping", chunk.completionId);
+                countSaved();
+                return BlockWriteStatus(chunk.hash, true);
             }
+        }
 
-            // Check if already multi-version (has additionalVersions)
-            std::vector<AdditionalVersion> existingVersions;
-            auto versionsIt = metadata.find("additionalversions");
-            if (versionsIt != metadata.end() && !versionsIt->second.empty()) {
-                // Parse existing additionalVersions
-                existingVersions = ParseAdditionalVersions(versionsIt->second);
-                
-                // Check if this version already exists in additional versions
-                for (const auto& ver : existingVersions) {
-                    if (ver.hash == chunk.hash && ver.parentHash == chunk.parentHash) {
-                        Log(LogLevel::Information, "[KVStore V2 Write]   ✓ Version already exists in additionalVersions - skipping", chunk.completionId);
-                        return;
-                    }
+        // An index this server cannot decode is left alone rather than replaced by one holding only this version
+        auto unreadableIndex = [&]() {
+            Log(LogLevel::Error, "[KVStore V2 Write]   ✗ Unreadable version index on " + blobName + " - not writing", chunk.completionId);
+            metrics.IncrementCounter("write.unreadable_version_index");
+            BlockWriteStatus status(chunk.hash, false, "Unreadable version index on " + blobName);
+            status.permanent = true;
+            return status;
+        };
+        
+        // Check if this version already exists in the version index
+        VersionIndex existingVersions;
+        if (!ReadVersionIndex(metadata, existingVersions)) {
+            return unreadableIndex();
+        }
+        if (existingVersions.Contains(chunk.hash, chunk.parentHash)) {
+            Log(LogLevel::Information, "[KVStore V2 Write]   ✓ Version already exists in additionalVersions - skipping", chunk.completionId);
+            countSaved();
+            return BlockWriteStatus(chunk.hash, true);
+        }
+
+        // New conflict - the additional version needs a payload blob
+        VersionRecord newVersion;
+        newVersion.hash = chunk.hash;
+        newVersion.parentHash = chunk.parentHash;
+        std::string guidLocation;   // Only for a private GUID blob, which this write owns until the CAS
+        std::string contentLocation;
+        bool contentTouched = false;   // Content blob written since this write began, so GC leaves it
+        auto storeContent = [&]() {
+            contentTouched = true;
+            return contentFlight_.Do(contentLocation, [&]() { return UploadContent(chunk, contentLocation, newVersion.content); });
+        };
+        
+        if (contentDedup_) {
+            // Same bytes after a different prefix are common: point at the default blob or an
+            // existing content blob, and upload only payloads no version has stored yet
+            ContentDigest digest = PayloadDigest(chunk);
+            auto defaultDigestIt = metadata.find(kContentHashMetadataKey);
+            if (defaultDigestIt != metadata.end() && defaultDigestIt->second == digest.Hex()) {
+                newVersion.payload = VersionPayload::Default;
+                Log(LogLevel::Verbose, "[KVStore V2 Write]   ✓ Payload identical to the default version - no upload", chunk.completionId);
+                metrics.IncrementCounter("dedup.hits");
+                metrics.IncrementCounter("dedup.bytes_saved", chunk.bufferSize);
+                countSaved();
+            } else {
+                newVersion.payload = VersionPayload::Content;
+                newVersion.content = digest;
+                contentLocation = VersionRecord::ContentLocation(blobName, digest);
+                bool uploaded = false;
+                if (!existingVersions.FindByContent(digest)) {
+                    uploaded = storeContent();
                 }
+                if (uploaded) {
+                    metrics.IncrementCounter("dedup.content_uploads");
+                } else {
+                    metrics.IncrementCounter("dedup.hits");
+                    metrics.IncrementCounter("dedup.bytes_saved", chunk.bufferSize);
+                    countSaved();
+                }
+                Log(LogLevel::Verbose, "[KVStore V2 Write]   ✓ Additional version stored at " + contentLocation +
+                    (uploaded ? "" : " (payload already present)"), chunk.completionId);
             }
-
-            // New conflict - need to create GUID blob for additional version
-            std::string guidLocation = GenerateGuid();
+        } else {
+            guidLocation = GenerateGuid();
+            VersionRecord::ParseLocation(guidLocation, newVersion.locationHigh, newVersion.locationLow);
             Log(LogLevel::Verbose, "[KVStore V2 Write]   → Creating additional version blob: " + guidLocation, chunk.completionId);
 
             // Upload to GUID blob
             auto guidBlobClient = blobContainerClient_->GetBlobClient(guidLocation).AsBlockBlobClient();
-            Azure::Core::IO::MemoryBodyStream guidContentStream(chunk.buffer.data(), chunk.bufferSize);
             Azure::Storage::Blobs::UploadBlockBlobOptions guidUploadOptions;
             guidUploadOptions.Metadata["hash"] = std::to_string(chunk.hash);
             guidUploadOptions.Metadata["parenthash"] = std::to_string(chunk.parentHash);
             guidUploadOptions.Metadata["location"] = guidLocation;
+            SetEncodingMetadata(guidUploadOptions.Metadata, chunk.encoding);
             
-            auto guidUploadResponse = guidBlobClient.Upload(guidContentStream, guidUploadOptions);
+            UploadPayload(guidBlobClient, chunk, guidUploadOptions);
             Log(LogLevel::Verbose, "[KVStore V2 Write]   ✓ GUID blob uploaded successfully", chunk.completionId);
+        }
 
-            // Update metadata on default blob with retry (ETag-based optimistic concurrency)
-            const int maxRetries = 5;
-            for (int retry = 0; retry < maxRetries; ++retry) {
-                try {
-                    // Re-fetch properties if retry
-                    if (retry > 0) {
-                        auto retryPropertiesResponse = blockBlobClient.GetProperties();
-                        currentETag = retryPropertiesResponse.Value.ETag.ToString();
-                        // Convert CaseInsensitiveMap to unordered_map
-                        metadata.clear();
-                        for (const auto& [key, value] : retryPropertiesResponse.Value.Metadata) {
-                            metadata[key] = value;
-                        }
-                        
-                        // Re-parse versions in case they changed
-                        auto versionsIt = metadata.find("additionalversions");
-                        if (versionsIt != metadata.end()) {
-                            existingVersions = ParseAdditionalVersions(versionsIt->second);
+        // Update metadata on default blob with retry (ETag-based optimistic concurrency)
+        std::vector<std::string> evictedLocations;
+        std::vector<std::string> evictedContent;
+        std::vector<VersionRecord> evictedVersions;
+        const int maxRetries = 5;
+        for (int retry = 0; retry < maxRetries; ++retry) {
+            try {
+                // Re-fetch properties if retry
+                if (retry > 0) {
+                    auto retryPropertiesResponse = blockBlobClient.GetProperties();
+                    currentETag = retryPropertiesResponse.Value.ETag.ToString();
+                    // Convert CaseInsensitiveMap to unordered_map
+                    metadata.clear();
+                    for (const auto& [key, value] : retryPropertiesResponse.Value.Metadata) {
+                        metadata[key] = value;
+                    }
+                    
+                    // Re-read versions in case they changed
+                    if (!ReadVersionIndex(metadata, existingVersions)) {
+                        if (!guidLocation.empty()) {
+                            versionReclaimer_->Enqueue({guidLocation});   // Never referenced by the index
                         }
+                        return unreadableIndex();
                     }
+                    // The version that made the upload unnecessary may have been evicted since,
+                    // and GC may be deleting its content blob: make sure it exists and is fresh
+                    if (newVersion.payload == VersionPayload::Content && !contentTouched &&
+                        !existingVersions.FindByContent(newVersion.content)) {
+                        storeContent();
+                    }
+                }
 
-                    // Add new version
-                    AdditionalVersion newVersion;
-                    newVersion.hash = chunk.hash;
-                    newVersion.parentHash = chunk.parentHash;
-                    newVersion.location = guidLocation;
-                    existingVersions.push_back(newVersion);
-
-                    // FIFO eviction if capacity exceeded (~60 versions)
-                    const size_t maxVersions = 60;
-                    while (existingVersions.size() > maxVersions) {
-                        auto oldestVersion = existingVersions.front();
-                        Log(LogLevel::Verbose, "[KVStore V2 Write]   ⚠ Evicting oldest version: " + oldestVersion.location, chunk.completionId);
-                        
-                        // Delete oldest GUID blob
-                        try {
-                            auto oldBlobClient = blobContainerClient_->GetBlobClient(oldestVersion.location).AsBlockBlobClient();
-                            oldBlobClient.Delete();
-                            Log(LogLevel::Verbose, "[KVStore V2 Write]   ✓ Evicted blob: " + oldestVersion.location, chunk.completionId);
-                        } catch (const Azure::Storage::StorageException& delEx) {
-                            Log(LogLevel::Error, "[KVStore V2 Write]   ✗ Failed to evict blob: " + oldestVersion.location + 
-                                " - " + delEx.what(), chunk.completionId);
+                // Add new version, FIFO-evicting beyond the cap (~60 versions). Evicted GUID blobs are
+                // only reclaimed once the metadata CAS below has dropped them from the index; an
+                // evicted content blob is handed to content GC unless another version still uses it.
+                VersionIndex updatedVersions = existingVersions;
+                evictedLocations.clear();
+                evictedContent.clear();
+                evictedVersions = updatedVersions.Append(newVersion);
+                for (const auto& oldestVersion : evictedVersions) {
+                    Log(LogLevel::Verbose, "[KVStore V2 Write]   ⚠ Evicting oldest version: " + oldestVersion.Location(blobName), chunk.completionId);
+                    if (oldestVersion.payload == VersionPayload::Guid) {
+                        evictedLocations.push_back(oldestVersion.Location(blobName));
+                    } else if (oldestVersion.payload == VersionPayload::Content && !updatedVersions.FindByContent(oldestVersion.content)) {
+                        std::string location = oldestVersion.Location(blobName);
+                        if (std::find(evictedContent.begin(), evictedContent.end(), location) == evictedContent.end()) {
+                            evictedContent.push_back(location);
                         }
-                        
-                        existingVersions.erase(existingVersions.begin());
                     }
+                }
 
-                    // Serialize updated versions
-                    std::string versionsJson = SerializeAdditionalVersions(existingVersions);
+                // Serialize updated versions
+                std::string versionsIndex = updatedVersions.Encode();
 
-                    // Update metadata with ETag condition
-                    Azure::Storage::Blobs::SetBlobMetadataOptions setMetadataOptions;
-                    setMetadataOptions.AccessConditions.IfMatch = Azure::ETag(currentETag);
-                    
-                    metadata["additionalversions"] = versionsJson;
+                // Update metadata with ETag condition
+                Azure::Storage::Blobs::SetBlobMetadataOptions setMetadataOptions;
+                setMetadataOptions.AccessConditions.IfMatch = Azure::ETag(currentETag);
+                
+                // The binary index replaces the legacy JSON on first rewrite
+                metadata.erase(VersionIndex::kLegacyMetadataKey);
+                metadata[VersionIndex::kMetadataKey] = versionsIndex;
 
-                    Log(LogLevel::Verbose, "[KVStore V2 Write]   → Setting additionalVersions count=" + 
-                        std::to_string(existingVersions.size()), chunk.completionId);
-                    
-                    // Log metadata values before update
-                    Log(LogLevel::Verbose, "[KVStore V2 Write]   → About to write metadata:", chunk.completionId);
-                    Log(LogLevel::Verbose, "[KVStore V2 Write]     hash=" + metadata["hash"], chunk.completionId);
-                    Log(LogLevel::Verbose, "[KVStore V2 Write]     parenthash=" + metadata["parenthash"], chunk.completionId);
-                    Log(LogLevel::Verbose, "[KVStore V2 Write]     additionalVersions=" + versionsJson, chunk.completionId);
-
-                    // Convert unordered_map to Azure::Storage::Metadata (CaseInsensitiveMap)
-                    Azure::Storage::Metadata azureMetadata;
-                    for (const auto& [key, value] : metadata) {
-                        azureMetadata[key] = value;
-                    }
-                    auto setMetadataResponse = blockBlobClient.SetMetadata(azureMetadata, setMetadataOptions);
-                    Log(LogLevel::Information, "[KVStore V2 Write]   ✓ Metadata updated successfully (retry " + 
-                        std::to_string(retry + 1) + "/" + std::to_string(maxRetries) + ")", chunk.completionId);
-                    return;
-                    
-                } catch (const Azure::Storage::StorageException& metadataEx) {
-                    // ETag mismatch - concurrent update occurred
-                    if (metadataEx.StatusCode == Azure::Core::Http::HttpStatusCode::PreconditionFailed) {
-                        Log(LogLevel::Verbose, "[KVStore V2 Write]   ⚠ ETag mismatch on retry " + std::to_string(retry + 1) + 
-                            " - retrying...", chunk.completionId);
-                        if (retry == maxRetries - 1) {
-                            Log(LogLevel::Error, "[KVStore V2 Write]   ✗ Max retries exceeded - giving up", chunk.completionId);
-                            throw;
+                Log(LogLevel::Verbose, "[KVStore V2 Write]   → Setting additionalVersions count=" + 
+                    std::to_string(updatedVersions.size()), chunk.completionId);
+                
+                // Log metadata values before update
+                Log(LogLevel::Verbose, "[KVStore V2 Write]   → About to write metadata:", chunk.completionId);
+                Log(LogLevel::Verbose, "[KVStore V2 Write]     hash=" + metadata["hash"], chunk.completionId);
+                Log(LogLevel::Verbose, "[KVStore V2 Write]     parenthash=" + metadata["parenthash"], chunk.completionId);
+                Log(LogLevel::Verbose, "[KVStore V2 Write]     versionIndex=" + versionsIndex, chunk.completionId);
+
+                // Convert unordered_map to Azure::Storage::Metadata (CaseInsensitiveMap)
+                Azure::Storage::Metadata azureMetadata;
+                for (const auto& [key, value] : metadata) {
+                    azureMetadata[key] = value;
+                }
+                auto setMetadataResponse = blockBlobClient.SetMetadata(azureMetadata, setMetadataOptions);
+                metadataCache_.Put(blobName, ParseBlockMetadata(azureMetadata));
+                versionReclaimer_->Enqueue(evictedLocations);
+                contentReclaimer_->Enqueue(evictedContent);
+                for (const auto& evicted : evictedVersions) {
+                    recentWrites_.Erase(blobName, evicted.hash, evicted.parentHash);
+                }
+                Log(LogLevel::Information, "[KVStore V2 Write]   ✓ Metadata updated successfully (retry " + 
+                    std::to_string(retry + 1) + "/" + std::to_string(maxRetries) + ")", chunk.completionId);
+                return BlockWriteStatus(chunk.hash, true);
+                
+            } catch (const Azure::Storage::StorageException& metadataEx) {
+                // ETag mismatch - concurrent update occurred
+                if (metadataEx.StatusCode == Azure::Core::Http::HttpStatusCode::PreconditionFailed) {
+                    Log(LogLevel::Verbose, "[KVStore V2 Write]   ⚠ ETag mismatch on retry " + std::to_string(retry + 1) + 
+                        " - retrying...", chunk.completionId);
+                    if (retry == maxRetries - 1) {
+                        Log(LogLevel::Error, "[KVStore V2 Write]   ✗ Max retries exceeded - giving up", chunk.completionId);
+                        if (!guidLocation.empty()) {
+                            versionReclaimer_->Enqueue({guidLocation});   // Never referenced by the index
+                        }
+                        if (!contentLocation.empty()) {
+                            contentReclaimer_->Enqueue({contentLocation});   // Kept if another version uses it
                         }
-                        continue;
+                        throw;
                     }
+                    continue;
+                }
+                throw;
+            }
+        }
+    } catch (const Azure::Storage::StorageException& ex) {
+        metadataCache_.Invalidate(blobName);
+        Log(LogLevel::Error, "[KVStore V2 Write]   ✗ Azure StorageException: " + std::string(ex.what()), chunk.completionId);
+        return BlockWriteStatus(chunk.hash, false, ex.what());
+    }
+    return BlockWriteStatus(chunk.hash, false, "Metadata update retries exhausted");
+}
+
+void AzureStorageKVStoreLibV2::UploadPayload(const Azure::Storage::Blobs::BlockBlobClient& client, const PromptChunk& chunk,
+                                             const Azure::Storage::Blobs::UploadBlockBlobOptions& options) const {
+    uint64_t size = chunk.bufferSize;
+    if (transferOptions_.thresholdBytes == 0 || size <= transferOptions_.thresholdBytes) {
+        Azure::Core::IO::MemoryBodyStream contentStream(ChunkData(chunk.buffer), chunk.bufferSize);
+        client.Upload(contentStream, options);
+        return;
+    }
+    
+    // Block IDs start with a per-upload nonce: blocks another writer stages on the same blob
+    // name can never end up in our commit (IDs must all have the same length)
+    uint64_t partBytes = std::max<uint64_t>(transferOptions_.partBytes, 1);
+    size_t parts = static_cast<size_t>((size + partBytes - 1) / partBytes);
+    std::string nonce = GenerateGuid();
+    std::vector<std::string> blockIds(parts);
+    for (size_t i = 0; i < parts; ++i) {
+        std::string index = std::to_string(i);
+        std::string id = nonce + "-" + std::string(8 - std::min<size_t>(index.size(), 8), '0') + index;
+        blockIds[i] = Azure::Core::Convert::Base64Encode(std::vector<uint8_t>(id.begin(), id.end()));
+    }
+    
+    StorageIoExecutor::GetInstance().ParallelFor(parts, transferOptions_.parallelism, [&](size_t i) {
+        uint64_t offset = i * partBytes;
+        Azure::Core::IO::MemoryBodyStream partStream(ChunkData(chunk.buffer) + offset, static_cast<size_t>(std::min(partBytes, size - offset)));
+        client.StageBlock(blockIds[i], partStream);
+    });
+    
+    // The commit is what makes the blob visible, so it carries the upload's conditions
+    Azure::Storage::Blobs::CommitBlockListOptions commitOptions;
+    commitOptions.Metadata = options.Metadata;
+    commitOptions.AccessConditions = options.AccessConditions;
+    client.CommitBlockList(blockIds, commitOptions);
+    
+    auto& metrics = kvstore::MetricsHelper::GetInstance();
+    metrics.IncrementCounter("transfer.staged_uploads");
+    metrics.IncrementCounter("transfer.staged_blocks", parts);
+}
+
+// Payload bytes at a location never change (uploads are create-only), so the ranged GETs need
+// no ETag condition even though metadata updates move the default blob's ETag
+Azure::Storage::Metadata AzureStorageKVStoreLibV2::DownloadPayload(const Azure::Storage::Blobs::BlobClient& client, ChunkBuffer& buffer) const {
+    uint64_t firstBytes = transferOptions_.thresholdBytes;
+    auto download = [&]() {
+        if (firstBytes == 0) {
+            return client.Download();
+        }
+        Azure::Storage::Blobs::DownloadBlobOptions options;
+        Azure::Core::Http::HttpRange range;
+        range.Offset = 0;
+        range.Length = static_cast<int64_t>(firstBytes);
+        options.Range = range;
+        try {
+            return client.Download(options);
+        } catch (const Azure::Storage::StorageException& ex) {
+            if (ex.StatusCode != Azure::Core::Http::HttpStatusCode::RangeNotSatisfiable) {
+                throw;
+            }
+            return client.Download();   // Empty blobs reject every range
+        }
+    };
+    auto response = download();
+    
+    uint64_t size = static_cast<uint64_t>(response.Value.BlobSize);
+    uint64_t first = firstBytes == 0 ? size : std::min(size, firstBytes);
+    buffer.resize(static_cast<size_t>(size));
+    response.Value.BodyStream->ReadToCount(reinterpret_cast<uint8_t*>(&buffer[0]), static_cast<size_t>(first));
+    
+    if (first < size) {
+        uint64_t partBytes = std::max<uint64_t>(transferOptions_.partBytes, 1);
+        size_t parts = static_cast<size_t>((size - first + partBytes - 1) / partBytes);
+        StorageIoExecutor::GetInstance().ParallelFor(parts, transferOptions_.parallelism, [&](size_t i) {
+            uint64_t offset = first + i * partBytes;
+            uint64_t length = std::min(partBytes, size - offset);
+            Azure::Storage::Blobs::DownloadBlobOptions partOptions;
+            Azure::Core::Http::HttpRange range;
+            range.Offset = static_cast<int64_t>(offset);
+            range.Length = static_cast<int64_t>(length);
+            partOptions.Range = range;
+            auto part = client.Download(partOptions);
+            part.Value.BodyStream->ReadToCount(reinterpret_cast<uint8_t*>(&buffer[static_cast<size_t>(offset)]), static_cast<size_t>(length));
+        });
+        
+        auto& metrics = kvstore::MetricsHelper::GetInstance();
+        metrics.IncrementCounter("transfer.ranged_downloads");
+        metrics.IncrementCounter("transfer.ranged_parts", parts + 1);
+    }
+    return response.Value.Details.Metadata;
+}
+
+// Content blobs are immutable and named by their digest, so any existing copy will do, but
+// reusing one must touch it (rewrite its metadata) so content GC sees a recent write and leaves
+// it alone until the index CAS that references it has landed. Like the default blob, the
+// payload is only sent when the Bloom filter or the touch says the blob is not there.
+bool AzureStorageKVStoreLibV2::UploadContent(const PromptChunk& chunk, const std::string& location, const ContentDigest& digest) {
+    auto blockBlobClient = blobContainerClient_->GetBlobClient(location).AsBlockBlobClient();
+    Azure::Storage::Metadata contentMetadata;
+    contentMetadata[kContentHashMetadataKey] = digest.Hex();
+    SetEncodingMetadata(contentMetadata, chunk.encoding);
+    
+    // False if the blob does not exist
+    auto touch = [&]() {
+        try {
+            blockBlobClient.SetMetadata(contentMetadata);
+            return true;
+        } catch (const Azure::Storage::StorageException& ex) {
+            if (ex.StatusCode != Azure::Core::Http::HttpStatusCode::NotFound) {
+                throw;
+            }
+            return false;
+        }
+    };
+    
+    if (blobNameFilter_ && blobNameFilter_->MightContain(location) && touch()) {
+        return false;
+    }
+    // A 409 followed by a 404 means GC deleted the blob in between; the next upload recreates it
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        try {
+            Azure::Storage::Blobs::UploadBlockBlobOptions uploadOptions;
+            uploadOptions.Metadata = contentMetadata;
+            uploadOptions.AccessConditions.IfNoneMatch = Azure::ETag::Any();
+            UploadPayload(blockBlobClient, chunk, uploadOptions);
+            AddToBloomFilter(location);
+            return true;
+        } catch (const Azure::Storage::StorageException& ex) {
+            // 409: another writer stored the same bytes first
+            if (ex.StatusCode != Azure::Core::Http::HttpStatusCode::Conflict) {
+                throw;
+            }
+        }
+        AddToBloomFilter(location);
+        if (touch()) {
+            return false;
+        }
+    }
+    throw std::runtime_error("Content blob " + location + " deleted while being stored");
+}
+
+std::vector<bool> AzureStorageKVStoreLibV2::ReclaimContentBlobs(const std::vector<std::string>& blobNames) const {
+    auto& metrics = kvstore::MetricsHelper::GetInstance();
+    std::vector<bool> done(blobNames.size(), false);
+    for (size_t i = 0; i < blobNames.size(); ++i) {
+        std::string blobName;
+        ContentDigest digest;
+        if (!VersionRecord::ParseContentLocation(blobNames[i], blobName, digest)) {
+            done[i] = true;
+            continue;
+        }
+        
+        try {
+            auto contentClient = blobContainerClient_->GetBlobClient(blobNames[i]);
+            Azure::Storage::Blobs::Models::BlobProperties contentProperties;
+            try {
+                contentProperties = contentClient.GetProperties().Value;
+            } catch (const Azure::Storage::StorageException& ex) {
+                if (ex.StatusCode != Azure::Core::Http::HttpStatusCode::NotFound) {
+                    throw;
+                }
+                done[i] = true;
+                continue;
+            }
+            // Written recently: a writer may be about to reference it, so look again later
+            auto lastModified = static_cast<std::chrono::system_clock::time_point>(contentProperties.LastModified);
+            if (std::chrono::system_clock::now() - lastModified < kContentGracePeriod) {
+                continue;
+            }
+            
+            // Every reference is in the block's own index; keep the blob if that cannot be read
+            try {
+                auto blockProperties = blobContainerClient_->GetBlobClient(blobName).GetProperties();
+                VersionIndex versions;
+                if (!ReadVersionIndex(blockProperties.Value.Metadata, versions) || versions.FindByContent(digest)) {
+                    metrics.IncrementCounter("dedup.content_kept");
+                    done[i] = true;
+                    continue;
+                }
+            } catch (const Azure::Storage::StorageException& ex) {
+                if (ex.StatusCode != Azure::Core::Http::HttpStatusCode::NotFound) {
                     throw;
                 }
             }
+            
+            // Only the copy checked above: a touch since then changes the ETag and fails this delete
+            Azure::Storage::Blobs::DeleteBlobOptions deleteOptions;
+            deleteOptions.AccessConditions.IfMatch = contentProperties.ETag;
+            contentClient.Delete(deleteOptions);
+            metrics.IncrementCounter("dedup.content_reclaimed");
+            done[i] = true;
         } catch (const Azure::Storage::StorageException& ex) {
-            Log(LogLevel::Error, "[KVStore V2 Write]   ✗ Azure StorageException: " + std::string(ex.what()), chunk.completionId);
-            assert(false && "Azure StorageException during WriteAsync");
+            done[i] = ex.StatusCode == Azure::Core::Http::HttpStatusCode::NotFound;
+            if (!done[i] && ex.StatusCode != Azure::Core::Http::HttpStatusCode::PreconditionFailed) {
+                Log(LogLevel::Verbose, "[KVStore V2 GC] Content blob " + blobNames[i] + " not reclaimed: " + std::string(ex.what()));
+            }
         }
-    });
+    }
+    return done;
 }
 
 // Explicit instantiation for TokenIterator = std::vector<Token>::const_iterator
@@ -875,7 +1807,8 @@ template LookupResult AzureStorageKVStoreLibV2::Lookup<std::vector<Token>::const
     const std::string&,
     std::vector<Token>::const_iterator,
     std::vector<Token>::const_iterator,
-    const std::vector<hash_t>&
+    const std::vector<hash_t>&,
+    ProbeStrategy
 ) const;
 
 
@@ -886,5 +1819,6 @@ template LookupResult AzureStorageKVStoreLibV2::Lookup<std::vector<int64_t>::ite
     const std::string&,
     std::vector<int64_t>::iterator,
     std::vector<int64_t>::iterator,
-    const std::vector<hash_t>&
+    const std::vector<hash_t>&,
+    ProbeStrategy
 ) const;
@@ -0,0 +1,499 @@
+#include "BlobNameCodec.h"
+#include <atomic>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define BLOBNAME_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define BLOBNAME_X86 0
+#endif
+
+// MSVC compiles intrinsics for any target; GCC/Clang need the ISA enabled per function
+#if BLOBNAME_X86 && !defined(_MSC_VER)
+#define BLOBNAME_TARGET_SSE41 __attribute__((target("ssse3,sse4.1")))
+#define BLOBNAME_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define BLOBNAME_TARGET_SSE41
+#define BLOBNAME_TARGET_AVX2
+#endif
+
+namespace blobname {
+namespace {
+
+const char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+struct DecodeTable {
+    int8_t values[256];
+    DecodeTable() {
+        for (auto& value : values) {
+            value = -1;
+        }
+        for (int i = 0; i < 64; ++i) {
+            values[static_cast<uint8_t>(kAlphabet[i])] = static_cast<int8_t>(i);
+        }
+    }
+};
+const DecodeTable kDecodeTable;
+
+// ---- Scalar kernels (also used for the tails of the vector kernels) ----
+
+void PackScalar(const Token* tokens, size_t count, uint8_t* out) {
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t token = static_cast<uint32_t>(tokens[i]);
+        out[i * 4] = static_cast<uint8_t>(token >> 24);
+        out[i * 4 + 1] = static_cast<uint8_t>(token >> 16);
+        out[i * 4 + 2] = static_cast<uint8_t>(token >> 8);
+        out[i * 4 + 3] = static_cast<uint8_t>(token);
+    }
+}
+
+void UnpackScalar(const uint8_t* bytes, size_t count, Token* out) {
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t token = (static_cast<uint32_t>(bytes[i * 4]) << 24) |
+                         (static_cast<uint32_t>(bytes[i * 4 + 1]) << 16) |
+                         (static_cast<uint32_t>(bytes[i * 4 + 2]) << 8) |
+                         static_cast<uint32_t>(bytes[i * 4 + 3]);
+        out[i] = static_cast<Token>(token);
+    }
+}
+
+size_t EncodeScalar(const uint8_t* bytes, size_t length, char* out) {
+    char* start = out;
+    size_t i = 0;
+    for (; i + 3 <= length; i += 3) {
+        uint32_t v = (static_cast<uint32_t>(bytes[i]) << 16) |
+                     (static_cast<uint32_t>(bytes[i + 1]) << 8) |
+                     static_cast<uint32_t>(bytes[i + 2]);
+        *out++ = kAlphabet[(v >> 18) & 0x3F];
+        *out++ = kAlphabet[(v >> 12) & 0x3F];
+        *out++ = kAlphabet[(v >> 6) & 0x3F];
+        *out++ = kAlphabet[v & 0x3F];
+    }
+
+    size_t remaining = length - i;
+    if (remaining == 1) {
+        uint32_t v = static_cast<uint32_t>(bytes[i]) << 16;
+        *out++ = kAlphabet[(v >> 18) & 0x3F];
+        *out++ = kAlphabet[(v >> 12) & 0x3F];
+    } else if (remaining == 2) {
+        uint32_t v = (static_cast<uint32_t>(bytes[i]) << 16) |
+                     (static_cast<uint32_t>(bytes[i + 1]) << 8);
+        *out++ = kAlphabet[(v >> 18) & 0x3F];
+        *out++ = kAlphabet[(v >> 12) & 0x3F];
+        *out++ = kAlphabet[(v >> 6) & 0x3F];
+    }
+    return static_cast<size_t>(out - start);
+}
+
+bool DecodeScalar(const char* text, size_t length, uint8_t* out, size_t* written) {
+    uint8_t* start = out;
+    uint32_t accumulator = 0;
+    int bits = 0;
+    for (size_t i = 0; i < length; ++i) {
+        int value = kDecodeTable.values[static_cast<uint8_t>(text[i])];
+        if (value < 0) {
+            return false;
+        }
+        accumulator = (accumulator << 6) | static_cast<uint32_t>(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            *out++ = static_cast<uint8_t>((accumulator >> bits) & 0xFF);
+        }
+    }
+    *written = static_cast<size_t>(out - start);
+    return true;
+}
+
+#if BLOBNAME_X86
+
+// ---- SSE4.1 kernels: 4 tokens, 12 -> 16 characters per step ----
+// Base64 arithmetic follows Wojciech Mula's SSSE3 encoder/decoder, with the url alphabet.
+
+BLOBNAME_TARGET_SSE41 inline __m128i EncodeLookup128(__m128i indices) {
+    // 0..25 -> 'A', 26..51 -> 'a', 52..61 -> '0', 62 -> '-', 63 -> '_'
+    __m128i offsetIndex = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    __m128i below26 = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    offsetIndex = _mm_or_si128(offsetIndex, _mm_and_si128(below26, _mm_set1_epi8(13)));
+    const __m128i shiftLut = _mm_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '-' - 62, '_' - 63, 'A', 0, 0);
+    return _mm_add_epi8(_mm_shuffle_epi8(shiftLut, offsetIndex), indices);
+}
+
+BLOBNAME_TARGET_SSE41 inline __m128i SplitSextets128(__m128i in) {
+    in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    __m128i hi = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+    __m128i lo = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+    return _mm_or_si128(hi, lo);
+}
+
+// 0xFF where lo <= c <= hi (signed, so bytes >= 0x80 never match)
+BLOBNAME_TARGET_SSE41 inline __m128i InRange128(__m128i c, char lo, char hi) {
+    return _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8(static_cast<char>(lo - 1))),
+                         _mm_cmpgt_epi8(_mm_set1_epi8(static_cast<char>(hi + 1)), c));
+}
+
+// Returns sextet values; valid is false if any byte is outside the alphabet
+BLOBNAME_TARGET_SSE41 inline __m128i DecodeLookup128(__m128i chars, bool& valid) {
+    __m128i upper = InRange128(chars, 'A', 'Z');
+    __m128i lower = InRange128(chars, 'a', 'z');
+    __m128i digit = InRange128(chars, '0', '9');
+    __m128i dash = _mm_cmpeq_epi8(chars, _mm_set1_epi8('-'));
+    __m128i underscore = _mm_cmpeq_epi8(chars, _mm_set1_epi8('_'));
+
+    __m128i offset = _mm_and_si128(upper, _mm_set1_epi8(-65));
+    offset = _mm_or_si128(offset, _mm_and_si128(lower, _mm_set1_epi8(-71)));
+    offset = _mm_or_si128(offset, _mm_and_si128(digit, _mm_set1_epi8(4)));
+    offset = _mm_or_si128(offset, _mm_and_si128(dash, _mm_set1_epi8(17)));
+    offset = _mm_or_si128(offset, _mm_and_si128(underscore, _mm_set1_epi8(-32)));
+
+    __m128i any = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, _mm_or_si128(dash, underscore)));
+    valid = _mm_movemask_epi8(any) == 0xFFFF;
+    return _mm_add_epi8(chars, offset);
+}
+
+// 16 sextets -> 12 bytes in the low 96 bits
+BLOBNAME_TARGET_SSE41 inline __m128i JoinSextets128(__m128i values) {
+    __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    __m128i triples = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+    return _mm_shuffle_epi8(triples, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+}
+
+BLOBNAME_TARGET_SSE41 void PackSse41(const Token* tokens, size_t count, uint8_t* out) {
+    // Low dword of each little-endian int64, byte-reversed
+    const __m128i lowHalf = _mm_setr_epi8(3, 2, 1, 0, 11, 10, 9, 8, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i highHalf = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 3, 2, 1, 0, 11, 10, 9, 8);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tokens + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tokens + i + 2));
+        __m128i packed = _mm_or_si128(_mm_shuffle_epi8(a, lowHalf), _mm_shuffle_epi8(b, highHalf));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 4), packed);
+    }
+    PackScalar(tokens + i, count - i, out + i * 4);
+}
+
+BLOBNAME_TARGET_SSE41 void UnpackSse41(const uint8_t* bytes, size_t count, Token* out) {
+    const __m128i byteSwap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i be = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i * 4));
+        __m128i dwords = _mm_shuffle_epi8(be, byteSwap);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_cvtepu32_epi64(dwords));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 2), _mm_cvtepu32_epi64(_mm_srli_si128(dwords, 8)));
+    }
+    UnpackScalar(bytes + i * 4, count - i, out + i);
+}
+
+BLOBNAME_TARGET_SSE41 size_t EncodeSse41(const uint8_t* bytes, size_t length, char* out) {
+    size_t i = 0;
+    size_t o = 0;
+    // Each step reads 16 bytes but consumes 12
+    for (; i + 16 <= length; i += 12, o += 16) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), EncodeLookup128(SplitSextets128(in)));
+    }
+    return o + EncodeScalar(bytes + i, length - i, out + o);
+}
+
+BLOBNAME_TARGET_SSE41 bool DecodeSse41(const char* text, size_t length, uint8_t* out, size_t* written) {
+    size_t i = 0;
+    size_t o = 0;
+    // Each step stores 16 bytes but produces 12; 24 characters left guarantees room for the store
+    for (; i + 24 <= length; i += 16, o += 12) {
+        bool valid = false;
+        __m128i values = DecodeLookup128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i)), valid);
+        if (!valid) {
+            return false;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), JoinSextets128(values));
+    }
+    size_t tail = 0;
+    if (!DecodeScalar(text + i, length - i, out + o, &tail)) {
+        return false;
+    }
+    *written = o + tail;
+    return true;
+}
+
+// ---- AVX2 kernels: 8 tokens, 24 -> 32 characters per step ----
+
+BLOBNAME_TARGET_AVX2 void PackAvx2(const Token* tokens, size_t count, uint8_t* out) {
+    const __m256i lowHalf = _mm256_setr_epi8(
+        3, 2, 1, 0, 11, 10, 9, 8, -1, -1, -1, -1, -1, -1, -1, -1,
+        3, 2, 1, 0, 11, 10, 9, 8, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m256i highHalf = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, 3, 2, 1, 0, 11, 10, 9, 8,
+        -1, -1, -1, -1, -1, -1, -1, -1, 3, 2, 1, 0, 11, 10, 9, 8);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tokens + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tokens + i + 4));
+        // Lanes hold tokens {0,1,4,5} and {2,3,6,7}; reorder the qwords to 0..7
+        __m256i packed = _mm256_or_si256(_mm256_shuffle_epi8(a, lowHalf), _mm256_shuffle_epi8(b, highHalf));
+        packed = _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 4), packed);
+    }
+    _mm256_zeroupper();   // Avoid AVX -> SSE transition stalls in the tail and the caller
+    PackSse41(tokens + i, count - i, out + i * 4);
+}
+
+BLOBNAME_TARGET_AVX2 void UnpackAvx2(const uint8_t* bytes, size_t count, Token* out) {
+    const __m256i byteSwap = _mm256_setr_epi8(
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i be = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i * 4));
+        __m256i dwords = _mm256_shuffle_epi8(be, byteSwap);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_cvtepu32_epi64(_mm256_castsi256_si128(dwords)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 4), _mm256_cvtepu32_epi64(_mm256_extracti128_si256(dwords, 1)));
+    }
+    _mm256_zeroupper();
+    UnpackSse41(bytes + i * 4, count - i, out + i);
+}
+
+BLOBNAME_TARGET_AVX2 size_t EncodeAvx2(const uint8_t* bytes, size_t length, char* out) {
+    size_t i = 0;
+    size_t o = 0;
+    // Each lane takes 12 of its 16 loaded bytes, so the upper lane loads from +12
+    for (; i + 28 <= length; i += 24, o += 32) {
+        __m256i in = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i + 12)), 1);
+        in = _mm256_shuffle_epi8(in, _mm256_setr_epi8(
+            1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+            1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+        __m256i hi = _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+        __m256i lo = _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+        __m256i indices = _mm256_or_si256(hi, lo);
+
+        __m256i offsetIndex = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        __m256i below26 = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+        offsetIndex = _mm256_or_si256(offsetIndex, _mm256_and_si256(below26, _mm256_set1_epi8(13)));
+        const __m256i shiftLut = _mm256_setr_epi8(
+            'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+            '0' - 52, '0' - 52, '0' - 52, '-' - 62, '_' - 63, 'A', 0, 0,
+            'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+            '0' - 52, '0' - 52, '0' - 52, '-' - 62, '_' - 63, 'A', 0, 0);
+        __m256i chars = _mm256_add_epi8(_mm256_shuffle_epi8(shiftLut, offsetIndex), indices);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + o), chars);
+    }
+    _mm256_zeroupper();
+    return o + EncodeSse41(bytes + i, length - i, out + o);
+}
+
+BLOBNAME_TARGET_AVX2 inline __m256i InRange256(__m256i c, char lo, char hi) {
+    return _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8(static_cast<char>(lo - 1))),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(hi + 1)), c));
+}
+
+BLOBNAME_TARGET_AVX2 bool DecodeAvx2(const char* text, size_t length, uint8_t* out, size_t* written) {
+    size_t i = 0;
+    size_t o = 0;
+    // Each step stores 32 bytes but produces 24; 44 characters left guarantees room for the store
+    for (; i + 44 <= length; i += 32, o += 24) {
+        __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+        __m256i upper = InRange256(chars, 'A', 'Z');
+        __m256i lower = InRange256(chars, 'a', 'z');
+        __m256i digit = InRange256(chars, '0', '9');
+        __m256i dash = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('-'));
+        __m256i underscore = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('_'));
+        __m256i any = _mm256_or_si256(_mm256_or_si256(upper, lower), _mm256_or_si256(digit, _mm256_or_si256(dash, underscore)));
+        if (_mm256_movemask_epi8(any) != -1) {
+            return false;
+        }
+
+        __m256i offset = _mm256_and_si256(upper, _mm256_set1_epi8(-65));
+        offset = _mm256_or_si256(offset, _mm256_and_si256(lower, _mm256_set1_epi8(-71)));
+        offset = _mm256_or_si256(offset, _mm256_and_si256(digit, _mm256_set1_epi8(4)));
+        offset = _mm256_or_si256(offset, _mm256_and_si256(dash, _mm256_set1_epi8(17)));
+        offset = _mm256_or_si256(offset, _mm256_and_si256(underscore, _mm256_set1_epi8(-32)));
+        __m256i values = _mm256_add_epi8(chars, offset);
+
+        __m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        __m256i triples = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+        __m256i packed = _mm256_shuffle_epi8(triples, _mm256_setr_epi8(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        // 12 bytes per lane -> 24 contiguous bytes
+        packed = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + o), packed);
+    }
+    _mm256_zeroupper();
+    size_t tail = 0;
+    if (!DecodeSse41(text + i, length - i, out + o, &tail)) {
+        return false;
+    }
+    *written = o + tail;
+    return true;
+}
+
+CodecIsa DetectIsa() {
+#if defined(_MSC_VER)
+    int info[4] = {};
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    __cpuid(info, 1);
+    bool sse41 = (info[2] & (1 << 19)) != 0 && (info[2] & (1 << 9)) != 0;
+    bool osAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 &&
+                 (_xgetbv(0) & 0x6) == 0x6;
+    bool avx2 = false;
+    if (osAvx && maxLeaf >= 7) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    bool sse41 = __builtin_cpu_supports("ssse3") && __builtin_cpu_supports("sse4.1");
+    bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+    if (avx2) {
+        return CodecIsa::Avx2;
+    }
+    return sse41 ? CodecIsa::Sse41 : CodecIsa::Scalar;
+}
+
+#else
+
+CodecIsa DetectIsa() {
+    return CodecIsa::Scalar;
+}
+
+#endif
+
+struct Kernels {
+    void (*pack)(const Token*, size_t, uint8_t*);
+    void (*unpack)(const uint8_t*, size_t, Token*);
+    size_t (*encode)(const uint8_t*, size_t, char*);
+    bool (*decode)(const char*, size_t, uint8_t*, size_t*);
+};
+
+const Kernels kScalarKernels = {PackScalar, UnpackScalar, EncodeScalar, DecodeScalar};
+#if BLOBNAME_X86
+const Kernels kSse41Kernels = {PackSse41, UnpackSse41, EncodeSse41, DecodeSse41};
+const Kernels kAvx2Kernels = {PackAvx2, UnpackAvx2, EncodeAvx2, DecodeAvx2};
+#endif
+
+const Kernels* KernelsFor(CodecIsa isa) {
+#if BLOBNAME_X86
+    switch (isa) {
+        case CodecIsa::Avx2: return &kAvx2Kernels;
+        case CodecIsa::Sse41: return &kSse41Kernels;
+        default: break;
+    }
+#endif
+    return &kScalarKernels;
+}
+
+std::atomic<int> g_activeIsa{-1};
+
+CodecIsa ActiveIsa() {
+    int isa = g_activeIsa.load(std::memory_order_relaxed);
+    if (isa < 0) {
+        isa = static_cast<int>(DetectCodecIsa());
+        g_activeIsa.store(isa, std::memory_order_relaxed);
+    }
+    return static_cast<CodecIsa>(isa);
+}
+
+const Kernels& Active() {
+    return *KernelsFor(ActiveIsa());
+}
+
+} // namespace
+
+CodecIsa DetectCodecIsa() {
+    static const CodecIsa detected = DetectIsa();
+    return detected;
+}
+
+CodecIsa ActiveCodecIsa() {
+    return ActiveIsa();
+}
+
+void ForceCodecIsa(CodecIsa isa) {
+    CodecIsa supported = DetectCodecIsa();
+    if (static_cast<int>(isa) > static_cast<int>(supported)) {
+        isa = supported;
+    }
+    g_activeIsa.store(static_cast<int>(isa), std::memory_order_relaxed);
+}
+
+const char* CodecIsaName(CodecIsa isa) {
+    switch (isa) {
+        case CodecIsa::Avx2: return "avx2";
+        case CodecIsa::Sse41: return "sse4.1";
+        default: return "scalar";
+    }
+}
+
+void PackTokens(const Token* tokens, size_t count, uint8_t* out) {
+    Active().pack(tokens, count, out);
+}
+
+void UnpackTokens(const uint8_t* bytes, size_t count, Token* out) {
+    Active().unpack(bytes, count, out);
+}
+
+size_t Base64UrlEncode(const uint8_t* bytes, size_t length, char* out) {
+    return Active().encode(bytes, length, out);
+}
+
+bool Base64UrlDecode(const char* text, size_t length, uint8_t* out, size_t* written) {
+    return Active().decode(text, length, out, written);
+}
+
+std::string EncodeTokensToBlobName(const Token* tokens, size_t count) {
+    const Kernels& kernels = Active();
+    uint8_t stackBytes[PackedLength(kMaxStackTokens)];
+    std::vector<uint8_t> heapBytes;
+    uint8_t* bytes = stackBytes;
+    if (count > kMaxStackTokens) {
+        heapBytes.resize(PackedLength(count));
+        bytes = heapBytes.data();
+    }
+    kernels.pack(tokens, count, bytes);
+
+    std::string name(EncodedLength(PackedLength(count)), '\0');
+    kernels.encode(bytes, PackedLength(count), &name[0]);
+    return name;
+}
+
+std::vector<Token> DecodeBlobNameToTokens(const std::string& blobName) {
+    size_t length = std::min(blobName.find('='), blobName.size());
+    std::vector<uint8_t> bytes(DecodedLength(length));
+    size_t written = 0;
+    if (!Base64UrlDecode(blobName.data(), length, bytes.data(), &written)) {
+        return {};
+    }
+    std::vector<Token> tokens(written / 4);
+    UnpackTokens(bytes.data(), tokens.size(), tokens.data());
+    return tokens;
+}
+
+std::string HashTokensToBlobName(const Token* tokens, size_t count) {
+    static const char kHex[] = "0123456789abcdef";
+    uint8_t stackBytes[PackedLength(kMaxStackTokens)];
+    std::vector<uint8_t> heapBytes;
+    uint8_t* bytes = stackBytes;
+    if (count > kMaxStackTokens) {
+        heapBytes.resize(PackedLength(count));
+        bytes = heapBytes.data();
+    }
+    PackTokens(tokens, count, bytes);
+    auto hash = Hash128(bytes, PackedLength(count));
+
+    std::string name(32, '0');
+    for (int i = 0; i < 16; ++i) {
+        name[15 - i] = kHex[(hash.first >> (4 * i)) & 0xF];
+        name[31 - i] = kHex[(hash.second >> (4 * i)) & 0xF];
+    }
+    return name;
+}
+
+} // namespace blobname
@@ -0,0 +1,101 @@
+#include "BlockMetadataCache.h"
+#include <functional>
+
+BlockMetadataCache::BlockMetadataCache(const BlockMetadataCacheOptions& options) {
+    Configure(options);
+}
+
+void BlockMetadataCache::Configure(const BlockMetadataCacheOptions& options) {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.lru.clear();
+        shard.index.clear();
+    }
+    maxEntriesPerShard_ = options.maxEntries == 0 ? 0 : (options.maxEntries + kShardCount - 1) / kShardCount;
+    ttl_ = options.ttl;
+}
+
+bool BlockMetadataCache::Get(const std::string& blobName, BlockMetadata& metadata) {
+    if (!Enabled()) {
+        return false;
+    }
+
+    Shard& shard = GetShard(blobName);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(blobName);
+    if (it == shard.index.end()) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (Clock::now() >= it->second->expiresAt) {
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    metadata = it->second->metadata;
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void BlockMetadataCache::Put(const std::string& blobName, BlockMetadata metadata) {
+    if (!Enabled()) {
+        return;
+    }
+
+    Shard& shard = GetShard(blobName);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto expiresAt = Clock::now() + ttl_;
+    auto it = shard.index.find(blobName);
+    if (it != shard.index.end()) {
+        it->second->metadata = std::move(metadata);
+        it->second->expiresAt = expiresAt;
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return;
+    }
+
+    shard.lru.push_front(Entry{blobName, std::move(metadata), expiresAt});
+    shard.index[blobName] = shard.lru.begin();
+
+    while (shard.lru.size() > maxEntriesPerShard_) {
+        shard.index.erase(shard.lru.back().blobName);
+        shard.lru.pop_back();
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void BlockMetadataCache::Invalidate(const std::string& blobName) {
+    if (!Enabled()) {
+        return;
+    }
+
+    Shard& shard = GetShard(blobName);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(blobName);
+    if (it != shard.index.end()) {
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+    }
+}
+
+BlockMetadataCacheStats BlockMetadataCache::GetStats() const {
+    BlockMetadataCacheStats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.entries += shard.lru.size();
+    }
+    return stats;
+}
+
+BlockMetadataCache::Shard& BlockMetadataCache::GetShard(const std::string& blobName) {
+    return shards_[std::hash<std::string>{}(blobName) % kShardCount];
+}
@@ -0,0 +1,173 @@
+#include "BloomFilter.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    constexpr char kSnapshotMagic[4] = {'K', 'V', 'B', 'F'};
+    constexpr uint32_t kSnapshotVersion = 1;
+    constexpr uint32_t kFlagComplete = 1;
+
+    // Odd multipliers from the split-block Bloom filter design (one per word of a block)
+    constexpr uint32_t kSalts[BloomFilter::kWordsPerBlock] = {
+        0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+        0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+    };
+
+    template<typename T>
+    void Append(std::vector<uint8_t>& out, T value) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    template<typename T>
+    bool Extract(const std::vector<uint8_t>& data, size_t& offset, T& value) {
+        if (offset + sizeof(T) > data.size()) {
+            return false;
+        }
+        std::memcpy(&value, data.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+}
+
+BloomFilter::BloomFilter(const BloomFilterOptions& options)
+    : BloomFilter(std::max<size_t>(options.shardCount, 1),
+                  std::max<size_t>((options.expectedBlobs * options.bitsPerBlob / (kWordsPerBlock * 64) +
+                                    std::max<size_t>(options.shardCount, 1) - 1) / std::max<size_t>(options.shardCount, 1), 1)) {
+}
+
+BloomFilter::BloomFilter(size_t shardCount, size_t blocksPerShard)
+    : shardCount_(shardCount),
+      blocksPerShard_(blocksPerShard),
+      wordsPerShard_(blocksPerShard * kWordsPerBlock) {
+    shards_.reserve(shardCount_);
+    for (size_t i = 0; i < shardCount_; ++i) {
+        shards_.emplace_back(blocksPerShard_);
+        for (auto& block : shards_.back()) {
+            for (auto& word : block.words) {
+                word.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+// FNV-1a followed by a 64-bit finalizer - stable across builds and platforms, unlike std::hash
+uint64_t BloomFilter::HashName(const std::string& blobName) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : blobName) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+BloomFilter::Block& BloomFilter::LocateBlock(uint64_t hash) const {
+    // Low 32 bits pick the bits within the block; shard and block come from the rest
+    size_t shard = static_cast<size_t>(((hash * 0x9e3779b97f4a7c15ULL) >> 32) % shardCount_);
+    size_t block = static_cast<size_t>(((hash >> 32) * static_cast<uint64_t>(blocksPerShard_)) >> 32);
+    return shards_[shard][std::min(block, blocksPerShard_ - 1)];
+}
+
+void BloomFilter::Add(const std::string& blobName) {
+    uint64_t hash = HashName(blobName);
+    Block& block = LocateBlock(hash);
+    uint32_t blockHash = static_cast<uint32_t>(hash);
+    for (size_t i = 0; i < kWordsPerBlock; ++i) {
+        uint64_t bit = 1ULL << ((blockHash * kSalts[i]) >> 26);
+        if ((block.words[i].load(std::memory_order_relaxed) & bit) == 0) {
+            block.words[i].fetch_or(bit, std::memory_order_relaxed);
+        }
+    }
+}
+
+bool BloomFilter::MightContain(const std::string& blobName) const {
+    uint64_t hash = HashName(blobName);
+    const Block& block = LocateBlock(hash);
+    uint32_t blockHash = static_cast<uint32_t>(hash);
+    for (size_t i = 0; i < kWordsPerBlock; ++i) {
+        uint64_t bit = 1ULL << ((blockHash * kSalts[i]) >> 26);
+        if ((block.words[i].load(std::memory_order_relaxed) & bit) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BloomFilter::SameGeometry(const BloomFilter& other) const {
+    return shardCount_ == other.shardCount_ && blocksPerShard_ == other.blocksPerShard_;
+}
+
+bool BloomFilter::Merge(const BloomFilter& other) {
+    if (!SameGeometry(other)) {
+        return false;
+    }
+    for (size_t s = 0; s < shardCount_; ++s) {
+        for (size_t b = 0; b < blocksPerShard_; ++b) {
+            for (size_t i = 0; i < kWordsPerBlock; ++i) {
+                uint64_t bits = other.shards_[s][b].words[i].load(std::memory_order_relaxed);
+                if (bits != 0) {
+                    shards_[s][b].words[i].fetch_or(bits, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+    if (other.IsComplete()) {
+        SetComplete(true);
+    }
+    return true;
+}
+
+std::vector<uint8_t> BloomFilter::Serialize() const {
+    std::vector<uint8_t> out;
+    out.reserve(32 + SizeBytes());
+    out.insert(out.end(), kSnapshotMagic, kSnapshotMagic + sizeof(kSnapshotMagic));
+    Append<uint32_t>(out, kSnapshotVersion);
+    Append<uint32_t>(out, IsComplete() ? kFlagComplete : 0);
+    Append<uint32_t>(out, static_cast<uint32_t>(shardCount_));
+    Append<uint64_t>(out, static_cast<uint64_t>(wordsPerShard_));
+    for (const auto& shard : shards_) {
+        for (const auto& block : shard) {
+            for (const auto& word : block.words) {
+                Append<uint64_t>(out, word.load(std::memory_order_relaxed));
+            }
+        }
+    }
+    return out;
+}
+
+std::unique_ptr<BloomFilter> BloomFilter::Deserialize(const std::vector<uint8_t>& data) {
+    if (data.size() < sizeof(kSnapshotMagic) || std::memcmp(data.data(), kSnapshotMagic, sizeof(kSnapshotMagic)) != 0) {
+        return nullptr;
+    }
+
+    size_t offset = sizeof(kSnapshotMagic);
+    uint32_t version = 0, flags = 0, shardCount = 0;
+    uint64_t wordsPerShard = 0;
+    if (!Extract(data, offset, version) || version != kSnapshotVersion ||
+        !Extract(data, offset, flags) || !Extract(data, offset, shardCount) ||
+        !Extract(data, offset, wordsPerShard)) {
+        return nullptr;
+    }
+    if (shardCount == 0 || wordsPerShard == 0 || wordsPerShard % kWordsPerBlock != 0 ||
+        data.size() - offset != static_cast<uint64_t>(shardCount) * wordsPerShard * sizeof(uint64_t)) {
+        return nullptr;
+    }
+
+    std::unique_ptr<BloomFilter> filter(new BloomFilter(shardCount, static_cast<size_t>(wordsPerShard / kWordsPerBlock)));
+    for (auto& shard : filter->shards_) {
+        for (auto& block : shard) {
+            for (auto& word : block.words) {
+                uint64_t value = 0;
+                Extract(data, offset, value);
+                word.store(value, std::memory_order_relaxed);
+            }
+        }
+    }
+    filter->SetComplete((flags & kFlagComplete) != 0);
+    return filter;
+}
@@ -0,0 +1,251 @@
+#include "ContentHash.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define CONTENTHASH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#else
+#define CONTENTHASH_X86 0
+#endif
+
+// MSVC compiles intrinsics for any target; GCC/Clang need the ISA enabled per function
+#if CONTENTHASH_X86 && !defined(_MSC_VER)
+#define CONTENTHASH_TARGET_SHA __attribute__((target("sha,ssse3,sse4.1")))
+#else
+#define CONTENTHASH_TARGET_SHA
+#endif
+
+namespace {
+
+alignas(16) const uint32_t kRoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+inline uint32_t Rotr(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+void CompressScalar(uint32_t state[8], const uint8_t* data, size_t blocks) {
+    uint32_t w[64];
+    for (; blocks > 0; --blocks, data += 64) {
+        for (int i = 0; i < 16; ++i) {
+            w[i] = (static_cast<uint32_t>(data[i * 4]) << 24) | (static_cast<uint32_t>(data[i * 4 + 1]) << 16) |
+                   (static_cast<uint32_t>(data[i * 4 + 2]) << 8) | static_cast<uint32_t>(data[i * 4 + 3]);
+        }
+        for (int i = 16; i < 64; ++i) {
+            uint32_t s0 = Rotr(w[i - 15], 7) ^ Rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = Rotr(w[i - 2], 17) ^ Rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i) {
+            uint32_t t1 = h + (Rotr(e, 6) ^ Rotr(e, 11) ^ Rotr(e, 25)) + ((e & f) ^ (~e & g)) + kRoundConstants[i] + w[i];
+            uint32_t t2 = (Rotr(a, 2) ^ Rotr(a, 13) ^ Rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+}
+
+#if CONTENTHASH_X86
+
+// The SHA-NI round instructions keep the state as ABEF/CDGH halves; each loop iteration is
+// four rounds, extending the message schedule with sha256msg1/msg2 from the fifth on
+CONTENTHASH_TARGET_SHA
+void CompressShaNi(uint32_t state[8], const uint8_t* data, size_t blocks) {
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i dcba = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0]));
+    __m128i hgfe = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4]));
+    __m128i cdab = _mm_shuffle_epi32(dcba, 0xB1);
+    __m128i efgh = _mm_shuffle_epi32(hgfe, 0x1B);
+    __m128i abef = _mm_alignr_epi8(cdab, efgh, 8);
+    __m128i cdgh = _mm_blend_epi16(efgh, cdab, 0xF0);
+
+    for (; blocks > 0; --blocks, data += 64) {
+        __m128i abefSaved = abef;
+        __m128i cdghSaved = cdgh;
+        __m128i msg[4];
+        for (int i = 0; i < 16; ++i) {
+            __m128i& current = msg[i & 3];
+            if (i < 4) {
+                current = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 16)), byteSwap);
+            } else {
+                __m128i partial = _mm_add_epi32(_mm_sha256msg1_epu32(current, msg[(i - 3) & 3]),
+                                                _mm_alignr_epi8(msg[(i - 1) & 3], msg[(i - 2) & 3], 4));
+                current = _mm_sha256msg2_epu32(partial, msg[(i - 1) & 3]);
+            }
+            __m128i scheduled = _mm_add_epi32(current, _mm_load_si128(reinterpret_cast<const __m128i*>(&kRoundConstants[i * 4])));
+            cdgh = _mm_sha256rnds2_epu32(cdgh, abef, scheduled);
+            abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(scheduled, 0x0E));
+        }
+        abef = _mm_add_epi32(abef, abefSaved);
+        cdgh = _mm_add_epi32(cdgh, cdghSaved);
+    }
+
+    __m128i feba = _mm_shuffle_epi32(abef, 0x1B);
+    __m128i dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), _mm_blend_epi16(feba, dchg, 0xF0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), _mm_alignr_epi8(dchg, feba, 8));
+}
+
+bool DetectShaNi() {
+#if defined(_MSC_VER)
+    int info[4] = {};
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool sse41 = (info[2] & (1 << 19)) != 0 && (info[2] & (1 << 9)) != 0;
+    __cpuidex(info, 7, 0);
+    return sse41 && (info[1] & (1 << 29)) != 0;
+#else
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    bool sse41 = (ecx & (1u << 19)) != 0 && (ecx & (1u << 9)) != 0;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    return sse41 && (ebx & (1u << 29)) != 0;
+#endif
+}
+
+#else
+
+bool DetectShaNi() {
+    return false;
+}
+
+#endif
+
+using CompressFn = void (*)(uint32_t state[8], const uint8_t* data, size_t blocks);
+
+// Resolved once; both kernels produce identical digests
+CompressFn ActiveCompress() {
+#if CONTENTHASH_X86
+    static const CompressFn compress = DetectShaNi() ? CompressShaNi : CompressScalar;
+#else
+    static const CompressFn compress = CompressScalar;
+#endif
+    return compress;
+}
+
+} // namespace
+
+std::string ContentDigest::Hex() const {
+    static const char kDigits[] = "0123456789abcdef";
+    std::string hex(bytes.size() * 2, '0');
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        hex[i * 2] = kDigits[bytes[i] >> 4];
+        hex[i * 2 + 1] = kDigits[bytes[i] & 0xF];
+    }
+    return hex;
+}
+
+bool ContentDigest::ParseHex(const std::string& hex, ContentDigest& digest) {
+    if (hex.size() != digest.bytes.size() * 2) {
+        return false;
+    }
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+    for (size_t i = 0; i < digest.bytes.size(); ++i) {
+        int high = nibble(hex[i * 2]);
+        int low = nibble(hex[i * 2 + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        digest.bytes[i] = static_cast<uint8_t>((high << 4) | low);
+    }
+    return true;
+}
+
+Sha256::Sha256()
+    : state_{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19} {
+}
+
+void Sha256::Update(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    length_ += size;
+    CompressFn compress = ActiveCompress();
+
+    if (buffered_ > 0) {
+        size_t take = std::min(size, sizeof(buffer_) - buffered_);
+        std::memcpy(buffer_ + buffered_, bytes, take);
+        buffered_ += take;
+        bytes += take;
+        size -= take;
+        if (buffered_ < sizeof(buffer_)) {
+            return;
+        }
+        compress(state_, buffer_, 1);
+        buffered_ = 0;
+    }
+
+    size_t blocks = size / 64;
+    if (blocks > 0) {
+        compress(state_, bytes, blocks);
+        bytes += blocks * 64;
+        size -= blocks * 64;
+    }
+    if (size > 0) {
+        std::memcpy(buffer_, bytes, size);
+        buffered_ = size;
+    }
+}
+
+ContentDigest Sha256::Finish() {
+    uint64_t bitLength = length_ * 8;
+    uint8_t padding[72] = {0x80};
+    size_t padLength = (buffered_ < 56 ? 56 : 120) - buffered_;
+    for (int i = 0; i < 8; ++i) {
+        padding[padLength + i] = static_cast<uint8_t>(bitLength >> (56 - i * 8));
+    }
+    Update(padding, padLength + 8);
+
+    ContentDigest digest;
+    for (size_t i = 0; i < 8; ++i) {
+        digest.bytes[i * 4] = static_cast<uint8_t>(state_[i] >> 24);
+        digest.bytes[i * 4 + 1] = static_cast<uint8_t>(state_[i] >> 16);
+        digest.bytes[i * 4 + 2] = static_cast<uint8_t>(state_[i] >> 8);
+        digest.bytes[i * 4 + 3] = static_cast<uint8_t>(state_[i]);
+    }
+    return digest;
+}
+
+ContentDigest Sha256::Of(const void* data, size_t size) {
+    Sha256 hash;
+    hash.Update(data, size);
+    return hash.Finish();
+}
+
+bool Sha256::HardwareAccelerated() {
+#if CONTENTHASH_X86
+    return ActiveCompress() == CompressShaNi;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,271 @@
+#include "DiskChunkCache.h"
+#include "MetricsHelper.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <system_error>
+
+namespace {
+    constexpr char kCacheMagic[4] = {'K', 'V', 'D', '2'};   // Files from older formats are dropped at Initialize
+
+    // Cache files never leave this machine, so values use host byte order
+    void WriteU64(std::ostream& out, uint64_t value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void WriteString(std::ostream& out, const std::string& value) {
+        WriteU64(out, value.size());
+        out.write(value.data(), static_cast<std::streamsize>(value.size()));
+    }
+
+    bool ReadU64(std::istream& in, uint64_t& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+
+    bool ReadString(std::istream& in, std::string& value) {
+        uint64_t size = 0;
+        if (!ReadU64(in, size) || size > (1u << 20)) {
+            return false;
+        }
+        value.resize(static_cast<size_t>(size));
+        return size == 0 || static_cast<bool>(in.read(&value[0], static_cast<std::streamsize>(size)));
+    }
+
+    // Header up to (not including) the payload; the key is stored so collisions are detected on read
+    bool ReadHeader(std::istream& in, std::string& key, PromptChunk& chunk, uint64_t& payloadSize) {
+        char magic[4] = {};
+        uint64_t codec = 0, shuffle = 0;
+        if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kCacheMagic, sizeof(magic)) != 0 ||
+            !ReadString(in, key) || !ReadU64(in, chunk.hash) || !ReadU64(in, chunk.parentHash) ||
+            !ReadString(in, chunk.partitionKey) || !ReadU64(in, codec) || !ReadU64(in, shuffle) ||
+            !ReadU64(in, chunk.encoding.rawSize) || !ReadU64(in, payloadSize) ||
+            codec > 255 || shuffle > payload::kMaxShuffle) {
+            return false;
+        }
+        chunk.encoding.codec = static_cast<payload::Codec>(codec);
+        chunk.encoding.shuffle = static_cast<uint8_t>(shuffle);
+        return true;
+    }
+
+    std::string HashFileName(const std::string& key) {
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : key) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        std::stringstream ss;
+        ss << std::hex << std::setfill('0') << std::setw(16) << hash;
+        return ss.str();
+    }
+}
+
+bool DiskChunkCache::Initialize(const DiskChunkCacheOptions& options) {
+    options_ = options;
+    root_ = options.path;
+
+    std::error_code ec;
+    std::filesystem::create_directories(root_, ec);
+    if (ec) {
+        if (logCallback_) {
+            logCallback_(LogLevel::Error, "[Chunk Cache] Failed to create " + root_.string() + ": " + ec.message());
+        }
+        return false;
+    }
+
+    // Rebuild the index oldest-first so the newest files end up most recently used
+    struct Found {
+        std::filesystem::file_time_type writeTime;
+        std::string key;
+        std::filesystem::path path;
+        uint64_t bytes;
+    };
+    std::vector<Found> found;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(root_, ec)) {
+        const auto& path = entry.path();
+        if (!entry.is_regular_file(ec)) {
+            continue;
+        }
+        if (path.filename().string().find(".tmp") != std::string::npos) {
+            std::filesystem::remove(path, ec);
+            continue;
+        }
+        if (path.extension() != ".chunk") {
+            continue;
+        }
+
+        std::ifstream in(path, std::ios::binary);
+        std::string key;
+        PromptChunk header;
+        uint64_t payloadSize = 0;
+        uint64_t fileSize = entry.file_size(ec);
+        if (!ReadHeader(in, key, header, payloadSize) || static_cast<uint64_t>(in.tellg()) + payloadSize != fileSize) {
+            in.close();
+            std::filesystem::remove(path, ec);
+            continue;
+        }
+        found.push_back(Found{entry.last_write_time(ec), std::move(key), path, fileSize});
+    }
+    std::sort(found.begin(), found.end(), [](const Found& a, const Found& b) { return a.writeTime < b.writeTime; });
+
+    std::vector<std::filesystem::path> evicted;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& file : found) {
+            Insert(file.key, file.path, file.bytes);
+        }
+        evicted = EvictToBudget();
+    }
+    for (const auto& path : evicted) {
+        std::filesystem::remove(path, ec);
+    }
+
+    if (logCallback_) {
+        auto stats = GetStats();
+        logCallback_(LogLevel::Information, "[Chunk Cache] Initialized at " + root_.string() + " (" +
+            std::to_string(stats.entries) + " chunks, " + std::to_string(stats.bytes >> 20) + "/" +
+            std::to_string(options_.maxBytes >> 20) + " MB)");
+    }
+    return true;
+}
+
+bool DiskChunkCache::Get(const std::string& key, PromptChunk& chunk) {
+    std::filesystem::path path;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            kvstore::MetricsHelper::GetInstance().IncrementCounter("chunk_cache.disk.misses");
+            return false;
+        }
+        lru_.splice(lru_.begin(), lru_, it->second.lruIt);
+        path = it->second.path;
+    }
+
+    // Read outside the lock; eviction may remove the file meanwhile, which reads as a miss
+    std::ifstream in(path, std::ios::binary);
+    std::string storedKey;
+    uint64_t payloadSize = 0;
+    bool ok = in && ReadHeader(in, storedKey, chunk, payloadSize) && storedKey == key;
+    if (ok) {
+        chunk.buffer.resize(static_cast<size_t>(payloadSize));
+        ok = payloadSize == 0 || static_cast<bool>(in.read(&chunk.buffer[0], static_cast<std::streamsize>(payloadSize)));
+    }
+    if (!ok) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Erase(key);
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        kvstore::MetricsHelper::GetInstance().IncrementCounter("chunk_cache.disk.misses");
+        return false;
+    }
+
+    chunk.bufferSize = chunk.buffer.size();
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    kvstore::MetricsHelper::GetInstance().IncrementCounter("chunk_cache.disk.hits");
+    return true;
+}
+
+void DiskChunkCache::Put(const std::string& key, const PromptChunk& chunk) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (options_.maxBytes == 0 || index_.count(key) > 0) {
+            return;
+        }
+    }
+
+    std::filesystem::path target = PathForKey(key);
+    static std::atomic<uint64_t> tempCounter{0};
+    std::filesystem::path temp = target.string() + ".tmp" + std::to_string(tempCounter.fetch_add(1));
+
+    std::error_code ec;
+    std::filesystem::create_directories(target.parent_path(), ec);
+    uint64_t bytes = 0;
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return;
+        }
+        out.write(kCacheMagic, sizeof(kCacheMagic));
+        WriteString(out, key);
+        WriteU64(out, chunk.hash);
+        WriteU64(out, chunk.parentHash);
+        WriteString(out, chunk.partitionKey);
+        WriteU64(out, static_cast<uint64_t>(chunk.encoding.codec));
+        WriteU64(out, chunk.encoding.shuffle);
+        WriteU64(out, chunk.encoding.rawSize);
+        WriteU64(out, chunk.buffer.size());
+        out.write(chunk.buffer.data(), static_cast<std::streamsize>(chunk.buffer.size()));
+        out.flush();
+        bytes = static_cast<uint64_t>(out.tellp());
+        if (!out) {
+            out.close();
+            std::filesystem::remove(temp, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(temp, target, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return;
+    }
+
+    std::vector<std::filesystem::path> evicted;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (index_.count(key) == 0) {
+            Insert(key, target, bytes);
+        }
+        evicted = EvictToBudget();
+    }
+    for (const auto& path : evicted) {
+        std::filesystem::remove(path, ec);
+    }
+}
+
+DiskChunkCacheStats DiskChunkCache::GetStats() const {
+    DiskChunkCacheStats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.bytes = bytes_;
+    stats.entries = index_.size();
+    return stats;
+}
+
+std::filesystem::path DiskChunkCache::PathForKey(const std::string& key) const {
+    std::string name = HashFileName(key);
+    return root_ / name.substr(0, 2) / (name + ".chunk");
+}
+
+void DiskChunkCache::Insert(const std::string& key, const std::filesystem::path& path, uint64_t bytes) {
+    lru_.push_front(key);
+    index_[key] = Entry{path, bytes, lru_.begin()};
+    bytes_ += bytes;
+    kvstore::MetricsHelper::GetInstance().SetGauge("chunk_cache.disk.bytes", static_cast<int64_t>(bytes_));
+}
+
+void DiskChunkCache::Erase(const std::string& key) {
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        return;
+    }
+    bytes_ -= it->second.bytes;
+    lru_.erase(it->second.lruIt);
+    index_.erase(it);
+    kvstore::MetricsHelper::GetInstance().SetGauge("chunk_cache.disk.bytes", static_cast<int64_t>(bytes_));
+}
+
+std::vector<std::filesystem::path> DiskChunkCache::EvictToBudget() {
+    std::vector<std::filesystem::path> evicted;
+    while (bytes_ > options_.maxBytes && !lru_.empty()) {
+        std::string key = lru_.back();
+        evicted.push_back(index_[key].path);
+        Erase(key);
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+        kvstore::MetricsHelper::GetInstance().IncrementCounter("chunk_cache.disk.evictions");
+    }
+    return evicted;
+}
@@ -0,0 +1,211 @@
+#include "HotChunkCache.h"
+#include "MetricsHelper.h"
+#include <algorithm>
+#include <functional>
+
+namespace {
+    // Sizing hint for the sketch - chunks are ~1.2MB, but smaller ones are common in tests
+    constexpr uint64_t kTypicalChunkBytes = 256 * 1024;
+
+    uint64_t Mix(uint64_t value) {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdULL;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ULL;
+        value ^= value >> 33;
+        return value;
+    }
+}
+
+HotChunkCache::FrequencySketch::FrequencySketch(size_t expectedEntries) {
+    size_t width = 1024;
+    while (width < expectedEntries) {
+        width <<= 1;
+    }
+    counters_.assign(width * kDepth, 0);
+    widthMask_ = width - 1;
+    sampleLimit_ = width * 10;
+}
+
+size_t HotChunkCache::FrequencySketch::Index(uint64_t hash, size_t row) const {
+    return row * (widthMask_ + 1) + static_cast<size_t>(Mix(hash + row * 0x9e3779b97f4a7c15ULL) & widthMask_);
+}
+
+void HotChunkCache::FrequencySketch::Increment(uint64_t hash) {
+    for (size_t row = 0; row < kDepth; ++row) {
+        uint8_t& counter = counters_[Index(hash, row)];
+        if (counter < kMaxCount) {
+            counter++;
+        }
+    }
+
+    // Aging: halve every counter once enough samples have been seen
+    if (++samples_ >= sampleLimit_) {
+        for (auto& counter : counters_) {
+            counter >>= 1;
+        }
+        samples_ /= 2;
+    }
+}
+
+uint8_t HotChunkCache::FrequencySketch::Estimate(uint64_t hash) const {
+    uint8_t estimate = kMaxCount;
+    for (size_t row = 0; row < kDepth; ++row) {
+        estimate = std::min(estimate, counters_[Index(hash, row)]);
+    }
+    return estimate;
+}
+
+HotChunkCache::HotChunkCache(const HotChunkCacheOptions& options)
+    : windowCapacity_(static_cast<uint64_t>(options.maxBytes * std::clamp(options.windowFraction, 0.0, 1.0))),
+      mainCapacity_(options.maxBytes - windowCapacity_),
+      protectedCapacity_(mainCapacity_ / 5 * 4),
+      sketch_(static_cast<size_t>(options.maxBytes / kTypicalChunkBytes)) {
+}
+
+std::shared_ptr<const PromptChunk> HotChunkCache::Get(const std::string& key) {
+    uint64_t hash = HashKey(key);
+    std::shared_ptr<const PromptChunk> chunk;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sketch_.Increment(hash);
+
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            Entry& entry = it->second;
+            chunk = entry.chunk;
+            switch (entry.segment) {
+            case Segment::Window:
+            case Segment::Protected: {
+                Region& region = RegionFor(entry.segment);
+                region.lru.splice(region.lru.begin(), region.lru, entry.lruIt);
+                break;
+            }
+            case Segment::Probation:
+                // A second hit promotes; protected overflow is demoted back to probation
+                MoveTo(entry, Segment::Protected);
+                while (protected_.bytes > protectedCapacity_ && protected_.lru.size() > 1) {
+                    std::string demoted = protected_.lru.back();
+                    MoveTo(index_[demoted], Segment::Probation);
+                }
+                break;
+            }
+        }
+    }
+
+    auto& metrics = kvstore::MetricsHelper::GetInstance();
+    if (chunk) {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        metrics.IncrementCounter("chunk_cache.memory.hits");
+    } else {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        metrics.IncrementCounter("chunk_cache.memory.misses");
+    }
+    return chunk;
+}
+
+void HotChunkCache::Put(const std::string& key, std::shared_ptr<const PromptChunk> chunk) {
+    uint64_t bytes = chunk->buffer.size() + chunk->partitionKey.size() + key.size();
+    if (bytes > mainCapacity_) {
+        return;
+    }
+
+    uint64_t evictionsBefore = evictions_.load(std::memory_order_relaxed);
+    uint64_t rejectionsBefore = rejections_.load(std::memory_order_relaxed);
+    uint64_t totalBytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (index_.count(key) > 0) {
+            return;  // Chunks are immutable - nothing to update
+        }
+
+        window_.lru.push_front(key);
+        window_.bytes += bytes;
+        index_[key] = Entry{std::move(chunk), bytes, Segment::Window, window_.lru.begin()};
+
+        while (window_.bytes > windowCapacity_ && !window_.lru.empty()) {
+            Admit(window_.lru.back());
+        }
+        totalBytes = window_.bytes + probation_.bytes + protected_.bytes;
+    }
+
+    auto& metrics = kvstore::MetricsHelper::GetInstance();
+    metrics.SetGauge("chunk_cache.memory.bytes", static_cast<int64_t>(totalBytes));
+    if (uint64_t evicted = evictions_.load(std::memory_order_relaxed) - evictionsBefore) {
+        metrics.IncrementCounter("chunk_cache.memory.evictions", evicted);
+    }
+    if (uint64_t rejected = rejections_.load(std::memory_order_relaxed) - rejectionsBefore) {
+        metrics.IncrementCounter("chunk_cache.memory.rejections", rejected);
+    }
+}
+
+void HotChunkCache::Admit(const std::string& candidateKey) {
+    std::string key = candidateKey;   // The reference points into a list we are about to modify
+    Entry& candidate = index_[key];
+    uint8_t candidateFrequency = sketch_.Estimate(HashKey(key));
+
+    // Evict probation (then protected) victims the candidate out-scores until it fits;
+    // ties favour the incumbent so a scan cannot displace established entries
+    while (probation_.bytes + protected_.bytes + candidate.bytes > mainCapacity_ &&
+           !(probation_.lru.empty() && protected_.lru.empty())) {
+        Region& victims = !probation_.lru.empty() ? probation_ : protected_;
+        const std::string& victimKey = victims.lru.back();
+        if (sketch_.Estimate(HashKey(victimKey)) >= candidateFrequency) {
+            Remove(key);
+            rejections_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        Remove(std::string(victimKey));
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    MoveTo(candidate, Segment::Probation);
+}
+
+HotChunkCacheStats HotChunkCache::GetStats() const {
+    HotChunkCacheStats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    stats.rejections = rejections_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.bytes = window_.bytes + probation_.bytes + protected_.bytes;
+    stats.entries = index_.size();
+    return stats;
+}
+
+uint64_t HotChunkCache::HashKey(const std::string& key) {
+    return std::hash<std::string>{}(key);
+}
+
+HotChunkCache::Region& HotChunkCache::RegionFor(Segment segment) {
+    switch (segment) {
+    case Segment::Window:
+        return window_;
+    case Segment::Probation:
+        return probation_;
+    case Segment::Protected:
+    default:
+        return protected_;
+    }
+}
+
+void HotChunkCache::MoveTo(Entry& entry, Segment segment) {
+    Region& from = RegionFor(entry.segment);
+    Region& to = RegionFor(segment);
+    to.lru.splice(to.lru.begin(), from.lru, entry.lruIt);
+    from.bytes -= entry.bytes;
+    to.bytes += entry.bytes;
+    entry.segment = segment;
+}
+
+void HotChunkCache::Remove(const std::string& key) {
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        return;
+    }
+    Region& region = RegionFor(it->second.segment);
+    region.bytes -= it->second.bytes;
+    region.lru.erase(it->second.lruIt);
+    index_.erase(it);
+}
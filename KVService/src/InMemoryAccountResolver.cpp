@@ -1,4 +1,7 @@
 #include "InMemoryAccountResolver.h"
+#include "InMemoryKVStoreEngine.h"
+#include "LocalDiskKVStoreEngine.h"
+#include <filesystem>
 #include <sstream>
 #include <iostream>
 
@@ -47,7 +50,7 @@ AccountInfo InMemoryAccountResolver::ResolveAccountInfo(
     return info;
 }
 
-std::shared_ptr<AzureStorageKVStoreLibV2> InMemoryAccountResolver::ResolveStore(
+std::shared_ptr<IKVStoreEngine> InMemoryAccountResolver::ResolveStore(
     const std::string& resourceName,
     const std::string& containerName) {
     
@@ -82,7 +85,7 @@ std::shared_ptr<AzureStorageKVStoreLibV2> InMemoryAccountResolver::ResolveStore(
     std::string accountUrl = BuildAccountUrl(resourceName);
     
     // Create new store instance
-    auto store = CreateStore(accountUrl, containerName);
+    auto store = CreateStore(resourceName, accountUrl, containerName);
     if (!store) {
         return nullptr;
     }
@@ -97,10 +100,36 @@ std::shared_ptr<AzureStorageKVStoreLibV2> InMemoryAccountResolver::ResolveStore(
     return store;
 }
 
-std::shared_ptr<AzureStorageKVStoreLibV2> InMemoryAccountResolver::CreateStore(
+std::shared_ptr<IKVStoreEngine> InMemoryAccountResolver::CreateStore(
+    const std::string& resourceName,
     const std::string& accountUrl,
     const std::string& containerName) {
     
+    if (config_.storageEngine == StorageEngineType::InMemory) {
+        auto store = std::make_shared<InMemoryKVStoreEngine>();
+        if (logCallback_) {
+            store->SetLogCallback(logCallback_);
+        }
+        store->SetLogLevel(config_.logLevel);
+        return store;
+    }
+    
+    if (config_.storageEngine == StorageEngineType::LocalDisk) {
+        auto store = std::make_shared<LocalDiskKVStoreEngine>();
+        if (logCallback_) {
+            store->SetLogCallback(logCallback_);
+        }
+        store->SetLogLevel(config_.logLevel);
+        
+        auto rootPath = std::filesystem::path(config_.localStoragePath) / resourceName / containerName;
+        if (!store->Initialize(rootPath.string())) {
+            lastError_ = "Failed to initialize local disk store at " + rootPath.string();
+            LogError(lastError_);
+            return nullptr;
+        }
+        return store;
+    }
+    
     auto store = std::make_shared<AzureStorageKVStoreLibV2>();
     
     // Set up logging callback
@@ -109,6 +138,17 @@ std::shared_ptr<AzureStorageKVStoreLibV2> InMemoryAccountResolver::CreateStore(
     }
     
     store->SetLogLevel(config_.logLevel);
+    store->SetMetadataCacheOptions(config_.metadataCache);
+    auto strategyIt = config_.containerProbeStrategies.find(containerName);
+    store->SetProbeStrategy(strategyIt != config_.containerProbeStrategies.end() ? strategyIt->second : config_.probeStrategy);
+    store->SetBloomFilterOptions(config_.bloomFilter, config_.bloomSnapshotInterval);
+    store->SetChunkCache(config_.chunkCache);
+    store->SetHotChunkCache(config_.hotChunkCache);
+    store->SetBlobNaming(config_.blobNaming, config_.legacyNameFallback);
+    store->SetVersionReclaimerOptions(config_.versionReclaimer);
+    store->SetContentDedup(config_.contentDedup);
+    store->SetParallelTransferOptions(config_.parallelTransfer);
+    store->SetRecentWriteOptions(config_.recentWrites);
     
     // Initialize the store
     bool success = store->Initialize(
@@ -0,0 +1,62 @@
+#include "InMemoryKVStoreEngine.h"
+#include <functional>
+#include <mutex>
+
+std::future<std::pair<bool, PromptChunk>> InMemoryKVStoreEngine::ReadAsync(const std::string& location, const std::string& completionId) const {
+    std::promise<std::pair<bool, PromptChunk>> promise;
+    promise.set_value(Read(location, completionId));
+    return promise.get_future();
+}
+
+std::future<void> InMemoryKVStoreEngine::WriteAsync(const PromptChunk& chunk) {
+    std::promise<void> promise;
+    try {
+        Write(chunk);
+        promise.set_value();
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+    return promise.get_future();
+}
+
+bool InMemoryKVStoreEngine::PutPayload(const std::string& location, const PromptChunk& chunk) {
+    // Keep only what ReadAsync returns; tokens are implied by the blob name
+    PromptChunk stored;
+    stored.hash = chunk.hash;
+    stored.parentHash = chunk.parentHash;
+    stored.partitionKey = chunk.partitionKey;
+    stored.buffer = chunk.buffer;
+    stored.bufferSize = stored.buffer.size();
+    stored.encoding = chunk.encoding;
+
+    PayloadShard& shard = GetPayloadShard(location);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.payloads[location] = std::move(stored);
+    return true;
+}
+
+bool InMemoryKVStoreEngine::GetPayload(const std::string& location, PromptChunk& chunk) const {
+    const PayloadShard& shard = GetPayloadShard(location);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.payloads.find(location);
+    if (it == shard.payloads.end()) {
+        return false;
+    }
+    chunk = it->second;
+    chunk.bytesCopied = chunk.buffer.size();
+    return true;
+}
+
+void InMemoryKVStoreEngine::RemovePayload(const std::string& location) {
+    PayloadShard& shard = GetPayloadShard(location);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.payloads.erase(location);
+}
+
+InMemoryKVStoreEngine::PayloadShard& InMemoryKVStoreEngine::GetPayloadShard(const std::string& location) {
+    return payloadShards_[std::hash<std::string>{}(location) % kShardCount];
+}
+
+const InMemoryKVStoreEngine::PayloadShard& InMemoryKVStoreEngine::GetPayloadShard(const std::string& location) const {
+    return payloadShards_[std::hash<std::string>{}(location) % kShardCount];
+}
@@ -3,7 +3,9 @@
 #include "reactors/LookupReactor.h"
 #include "reactors/ReadReactor.h"
 #include "reactors/WriteReactor.h"
+#include "reactors/WriteBatchReactor.h"
 #include "reactors/StreamingReadReactor.h"
+#include "MetricsHelper.h"
 #include <iostream>
 #include <sstream>
 
@@ -23,6 +25,27 @@ KVStoreServiceImpl::~KVStoreServiceImpl() {
     LogInfo("KVStore gRPC Service shutting down");
 }
 
+void KVStoreServiceImpl::SetStreamingReadLimits(const StreamingReadLimits& limits) {
+    streamingReadLimits_ = limits;
+    MetricsHelper::GetInstance().SetGauge("streaming_read.response_budget_bytes",
+                                          static_cast<int64_t>(limits.responseBudgetBytes));
+}
+
+bool KVStoreServiceImpl::ResponseBudgetExceeded() const {
+    return streamingReadLimits_.responseBudgetBytes > 0 &&
+           bufferedResponseBytes_.load() >= streamingReadLimits_.responseBudgetBytes;
+}
+
+void KVStoreServiceImpl::ChargeResponseBytes(size_t bytes) {
+    size_t buffered = bufferedResponseBytes_.fetch_add(bytes) + bytes;
+    MetricsHelper::GetInstance().SetGauge("streaming_read.buffered_bytes", static_cast<int64_t>(buffered));
+}
+
+void KVStoreServiceImpl::ReleaseResponseBytes(size_t bytes) {
+    size_t buffered = bufferedResponseBytes_.fetch_sub(bytes) - bytes;
+    MetricsHelper::GetInstance().SetGauge("streaming_read.buffered_bytes", static_cast<int64_t>(buffered));
+}
+
 // Service implementation - returns reactor for each RPC
 grpc::ServerUnaryReactor* KVStoreServiceImpl::Lookup(
     grpc::CallbackServerContext* context,
@@ -48,6 +71,14 @@ grpc::ServerUnaryReactor* KVStoreServiceImpl::Write(
     return new WriteReactor(this, context, request, response);
 }
 
+grpc::ServerUnaryReactor* KVStoreServiceImpl::WriteBatch(
+    grpc::CallbackServerContext* context,
+    const WriteBatchRequest* request,
+    WriteBatchResponse* response) {
+    
+    return new WriteBatchReactor(this, context, request, response);
+}
+
 grpc::ServerBidiReactor<ReadRequest, ReadResponse>* KVStoreServiceImpl::StreamingRead(
     grpc::CallbackServerContext* context) {
     
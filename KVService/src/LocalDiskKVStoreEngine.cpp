@@ -0,0 +1,252 @@
+#include "LocalDiskKVStoreEngine.h"
+#include "StorageIoExecutor.h"
+#include "VersionIndex.h"
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+
+namespace {
+    constexpr char kIndexMagic[4] = {'K', 'V', 'I', '1'};
+    constexpr char kChunkMagic[4] = {'K', 'V', 'C', '2'};         // Payload encoding after the partition key
+    constexpr char kRawChunkMagic[4] = {'K', 'V', 'C', '1'};      // Older files: raw payload
+
+    // Files are only read back by the machine that wrote them, so values use host byte order
+    void WriteU64(std::ostream& out, uint64_t value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void WriteString(std::ostream& out, const std::string& value) {
+        WriteU64(out, value.size());
+        out.write(value.data(), static_cast<std::streamsize>(value.size()));
+    }
+
+    bool ReadU64(std::istream& in, uint64_t& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+
+    bool ReadString(std::istream& in, std::string& value) {
+        uint64_t size = 0;
+        if (!ReadU64(in, size) || size > (1u << 20)) {
+            return false;
+        }
+        value.resize(static_cast<size_t>(size));
+        return size == 0 || static_cast<bool>(in.read(&value[0], static_cast<std::streamsize>(size)));
+    }
+
+    void WriteVersion(std::ostream& out, const LocalBlockVersion& version) {
+        WriteU64(out, version.hash);
+        WriteU64(out, version.parentHash);
+        WriteString(out, version.location);
+    }
+
+    bool ReadVersion(std::istream& in, LocalBlockVersion& version) {
+        return ReadU64(in, version.hash) && ReadU64(in, version.parentHash) && ReadString(in, version.location);
+    }
+
+    // FNV-1a: blob names are ~683 characters, too long for a file name
+    std::string HashFileName(const std::string& name) {
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : name) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        std::stringstream ss;
+        ss << std::hex << std::setfill('0') << std::setw(16) << hash;
+        return ss.str();
+    }
+
+    // Unique temp name so concurrent writers of the same target never share a file
+    std::filesystem::path TempPath(const std::filesystem::path& target) {
+        static std::atomic<uint64_t> counter{0};
+        return target.string() + ".tmp" + std::to_string(counter.fetch_add(1));
+    }
+
+    template<typename WriteFn>
+    bool WriteFileAtomically(const std::filesystem::path& target, WriteFn writeFn) {
+        auto temp = TempPath(target);
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                return false;
+            }
+            writeFn(out);
+            out.flush();
+            if (!out) {
+                out.close();
+                std::error_code ec;
+                std::filesystem::remove(temp, ec);
+                return false;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(temp, target, ec);
+        if (ec) {
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+        return true;
+    }
+}
+
+bool LocalDiskKVStoreEngine::Initialize(const std::string& rootPath) {
+    root_ = rootPath;
+    indexDir_ = root_ / "index";
+    chunkDir_ = root_ / "chunks";
+
+    std::error_code ec;
+    std::filesystem::create_directories(indexDir_, ec);
+    if (ec) {
+        Log(LogLevel::Error, "[Local Disk] Failed to create " + indexDir_.string() + ": " + ec.message());
+        return false;
+    }
+    std::filesystem::create_directories(chunkDir_, ec);
+    if (ec) {
+        Log(LogLevel::Error, "[Local Disk] Failed to create " + chunkDir_.string() + ": " + ec.message());
+        return false;
+    }
+
+    // Rebuild the in-memory index; drop temp files left behind by an interrupted write
+    size_t loaded = 0;
+    for (const auto& dir : {indexDir_, chunkDir_}) {
+        for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+            const auto& path = entry.path();
+            if (path.filename().string().find(".tmp") != std::string::npos) {
+                std::filesystem::remove(path, ec);
+                continue;
+            }
+            if (dir != indexDir_ || path.extension() != ".meta") {
+                continue;
+            }
+
+            std::ifstream in(path, std::ios::binary);
+            char magic[4] = {};
+            std::string blobName;
+            LocalBlockRecord record;
+            uint64_t versionCount = 0;
+            bool ok = in.read(magic, sizeof(magic)) && std::memcmp(magic, kIndexMagic, sizeof(magic)) == 0 &&
+                      ReadString(in, blobName) && ReadVersion(in, record.defaultVersion) &&
+                      ReadU64(in, versionCount) && versionCount <= kMaxVersions;
+            for (uint64_t i = 0; ok && i < versionCount; ++i) {
+                LocalBlockVersion version;
+                ok = ReadVersion(in, version);
+                record.additionalVersions.push_back(std::move(version));
+            }
+            if (!ok) {
+                Log(LogLevel::Error, "[Local Disk] Skipping corrupt index file: " + path.string());
+                continue;
+            }
+            LoadRecord(blobName, std::move(record));
+            loaded++;
+        }
+    }
+
+    Log(LogLevel::Information, "[Local Disk] Initialized at " + root_.string() + " (" + std::to_string(loaded) + " blocks indexed)");
+    return true;
+}
+
+std::future<std::pair<bool, PromptChunk>> LocalDiskKVStoreEngine::ReadAsync(const std::string& location, const std::string& completionId) const {
+    return StorageIoExecutor::GetInstance().Submit([this, location, completionId]() {
+        return Read(location, completionId);
+    });
+}
+
+std::future<void> LocalDiskKVStoreEngine::WriteAsync(const PromptChunk& chunk) {
+    return StorageIoExecutor::GetInstance().Submit([this, chunk]() {
+        Write(chunk);
+    });
+}
+
+bool LocalDiskKVStoreEngine::PutPayload(const std::string& location, const PromptChunk& chunk) {
+    return WriteFileAtomically(ChunkPath(location), [&chunk](std::ostream& out) {
+        out.write(kChunkMagic, sizeof(kChunkMagic));
+        WriteU64(out, chunk.hash);
+        WriteU64(out, chunk.parentHash);
+        WriteString(out, chunk.partitionKey);
+        WriteU64(out, static_cast<uint64_t>(chunk.encoding.codec));
+        WriteU64(out, chunk.encoding.shuffle);
+        WriteU64(out, chunk.encoding.rawSize);
+        WriteU64(out, chunk.buffer.size());
+        out.write(chunk.buffer.data(), static_cast<std::streamsize>(chunk.buffer.size()));
+    });
+}
+
+bool LocalDiskKVStoreEngine::GetPayload(const std::string& location, PromptChunk& chunk) const {
+    // Read locations come from clients; never let one name a file outside chunks/
+    if (!IsChunkLocation(location)) {
+        return false;
+    }
+    std::ifstream in(ChunkPath(location), std::ios::binary);
+    if (!in) {
+        return false;
+    }
+
+    char magic[4] = {};
+    if (!in.read(magic, sizeof(magic)) ||
+        (std::memcmp(magic, kChunkMagic, sizeof(magic)) != 0 && std::memcmp(magic, kRawChunkMagic, sizeof(magic)) != 0) ||
+        !ReadU64(in, chunk.hash) || !ReadU64(in, chunk.parentHash) || !ReadString(in, chunk.partitionKey)) {
+        return false;
+    }
+    chunk.encoding = payload::Encoding();
+    if (std::memcmp(magic, kChunkMagic, sizeof(magic)) == 0) {
+        uint64_t codec = 0, shuffle = 0;
+        if (!ReadU64(in, codec) || !ReadU64(in, shuffle) || !ReadU64(in, chunk.encoding.rawSize) ||
+            codec > 255 || shuffle > payload::kMaxShuffle) {
+            return false;
+        }
+        chunk.encoding.codec = static_cast<payload::Codec>(codec);
+        chunk.encoding.shuffle = static_cast<uint8_t>(shuffle);
+    }
+    uint64_t bufferSize = 0;
+    if (!ReadU64(in, bufferSize)) {
+        return false;
+    }
+
+    chunk.buffer.resize(static_cast<size_t>(bufferSize));
+    if (bufferSize > 0 && !in.read(&chunk.buffer[0], static_cast<std::streamsize>(bufferSize))) {
+        return false;
+    }
+    chunk.bufferSize = chunk.buffer.size();
+    return true;
+}
+
+void LocalDiskKVStoreEngine::RemovePayload(const std::string& location) {
+    if (!IsChunkLocation(location)) {
+        return;
+    }
+    std::error_code ec;
+    std::filesystem::remove(ChunkPath(location), ec);
+}
+
+void LocalDiskKVStoreEngine::OnRecordUpdated(const std::string& blobName, const LocalBlockRecord& record) {
+    bool ok = WriteFileAtomically(IndexPath(blobName), [&](std::ostream& out) {
+        out.write(kIndexMagic, sizeof(kIndexMagic));
+        WriteString(out, blobName);
+        WriteVersion(out, record.defaultVersion);
+        WriteU64(out, record.additionalVersions.size());
+        for (const auto& version : record.additionalVersions) {
+            WriteVersion(out, version);
+        }
+    });
+    if (!ok) {
+        // Index stays correct in memory; only a restart would lose this version
+        Log(LogLevel::Error, "[Local Disk] Failed to persist index record to " + IndexPath(blobName).string());
+    }
+}
+
+// Only the "16hex-16hex" names GenerateLocation produces: no separators, dots or drive letters
+bool LocalDiskKVStoreEngine::IsChunkLocation(const std::string& location) {
+    uint64_t high = 0, low = 0;
+    return VersionRecord::ParseLocation(location, high, low);
+}
+
+std::filesystem::path LocalDiskKVStoreEngine::ChunkPath(const std::string& location) const {
+    return chunkDir_ / (location + ".chunk");
+}
+
+std::filesystem::path LocalDiskKVStoreEngine::IndexPath(const std::string& blobName) const {
+    return indexDir_ / (HashFileName(blobName) + ".meta");
+}
@@ -0,0 +1,184 @@
+#include "LocalKVStoreEngine.h"
+#include "BlobNameCodec.h"
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+LookupResult LocalKVStoreEngine::Lookup(
+    const std::string& /*partitionKey*/,
+    const std::string& completionId,
+    std::vector<Token>::const_iterator begin,
+    std::vector<Token>::const_iterator end,
+    const std::vector<hash_t>& /*precomputedHashes*/,
+    ProbeStrategy /*probeStrategy*/
+) const {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    size_t totalTokens = std::distance(begin, end);
+    size_t numFullBlocks = totalTokens / kBlockSize;
+
+    LookupResult result;
+    hash_t expectedParentHash = 0;
+
+    for (size_t blockNum = 0; blockNum < numFullBlocks; ++blockNum) {
+        auto blockBegin = begin + (blockNum * kBlockSize);
+        std::string blobName = blobname::EncodeTokensToBlobName(blockBegin, blockBegin + kBlockSize);
+
+        const Shard& shard = GetShard(blobName);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+        auto it = shard.records.find(blobName);
+        if (it == shard.records.end()) {
+            Log(LogLevel::Verbose, "[Local Lookup]   Block " + std::to_string(blockNum) + " not found, breaking chain", completionId);
+            break;
+        }
+
+        // Same resolution rules as the Azure engine: block 0 always takes the default version,
+        // later blocks need a version whose parent is the previous block's hash
+        const LocalBlockRecord& record = it->second;
+        const LocalBlockVersion* match = nullptr;
+        if (blockNum == 0 || record.defaultVersion.parentHash == expectedParentHash) {
+            match = &record.defaultVersion;
+        } else {
+            for (const auto& version : record.additionalVersions) {
+                if (version.parentHash == expectedParentHash) {
+                    match = &version;
+                    break;
+                }
+            }
+        }
+
+        if (!match) {
+            Log(LogLevel::Verbose, "[Local Lookup]   Parent chain mismatch at block " + std::to_string(blockNum), completionId);
+            break;
+        }
+
+        result.locations.push_back(BlockLocation(match->hash, match->location));
+        result.cachedBlocks++;
+        result.lastHash = match->hash;
+        expectedParentHash = match->hash;
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+    Log(LogLevel::Information, "[Local Lookup] Lookup took " + std::to_string(duration) + "us, found " +
+        std::to_string(result.cachedBlocks) + "/" + std::to_string(numFullBlocks) + " blocks", completionId);
+
+    return result;
+}
+
+std::pair<bool, PromptChunk> LocalKVStoreEngine::Read(const std::string& location, const std::string& completionId) const {
+    PromptChunk chunk;
+    if (!GetPayload(location, chunk)) {
+        Log(LogLevel::Error, "[Local Read] Location not found: " + location, completionId);
+        return {false, PromptChunk()};
+    }
+    return {true, std::move(chunk)};
+}
+
+void LocalKVStoreEngine::Write(const PromptChunk& chunk) {
+    std::string blobName = blobname::EncodeTokensToBlobName(chunk.tokens.cbegin(), chunk.tokens.cend());
+    Shard& shard = GetShard(blobName);
+
+    // Fast path: identical (hash, parentHash) already stored
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.records.find(blobName);
+        if (it != shard.records.end() && HasVersion(it->second, chunk.hash, chunk.parentHash)) {
+            Log(LogLevel::Verbose, "[Local Write]   Identical version already exists - skipping", chunk.completionId);
+            return;
+        }
+    }
+
+    // Store the payload under a fresh location before publishing it in the index
+    std::string location = GenerateLocation();
+    if (!PutPayload(location, chunk)) {
+        throw std::runtime_error("Failed to store payload at location " + location);
+    }
+
+    bool duplicate = false;
+    std::vector<std::string> evicted;
+    {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.records.find(blobName);
+        if (it == shard.records.end()) {
+            LocalBlockRecord record;
+            record.defaultVersion = LocalBlockVersion{chunk.hash, chunk.parentHash, location};
+            auto inserted = shard.records.emplace(blobName, std::move(record));
+            OnRecordUpdated(blobName, inserted.first->second);
+        } else if (HasVersion(it->second, chunk.hash, chunk.parentHash)) {
+            // Lost the race to a concurrent identical write
+            duplicate = true;
+        } else {
+            auto& versions = it->second.additionalVersions;
+            versions.push_back(LocalBlockVersion{chunk.hash, chunk.parentHash, location});
+            while (versions.size() > kMaxVersions) {
+                evicted.push_back(versions.front().location);
+                versions.erase(versions.begin());
+            }
+            OnRecordUpdated(blobName, it->second);
+        }
+    }
+
+    if (duplicate) {
+        RemovePayload(location);
+        return;
+    }
+    for (const auto& oldLocation : evicted) {
+        Log(LogLevel::Verbose, "[Local Write]   Evicting oldest version: " + oldLocation, chunk.completionId);
+        RemovePayload(oldLocation);
+    }
+    Log(LogLevel::Verbose, "[Local Write]   Stored version at " + location, chunk.completionId);
+}
+
+void LocalKVStoreEngine::LoadRecord(const std::string& blobName, LocalBlockRecord record) {
+    Shard& shard = GetShard(blobName);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.records[blobName] = std::move(record);
+}
+
+LocalKVStoreEngine::Shard& LocalKVStoreEngine::GetShard(const std::string& blobName) {
+    return shards_[std::hash<std::string>{}(blobName) % kShardCount];
+}
+
+const LocalKVStoreEngine::Shard& LocalKVStoreEngine::GetShard(const std::string& blobName) const {
+    return shards_[std::hash<std::string>{}(blobName) % kShardCount];
+}
+
+bool LocalKVStoreEngine::HasVersion(const LocalBlockRecord& record, hash_t hash, hash_t parentHash) {
+    if (record.defaultVersion.hash == hash && record.defaultVersion.parentHash == parentHash) {
+        return true;
+    }
+    for (const auto& version : record.additionalVersions) {
+        if (version.hash == hash && version.parentHash == parentHash) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Same "16hex-16hex" shape as the Azure engine's GUID blob names
+std::string LocalKVStoreEngine::GenerateLocation() {
+    thread_local std::mt19937_64 gen(std::random_device{}());
+    std::uniform_int_distribution<uint64_t> dis;
+
+    std::stringstream ss;
+    ss << std::hex << std::setfill('0');
+    ss << std::setw(16) << dis(gen) << "-" << std::setw(16) << dis(gen);
+    return ss.str();
+}
+
+void LocalKVStoreEngine::Log(LogLevel level, const std::string& message, const std::string& completionId) const {
+    if (logCallback_ && level <= logLevel_) {
+        std::string fullMessage;
+        if (!completionId.empty()) {
+            fullMessage += "[Run: " + completionId + "] ";
+        }
+        fullMessage += message;
+        logCallback_(level, fullMessage);
+    }
+}
@@ -46,4 +46,52 @@ void MetricsHelper::IncrementRequestCount(const std::string& method, bool succes
     }
 }
 
+void MetricsHelper::IncrementCounter(const std::string& name, uint64_t delta) {
+    GetSlot(counters_, name).fetch_add(static_cast<int64_t>(delta), std::memory_order_relaxed);
+}
+
+void MetricsHelper::SetGauge(const std::string& name, int64_t value) {
+    GetSlot(gauges_, name).store(value, std::memory_order_relaxed);
+}
+
+void MetricsHelper::RecordLatency(const std::string& name, int64_t latency_us) {
+    IncrementCounter(name + ".count");
+    IncrementCounter(name + ".total_us", static_cast<uint64_t>(latency_us < 0 ? 0 : latency_us));
+}
+
+uint64_t MetricsHelper::GetCounter(const std::string& name) const {
+    return static_cast<uint64_t>(ReadSlot(counters_, name));
+}
+
+int64_t MetricsHelper::GetGauge(const std::string& name) const {
+    return ReadSlot(gauges_, name);
+}
+
+std::atomic<int64_t>& MetricsHelper::GetSlot(
+    std::unordered_map<std::string, std::unique_ptr<std::atomic<int64_t>>>& slots,
+    const std::string& name) {
+    {
+        std::shared_lock<std::shared_mutex> lock(slotsMutex_);
+        auto it = slots.find(name);
+        if (it != slots.end()) {
+            return *it->second;
+        }
+    }
+    
+    std::unique_lock<std::shared_mutex> lock(slotsMutex_);
+    auto& slot = slots[name];
+    if (!slot) {
+        slot = std::make_unique<std::atomic<int64_t>>(0);
+    }
+    return *slot;
+}
+
+int64_t MetricsHelper::ReadSlot(
+    const std::unordered_map<std::string, std::unique_ptr<std::atomic<int64_t>>>& slots,
+    const std::string& name) const {
+    std::shared_lock<std::shared_mutex> lock(slotsMutex_);
+    auto it = slots.find(name);
+    return it != slots.end() ? it->second->load(std::memory_order_relaxed) : 0;
+}
+
 } // namespace kvstore
@@ -0,0 +1,101 @@
+#include "RecentWriteSet.h"
+#include <algorithm>
+#include <functional>
+
+RecentWriteSet::RecentWriteSet(const RecentWriteSetOptions& options) {
+    Configure(options);
+}
+
+void RecentWriteSet::Configure(const RecentWriteSetOptions& options) {
+    auto now = Clock::now();
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.current.clear();
+        shard.previous.clear();
+        shard.currentSince = now;
+        shard.previousSince = now;
+    }
+    // Two generations share the budget
+    size_t perShard = (options.maxEntries + kShardCount - 1) / kShardCount;
+    maxEntriesPerGeneration_ = options.maxEntries == 0 ? 0 : std::max<size_t>(perShard / 2, 1);
+    ttl_ = options.ttl;
+}
+
+bool RecentWriteSet::Contains(const std::string& blobName, hash_t hash, hash_t parentHash) {
+    if (!Enabled()) {
+        return false;
+    }
+
+    Key key = MakeKey(blobName, hash, parentHash);
+    Shard& shard = GetShard(key);
+    bool found;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Rotate(shard, Clock::now());
+        found = shard.current.count(key) > 0 || shard.previous.count(key) > 0;
+    }
+    (found ? hits_ : misses_).fetch_add(1, std::memory_order_relaxed);
+    return found;
+}
+
+void RecentWriteSet::Insert(const std::string& blobName, hash_t hash, hash_t parentHash) {
+    if (!Enabled()) {
+        return;
+    }
+
+    Key key = MakeKey(blobName, hash, parentHash);
+    Shard& shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    Rotate(shard, Clock::now());
+    shard.current.insert(key);
+}
+
+void RecentWriteSet::Erase(const std::string& blobName, hash_t hash, hash_t parentHash) {
+    if (!Enabled()) {
+        return;
+    }
+
+    Key key = MakeKey(blobName, hash, parentHash);
+    Shard& shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.current.erase(key);
+    shard.previous.erase(key);
+}
+
+RecentWriteSetStats RecentWriteSet::GetStats() const {
+    RecentWriteSetStats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.entries += shard.current.size() + shard.previous.size();
+    }
+    return stats;
+}
+
+void RecentWriteSet::Rotate(Shard& shard, Clock::time_point now) {
+    if (shard.current.size() >= maxEntriesPerGeneration_ || now - shard.currentSince >= ttl_ / 2) {
+        shard.previous.swap(shard.current);
+        shard.current.clear();
+        shard.previousSince = shard.currentSince;
+        shard.currentSince = now;
+    }
+    // An idle shard can hold a generation past ttl
+    if (now - shard.previousSince >= ttl_) {
+        shard.previous.clear();
+    }
+}
+
+size_t RecentWriteSet::KeyHash::operator()(const Key& key) const {
+    // The fields are already well-mixed hashes; fold them (64-bit golden-ratio multipliers)
+    uint64_t h = key.nameHash ^ (key.hash * 0x9E3779B97F4A7C15ull) ^ (key.parentHash * 0xC2B2AE3D27D4EB4Full);
+    return static_cast<size_t>(h ^ (h >> 32));
+}
+
+RecentWriteSet::Key RecentWriteSet::MakeKey(const std::string& blobName, hash_t hash, hash_t parentHash) {
+    return Key{static_cast<uint64_t>(std::hash<std::string>{}(blobName)), hash, parentHash};
+}
+
+RecentWriteSet::Shard& RecentWriteSet::GetShard(const Key& key) {
+    return shards_[key.nameHash % kShardCount];
+}
@@ -0,0 +1,434 @@
+#include "RequestExecutor.h"
+#include "MetricsHelper.h"
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// An idle worker re-checks the other nodes this often even without a steal request,
+// which covers the window between its last scan and going to sleep
+constexpr auto kStealInterval = std::chrono::milliseconds(5);
+
+// Node of the current thread when it is a worker, -1 otherwise
+thread_local int32_t t_workerNode = -1;
+
+// Per-class metric names, indexed by RequestPriority
+const std::string kQueueDepthMetric[kRequestPriorityCount] = {
+    "request_executor.queue_depth.high", "request_executor.queue_depth.normal", "request_executor.queue_depth.low"};
+const std::string kQueueWaitMetric[kRequestPriorityCount] = {
+    "request_executor.queue_wait.high", "request_executor.queue_wait.normal", "request_executor.queue_wait.low"};
+
+#ifndef _WIN32
+// "0-3,8,10-11" -> {0,1,2,3,8,10,11}
+std::vector<uint32_t> ParseCpuList(const std::string& list) {
+    std::vector<uint32_t> cpus;
+    std::stringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        if (range.empty() || range == "\n") {
+            continue;
+        }
+        try {
+            size_t dash = range.find('-');
+            uint32_t first = static_cast<uint32_t>(std::stoul(range.substr(0, dash)));
+            uint32_t last = dash == std::string::npos ? first : static_cast<uint32_t>(std::stoul(range.substr(dash + 1)));
+            for (uint32_t cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            return {};
+        }
+    }
+    return cpus;
+}
+#endif
+
+} // namespace
+
+RequestExecutor& RequestExecutor::GetInstance() {
+    // Workers report to MetricsHelper, so it must be constructed first (and destroyed last)
+    kvstore::MetricsHelper::GetInstance();
+    static RequestExecutor instance;
+    return instance;
+}
+
+void RequestExecutor::Configure(const RequestExecutorOptions& options) {
+    std::lock_guard<std::mutex> lock(startMutex_);
+    if (!started_.load()) {
+        options_ = options;
+    }
+    options_.maxQueueDepth = std::max<size_t>(options.maxQueueDepth, 1);
+    maxQueueDepth_.store(options_.maxQueueDepth);
+}
+
+RequestExecutor::~RequestExecutor() {
+    stopping_.store(true);
+    for (auto& node : nodes_) {
+        std::lock_guard<std::mutex> lock(node->mutex);
+        node->cv.notify_all();
+    }
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void RequestExecutor::Start() {
+    // Nodes with at least one processor this process may run on
+    if (options_.numaAware) {
+#ifdef _WIN32
+        ULONG highestNode = 0;
+        if (GetNumaHighestNodeNumber(&highestNode)) {
+            for (ULONG osNode = 0; osNode <= highestNode; ++osNode) {
+                GROUP_AFFINITY affinity = {};
+                if (!GetNumaNodeProcessorMaskEx(static_cast<USHORT>(osNode), &affinity) || affinity.Mask == 0) {
+                    continue;
+                }
+                auto node = std::make_unique<Node>();
+                node->osNode = static_cast<uint32_t>(osNode);
+                node->group = affinity.Group;
+                node->groupMask = static_cast<uint64_t>(affinity.Mask);
+                nodes_.push_back(std::move(node));
+            }
+        }
+#else
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        bool haveMask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+            std::string name = entry.path().filename().string();
+            if (name.compare(0, 4, "node") != 0 || name.size() == 4 ||
+                !std::all_of(name.begin() + 4, name.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+                continue;
+            }
+            std::ifstream file(entry.path() / "cpulist");
+            std::string list;
+            std::getline(file, list);
+
+            auto node = std::make_unique<Node>();
+            node->osNode = static_cast<uint32_t>(std::stoul(name.substr(4)));
+            for (uint32_t cpu : ParseCpuList(list)) {
+                if (!haveMask || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed))) {
+                    node->cpus.push_back(cpu);
+                }
+            }
+            if (!node->cpus.empty()) {
+                nodes_.push_back(std::move(node));
+            }
+        }
+        std::sort(nodes_.begin(), nodes_.end(), [](const auto& a, const auto& b) { return a->osNode < b->osNode; });
+#endif
+    }
+
+    size_t threads = options_.threads;
+    if (threads == 0) {
+        threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    // One node (or fewer workers than nodes): a single shared queue, no pinning
+    if (nodes_.size() <= 1 || threads < nodes_.size()) {
+        nodes_.clear();
+        nodes_.push_back(std::make_unique<Node>());
+    }
+
+    // Workers in proportion to each node's processors
+    std::vector<size_t> weights;
+    size_t totalWeight = 0;
+    for (const auto& node : nodes_) {
+#ifdef _WIN32
+        size_t weight = 0;
+        for (uint64_t mask = node->groupMask; mask != 0; mask &= mask - 1) {
+            ++weight;
+        }
+#else
+        size_t weight = node->cpus.size();
+#endif
+        weights.push_back(std::max<size_t>(weight, 1));
+        totalWeight += weights.back();
+    }
+    size_t assigned = 0;
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        nodes_[i]->workers = std::max<size_t>(threads * weights[i] / totalWeight, 1);
+        assigned += nodes_[i]->workers;
+    }
+    for (size_t i = 0; assigned < threads; i = (i + 1) % nodes_.size(), ++assigned) {
+        nodes_[i]->workers++;
+    }
+
+    if (nodes_.size() > 1) {
+        std::vector<int32_t> cpuToNode;
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            for (uint32_t cpu : nodes_[i]->cpus) {
+                if (cpu >= cpuToNode.size()) {
+                    cpuToNode.resize(cpu + 1, -1);
+                }
+                cpuToNode[cpu] = static_cast<int32_t>(i);
+            }
+        }
+        cpuToNode_ = std::move(cpuToNode);
+    }
+
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        for (size_t w = 0; w < nodes_[i]->workers; ++w) {
+            workers_.emplace_back([this, i]() { WorkerLoop(i); });
+        }
+    }
+    options_.threads = workers_.size();
+    started_.store(true);
+}
+
+bool RequestExecutor::TrySubmit(std::function<void()> task, RequestPriority priority) {
+    auto& metrics = kvstore::MetricsHelper::GetInstance();
+    if (stopping_.load()) {
+        return false;
+    }
+    if (!started_.load()) {
+        std::lock_guard<std::mutex> lock(startMutex_);
+        if (!started_.load()) {
+            Start();
+        }
+    }
+
+    size_t depth = queued_.fetch_add(1) + 1;
+    if (depth > maxQueueDepth_.load(std::memory_order_relaxed)) {
+        queued_.fetch_sub(1);
+        tasksRejected_.fetch_add(1, std::memory_order_relaxed);
+        metrics.IncrementCounter("request_executor.rejected");
+        return false;
+    }
+    size_t peak = peakQueueDepth_.load(std::memory_order_relaxed);
+    while (depth > peak && !peakQueueDepth_.compare_exchange_weak(peak, depth, std::memory_order_relaxed)) {
+    }
+    size_t cls = static_cast<size_t>(priority);
+    size_t classDepth = queuedByPriority_[cls].fetch_add(1) + 1;
+
+    size_t index = SubmitNode();
+    Node& node = *nodes_[index];
+    bool idle;
+    {
+        std::lock_guard<std::mutex> lock(node.mutex);
+        node.queues[cls].push_back(QueuedTask{std::move(task), Clock::now(), priority});
+        node.queued++;
+        idle = node.idle > 0;
+    }
+    if (idle) {
+        node.cv.notify_one();
+    } else {
+        // Every worker of this node is busy: wake an idle one elsewhere to steal it
+        for (size_t k = 1; k < nodes_.size(); ++k) {
+            Node& other = *nodes_[(index + k) % nodes_.size()];
+            std::unique_lock<std::mutex> lock(other.mutex);
+            if (other.idle > other.stealRequests) {
+                other.stealRequests++;
+                lock.unlock();
+                other.cv.notify_one();
+                break;
+            }
+        }
+    }
+
+    metrics.SetGauge("request_executor.queue_depth", static_cast<int64_t>(depth));
+    metrics.SetGauge(kQueueDepthMetric[cls], static_cast<int64_t>(classDepth));
+    return true;
+}
+
+size_t RequestExecutor::SubmitNode() {
+    if (nodes_.size() == 1) {
+        return 0;
+    }
+    if (t_workerNode >= 0) {
+        return static_cast<size_t>(t_workerNode);
+    }
+#ifdef _WIN32
+    PROCESSOR_NUMBER processor = {};
+    GetCurrentProcessorNumberEx(&processor);
+    USHORT osNode = 0;
+    if (GetNumaProcessorNodeEx(&processor, &osNode)) {
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            if (nodes_[i]->osNode == osNode) {
+                return i;
+            }
+        }
+    }
+#else
+    int cpu = sched_getcpu();
+    if (cpu >= 0 && static_cast<size_t>(cpu) < cpuToNode_.size() && cpuToNode_[cpu] >= 0) {
+        return static_cast<size_t>(cpuToNode_[cpu]);
+    }
+#endif
+    return nextNode_.fetch_add(1, std::memory_order_relaxed) % nodes_.size();
+}
+
+bool RequestExecutor::TryTake(size_t index, QueuedTask& task, bool& stolen) {
+    // Highest class queued anywhere, own node first; the second pass takes any class in case
+    // the counts moved while we looked
+    size_t wanted = kRequestPriorityCount;
+    for (size_t cls = 0; cls < kRequestPriorityCount; ++cls) {
+        if (queuedByPriority_[cls].load() > 0) {
+            wanted = cls;
+            break;
+        }
+    }
+    if (wanted == kRequestPriorityCount) {
+        return false;
+    }
+    auto agedBefore = Clock::now() - options_.starvationLimit;
+
+    for (size_t pass = 0; pass < 2; ++pass) {
+        for (size_t k = 0; k < nodes_.size(); ++k) {
+            Node& node = *nodes_[(index + k) % nodes_.size()];
+            size_t take = kRequestPriorityCount;
+            bool promoted = false;
+            {
+                std::lock_guard<std::mutex> lock(node.mutex);
+                if (node.queued == 0) {
+                    continue;
+                }
+                // Oldest lower-class task past the starvation limit goes first
+                for (size_t cls = kRequestPriorityCount - 1; cls > wanted; --cls) {
+                    if (!node.queues[cls].empty() && node.queues[cls].front().enqueuedAt <= agedBefore) {
+                        take = cls;
+                        promoted = true;
+                        break;
+                    }
+                }
+                for (size_t cls = pass == 0 ? wanted : 0; take == kRequestPriorityCount && cls < kRequestPriorityCount; ++cls) {
+                    if (!node.queues[cls].empty()) {
+                        take = cls;
+                    } else if (pass == 0) {
+                        break;
+                    }
+                }
+                if (take == kRequestPriorityCount) {
+                    continue;
+                }
+                task = std::move(node.queues[take].front());
+                node.queues[take].pop_front();
+                node.queued--;
+            }
+            queued_.fetch_sub(1);
+            queuedByPriority_[take].fetch_sub(1);
+            stolen = k > 0;
+            if (promoted) {
+                tasksPromoted_.fetch_add(1, std::memory_order_relaxed);
+                kvstore::MetricsHelper::GetInstance().IncrementCounter("request_executor.starvation_promotions");
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void RequestExecutor::WorkerLoop(size_t index) {
+    t_workerNode = static_cast<int32_t>(index);
+    Node& node = *nodes_[index];
+
+#ifdef _WIN32
+    if (node.groupMask != 0) {
+        GROUP_AFFINITY affinity = {};
+        affinity.Group = node.group;
+        affinity.Mask = static_cast<KAFFINITY>(node.groupMask);
+        SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr);
+    }
+#else
+    if (!node.cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (uint32_t cpu : node.cpus) {
+            if (cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &set);
+            }
+        }
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+#endif
+
+    while (true) {
+        QueuedTask task;
+        bool stolen = false;
+        if (TryTake(index, task, stolen)) {
+            Run(task, stolen);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(node.mutex);
+        if (stopping_.load() && queued_.load() == 0) {
+            return;  // Stopping and drained
+        }
+        if (node.queued > 0) {
+            continue;
+        }
+        if (node.stealRequests > 0) {
+            node.stealRequests--;
+            continue;
+        }
+        node.idle++;
+        node.cv.wait_for(lock, kStealInterval, [this, &node]() {
+            return stopping_.load() || node.queued > 0 || node.stealRequests > 0;
+        });
+        node.idle--;
+        if (node.stealRequests > 0) {
+            node.stealRequests--;
+        }
+    }
+}
+
+void RequestExecutor::Run(QueuedTask& task, bool stolen) {
+    auto& metrics = kvstore::MetricsHelper::GetInstance();
+    int64_t waitUs = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - task.enqueuedAt).count();
+    int64_t recent = recentQueueWaitUs_.load(std::memory_order_relaxed);
+    recentQueueWaitUs_.store(recent + (waitUs - recent) / 8, std::memory_order_relaxed);
+
+    size_t cls = static_cast<size_t>(task.priority);
+    metrics.RecordLatency("request_executor.queue_wait", waitUs);
+    metrics.RecordLatency(kQueueWaitMetric[cls], waitUs);
+    metrics.SetGauge("request_executor.queue_depth", static_cast<int64_t>(queued_.load(std::memory_order_relaxed)));
+    metrics.SetGauge(kQueueDepthMetric[cls], static_cast<int64_t>(queuedByPriority_[cls].load(std::memory_order_relaxed)));
+    if (stolen) {
+        tasksStolen_.fetch_add(1, std::memory_order_relaxed);
+        metrics.IncrementCounter("request_executor.steals");
+    }
+
+    // Storage calls made by the task queue at its class
+    ScopedRequestPriority scope(task.priority);
+
+    // Reactor tasks report their own errors; anything escaping must not take the worker down
+    try {
+        task.fn();
+    } catch (const std::exception&) {
+        metrics.IncrementCounter("request_executor.task_errors");
+    } catch (...) {
+        metrics.IncrementCounter("request_executor.task_errors");
+    }
+    tasksExecuted_.fetch_add(1, std::memory_order_relaxed);
+}
+
+RequestExecutorStats RequestExecutor::GetStats() const {
+    RequestExecutorStats stats;
+    stats.nodes = started_.load() ? nodes_.size() : 0;
+    stats.threads = started_.load() ? workers_.size() : 0;
+    stats.queueDepth = queued_.load(std::memory_order_relaxed);
+    for (size_t cls = 0; cls < kRequestPriorityCount; ++cls) {
+        stats.queueDepthByPriority[cls] = queuedByPriority_[cls].load(std::memory_order_relaxed);
+    }
+    stats.peakQueueDepth = peakQueueDepth_.load(std::memory_order_relaxed);
+    stats.recentQueueWaitUs = recentQueueWaitUs_.load(std::memory_order_relaxed);
+    stats.tasksExecuted = tasksExecuted_.load(std::memory_order_relaxed);
+    stats.tasksStolen = tasksStolen_.load(std::memory_order_relaxed);
+    stats.tasksRejected = tasksRejected_.load(std::memory_order_relaxed);
+    stats.tasksPromoted = tasksPromoted_.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -388,7 +388,7 @@ AccountInfo StorageDatabaseResolver::ResolveAccountInfo(
     return info;
 }
 
-std::shared_ptr<AzureStorageKVStoreLibV2> StorageDatabaseResolver::ResolveStore(
+std::shared_ptr<IKVStoreEngine> StorageDatabaseResolver::ResolveStore(
     const std::string& resourceName,
     const std::string& containerName) {
     
@@ -468,6 +468,17 @@ std::shared_ptr<AzureStorageKVStoreLibV2> StorageDatabaseResolver::CreateStore(
     }
     
     store->SetLogLevel(config_.logLevel);
+    store->SetMetadataCacheOptions(config_.metadataCache);
+    auto strategyIt = config_.containerProbeStrategies.find(containerName);
+    store->SetProbeStrategy(strategyIt != config_.containerProbeStrategies.end() ? strategyIt->second : config_.probeStrategy);
+    store->SetBloomFilterOptions(config_.bloomFilter, config_.bloomSnapshotInterval);
+    store->SetChunkCache(config_.chunkCache);
+    store->SetHotChunkCache(config_.hotChunkCache);
+    store->SetBlobNaming(config_.blobNaming, config_.legacyNameFallback);
+    store->SetVersionReclaimerOptions(config_.versionReclaimer);
+    store->SetContentDedup(config_.contentDedup);
+    store->SetParallelTransferOptions(config_.parallelTransfer);
+    store->SetRecentWriteOptions(config_.recentWrites);
     
     // Initialize the store
     bool success = store->Initialize(
@@ -0,0 +1,224 @@
+#include "StorageIoExecutor.h"
+#include "MetricsHelper.h"
+#include <algorithm>
+#include <exception>
+#include <string>
+
+namespace {
+
+// Per-class metric names, indexed by RequestPriority
+const std::string kQueueDepthMetric[kRequestPriorityCount] = {
+    "storage_io.queue_depth.high", "storage_io.queue_depth.normal", "storage_io.queue_depth.low"};
+const std::string kQueueWaitMetric[kRequestPriorityCount] = {
+    "storage_io.queue_wait.high", "storage_io.queue_wait.normal", "storage_io.queue_wait.low"};
+
+} // namespace
+
+StorageIoExecutor& StorageIoExecutor::GetInstance() {
+    // Workers report to MetricsHelper, so it must be constructed first (and destroyed last)
+    kvstore::MetricsHelper::GetInstance();
+    static StorageIoExecutor instance;
+    return instance;
+}
+
+void StorageIoExecutor::Configure(const StorageIoExecutorOptions& options) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t threads = workers_.empty() ? options.threads : options_.threads;
+    options_ = options;
+    options_.threads = std::max<size_t>(threads, 1);
+    options_.maxQueueDepth = std::max<size_t>(options_.maxQueueDepth, 1);
+    options_.maxFanOutPerRequest = std::max<size_t>(options_.maxFanOutPerRequest, 1);
+}
+
+StorageIoExecutor::~StorageIoExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+bool StorageIoExecutor::TryEnqueue(std::function<void()> fn) {
+    RequestPriority priority = CurrentRequestPriority();
+    size_t cls = static_cast<size_t>(priority);
+    size_t depth = 0;
+    size_t classDepth = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || queued_ >= options_.maxQueueDepth) {
+            return false;
+        }
+        if (workers_.empty()) {
+            StartWorkers();
+        }
+        queues_[cls].push_back(QueuedTask{std::move(fn), Clock::now(), priority});
+        depth = ++queued_;
+        classDepth = queues_[cls].size();
+        peakQueueDepth_ = std::max(peakQueueDepth_, depth);
+    }
+    cv_.notify_one();
+    auto& metrics = kvstore::MetricsHelper::GetInstance();
+    metrics.SetGauge("storage_io.queue_depth", static_cast<int64_t>(depth));
+    metrics.SetGauge(kQueueDepthMetric[cls], static_cast<int64_t>(classDepth));
+    return true;
+}
+
+// Called with mutex_ held
+StorageIoExecutor::QueuedTask StorageIoExecutor::PopNext(Clock::time_point now) {
+    size_t take = 0;
+    while (queues_[take].empty()) {
+        ++take;
+    }
+    // Oldest lower-class call past the starvation limit goes first
+    bool promoted = false;
+    for (size_t cls = kRequestPriorityCount - 1; cls > take; --cls) {
+        if (!queues_[cls].empty() && now - queues_[cls].front().enqueuedAt >= options_.starvationLimit) {
+            take = cls;
+            promoted = true;
+            break;
+        }
+    }
+    if (promoted) {
+        tasksPromoted_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    QueuedTask task = std::move(queues_[take].front());
+    queues_[take].pop_front();
+    --queued_;
+    return task;
+}
+
+void StorageIoExecutor::RecordRunInline() {
+    tasksRunInline_.fetch_add(1, std::memory_order_relaxed);
+    kvstore::MetricsHelper::GetInstance().IncrementCounter("storage_io.tasks_run_inline");
+}
+
+// Called with mutex_ held
+void StorageIoExecutor::StartWorkers() {
+    workers_.reserve(options_.threads);
+    for (size_t i = 0; i < options_.threads; ++i) {
+        workers_.emplace_back([this]() { WorkerLoop(); });
+    }
+}
+
+void StorageIoExecutor::WorkerLoop() {
+    auto& metrics = kvstore::MetricsHelper::GetInstance();
+
+    while (true) {
+        QueuedTask task;
+        size_t depth = 0;
+        size_t classDepth = 0;
+        int64_t waitUs = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return stopping_ || queued_ > 0; });
+            if (queued_ == 0) {
+                return;  // Stopping and drained
+            }
+            auto now = Clock::now();
+            task = PopNext(now);
+            depth = queued_;
+            classDepth = queues_[static_cast<size_t>(task.priority)].size();
+
+            waitUs = std::chrono::duration_cast<std::chrono::microseconds>(now - task.enqueuedAt).count();
+            recentQueueWaitUs_ += (waitUs - recentQueueWaitUs_) / 8;
+        }
+
+        size_t cls = static_cast<size_t>(task.priority);
+        metrics.SetGauge("storage_io.queue_depth", static_cast<int64_t>(depth));
+        metrics.SetGauge(kQueueDepthMetric[cls], static_cast<int64_t>(classDepth));
+        metrics.RecordLatency("storage_io.queue_wait", waitUs);
+        metrics.RecordLatency(kQueueWaitMetric[cls], waitUs);
+
+        // Anything the call submits in turn (ParallelFor helpers) keeps its class
+        ScopedRequestPriority scope(task.priority);
+        task.fn();
+        tasksExecuted_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void StorageIoExecutor::ParallelFor(size_t count, size_t maxParallelism, const std::function<void(size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+
+    size_t fanOut;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fanOut = maxParallelism == 0 ? options_.maxFanOutPerRequest : maxParallelism;
+    }
+    fanOut = std::min(fanOut, count);
+
+    // Helpers that start after all items are claimed find nothing to do and exit,
+    // so the shared state outlives this call but body is only touched while items remain
+    struct State {
+        std::atomic<size_t> next{0};
+        size_t count = 0;
+        const std::function<void(size_t)>* body = nullptr;
+        std::mutex mutex;
+        std::condition_variable cv;
+        size_t completed = 0;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<State>();
+    state->count = count;
+    state->body = &body;
+
+    auto drain = [state]() {
+        while (true) {
+            size_t i = state->next.fetch_add(1);
+            if (i >= state->count) {
+                return;
+            }
+            std::exception_ptr error;
+            try {
+                (*state->body)(i);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (error && !state->error) {
+                state->error = error;
+            }
+            if (++state->completed == state->count) {
+                state->cv.notify_all();
+            }
+        }
+    };
+
+    for (size_t helper = 1; helper < fanOut; ++helper) {
+        if (!TryEnqueue(drain)) {
+            break;  // Queue full - the caller picks up the remaining items
+        }
+    }
+
+    drain();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&state]() { return state->completed == state->count; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+StorageIoExecutorStats StorageIoExecutor::GetStats() const {
+    StorageIoExecutorStats stats;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.queueDepth = queued_;
+        for (size_t cls = 0; cls < kRequestPriorityCount; ++cls) {
+            stats.queueDepthByPriority[cls] = queues_[cls].size();
+        }
+        stats.peakQueueDepth = peakQueueDepth_;
+        stats.recentQueueWaitUs = recentQueueWaitUs_;
+    }
+    stats.tasksExecuted = tasksExecuted_.load(std::memory_order_relaxed);
+    stats.tasksRunInline = tasksRunInline_.load(std::memory_order_relaxed);
+    stats.tasksPromoted = tasksPromoted_.load(std::memory_order_relaxed);
+    return stats;
+}
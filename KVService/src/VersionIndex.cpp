@@ -0,0 +1,271 @@
+#include "VersionIndex.h"
+#include "BlobNameCodec.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+    constexpr const char* kContentPrefix = "__kvstore_content/";
+    constexpr size_t kContentPrefixLength = 18;
+
+    bool ParseHex64(const char* text, uint64_t& value) {
+        value = 0;
+        for (size_t i = 0; i < 16; ++i) {
+            char c = text[i];
+            uint64_t digit;
+            if (c >= '0' && c <= '9') {
+                digit = static_cast<uint64_t>(c - '0');
+            } else if (c >= 'a' && c <= 'f') {
+                digit = static_cast<uint64_t>(c - 'a' + 10);
+            } else if (c >= 'A' && c <= 'F') {
+                digit = static_cast<uint64_t>(c - 'A' + 10);
+            } else {
+                return false;
+            }
+            value = (value << 4) | digit;
+        }
+        return true;
+    }
+
+    // Value of "key":"<digits>" inside one JSON object, or false
+    bool ExtractField(const std::string& json, size_t begin, size_t end, const char* key, size_t& valueBegin, size_t& valueEnd) {
+        size_t keyPos = json.find(key, begin);
+        if (keyPos == std::string::npos || keyPos >= end) {
+            return false;
+        }
+        valueBegin = keyPos + std::strlen(key);
+        valueEnd = json.find('"', valueBegin);
+        return valueEnd != std::string::npos && valueEnd <= end;
+    }
+}
+
+std::string VersionRecord::Location(const std::string& defaultBlobName) const {
+    if (payload == VersionPayload::Default) {
+        return defaultBlobName;
+    }
+    if (payload == VersionPayload::Content) {
+        return ContentLocation(defaultBlobName, content);
+    }
+    char buffer[34];
+    std::snprintf(buffer, sizeof(buffer), "%016llx-%016llx",
+                  static_cast<unsigned long long>(locationHigh), static_cast<unsigned long long>(locationLow));
+    return std::string(buffer, 33);
+}
+
+std::string VersionRecord::ReadLocation(const std::string& defaultBlobName) const {
+    std::string location = Location(defaultBlobName);
+    if (payload == VersionPayload::Guid) {
+        return location;   // Written for this version alone; its metadata is exact
+    }
+    char suffix[35];
+    std::snprintf(suffix, sizeof(suffix), "#%016llx-%016llx",
+                  static_cast<unsigned long long>(hash), static_cast<unsigned long long>(parentHash));
+    return location + std::string(suffix, 34);
+}
+
+bool VersionRecord::SplitReadLocation(const std::string& location, std::string& blobName, hash_t& hash, hash_t& parentHash) {
+    // Blob names are base64url or hex, so '#' only ever starts the version suffix
+    size_t mark = location.size() >= 34 ? location.size() - 34 : std::string::npos;
+    uint64_t high = 0, low = 0;
+    if (mark == std::string::npos || location[mark] != '#' || !ParseLocation(location.substr(mark + 1), high, low)) {
+        blobName = location;
+        return false;
+    }
+    blobName = location.substr(0, mark);
+    hash = high;
+    parentHash = low;
+    return true;
+}
+
+bool VersionRecord::ParseLocation(const std::string& location, uint64_t& high, uint64_t& low) {
+    return location.size() == 33 && location[16] == '-' &&
+           ParseHex64(location.data(), high) && ParseHex64(location.data() + 17, low);
+}
+
+std::string VersionRecord::ContentLocation(const std::string& defaultBlobName, const ContentDigest& digest) {
+    return kContentPrefix + defaultBlobName + "/" + digest.Hex();
+}
+
+bool VersionRecord::ParseContentLocation(const std::string& location, std::string& defaultBlobName, ContentDigest& digest) {
+    size_t slash = location.rfind('/');
+    if (location.compare(0, kContentPrefixLength, kContentPrefix) != 0 || slash == std::string::npos ||
+        slash <= kContentPrefixLength || !ContentDigest::ParseHex(location.substr(slash + 1), digest)) {
+        return false;
+    }
+    defaultBlobName = location.substr(kContentPrefixLength, slash - kContentPrefixLength);
+    return true;
+}
+
+bool VersionIndex::Decode(const std::string& encoded, VersionIndex& index) {
+    index.records_.clear();
+    index.byParent_.clear();
+
+    // Bound the work before decoding anything
+    size_t maxChars = blobname::EncodedLength(1 + kMaxRecords * kContentRecordSize);
+    if (encoded.empty() || encoded.size() > maxChars) {
+        return false;
+    }
+
+    uint8_t bytes[1 + kMaxRecords * kContentRecordSize];
+    size_t written = 0;
+    if (!blobname::Base64UrlDecode(encoded.data(), encoded.size(), bytes, &written) || written == 0) {
+        return false;
+    }
+    size_t recordSize = bytes[0] == kFormatVersion ? kRecordSize
+                      : bytes[0] == kContentFormatVersion ? kContentRecordSize : 0;
+    if (recordSize == 0 || (written - 1) % recordSize != 0 || (written - 1) / recordSize > kMaxRecords) {
+        return false;
+    }
+
+    size_t count = (written - 1) / recordSize;
+    index.records_.resize(count);
+    const uint8_t* cursor = bytes + 1;
+    for (auto& record : index.records_) {
+        std::memcpy(&record.hash, cursor, 8);
+        std::memcpy(&record.parentHash, cursor + 8, 8);
+        const uint8_t* location = cursor + 16;
+        if (recordSize == kContentRecordSize) {
+            if (cursor[16] > static_cast<uint8_t>(VersionPayload::Default)) {
+                index.records_.clear();
+                return false;
+            }
+            record.payload = static_cast<VersionPayload>(cursor[16]);
+            location = cursor + 17;
+        }
+        if (record.payload == VersionPayload::Content) {
+            std::memcpy(record.content.bytes.data(), location, record.content.bytes.size());
+        } else {
+            std::memcpy(&record.locationHigh, location, 8);
+            std::memcpy(&record.locationLow, location + 8, 8);
+        }
+        cursor += recordSize;
+    }
+    index.RebuildParentOrder();
+    return true;
+}
+
+// Format: [{"hash":"123","parentHash":"456","location":"guid"},...]
+bool VersionIndex::DecodeLegacyJson(const std::string& json, VersionIndex& index) {
+    index.records_.clear();
+    index.byParent_.clear();
+
+    size_t pos = 0;
+    while (index.records_.size() < kMaxRecords) {
+        size_t begin = json.find("{\"hash\":", pos);
+        if (begin == std::string::npos) {
+            break;
+        }
+        size_t end = json.find('}', begin);
+        if (end == std::string::npos) {
+            break;
+        }
+        pos = end + 1;
+
+        size_t hashBegin, hashEnd, parentBegin, parentEnd, locationBegin, locationEnd;
+        if (!ExtractField(json, begin, end, "\"hash\":\"", hashBegin, hashEnd) ||
+            !ExtractField(json, begin, end, "\"parentHash\":\"", parentBegin, parentEnd) ||
+            !ExtractField(json, begin, end, "\"location\":\"", locationBegin, locationEnd)) {
+            continue;
+        }
+
+        VersionRecord record;
+        char* parsedEnd = nullptr;
+        record.hash = std::strtoull(json.c_str() + hashBegin, &parsedEnd, 10);
+        record.parentHash = std::strtoull(json.c_str() + parentBegin, &parsedEnd, 10);
+        if (!VersionRecord::ParseLocation(json.substr(locationBegin, locationEnd - locationBegin),
+                                          record.locationHigh, record.locationLow)) {
+            continue;   // Only GUID locations were ever written
+        }
+        index.records_.push_back(record);
+    }
+    index.RebuildParentOrder();
+    return true;
+}
+
+std::string VersionIndex::Encode() const {
+    bool guidOnly = std::all_of(records_.begin(), records_.end(),
+        [](const VersionRecord& record) { return record.payload == VersionPayload::Guid; });
+    size_t recordSize = guidOnly ? kRecordSize : kContentRecordSize;
+
+    std::vector<uint8_t> bytes(1 + records_.size() * recordSize, 0);
+    bytes[0] = guidOnly ? kFormatVersion : kContentFormatVersion;
+    uint8_t* cursor = bytes.data() + 1;
+    for (const auto& record : records_) {
+        std::memcpy(cursor, &record.hash, 8);
+        std::memcpy(cursor + 8, &record.parentHash, 8);
+        uint8_t* location = cursor + 16;
+        if (!guidOnly) {
+            cursor[16] = static_cast<uint8_t>(record.payload);
+            location = cursor + 17;
+        }
+        if (record.payload == VersionPayload::Content) {
+            std::memcpy(location, record.content.bytes.data(), record.content.bytes.size());
+        } else if (record.payload == VersionPayload::Guid) {
+            std::memcpy(location, &record.locationHigh, 8);
+            std::memcpy(location + 8, &record.locationLow, 8);
+        }
+        cursor += recordSize;
+    }
+    return blobname::Base64UrlEncode(bytes);
+}
+
+const VersionRecord* VersionIndex::FindByParent(hash_t parentHash) const {
+    auto it = std::lower_bound(byParent_.begin(), byParent_.end(), parentHash,
+        [this](uint8_t i, hash_t parent) { return records_[i].parentHash < parent; });
+    if (it == byParent_.end() || records_[*it].parentHash != parentHash) {
+        return nullptr;
+    }
+    return &records_[*it];
+}
+
+bool VersionIndex::Contains(hash_t hash, hash_t parentHash) const {
+    auto it = std::lower_bound(byParent_.begin(), byParent_.end(), parentHash,
+        [this](uint8_t i, hash_t parent) { return records_[i].parentHash < parent; });
+    for (; it != byParent_.end() && records_[*it].parentHash == parentHash; ++it) {
+        if (records_[*it].hash == hash) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const VersionRecord* VersionIndex::FindByContent(const ContentDigest& digest) const {
+    for (const auto& record : records_) {
+        if (record.payload == VersionPayload::Content && record.content == digest) {
+            return &record;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<VersionRecord> VersionIndex::Append(const VersionRecord& record, size_t maxVersions) {
+    records_.push_back(record);
+    std::vector<VersionRecord> evicted;
+    size_t limit = std::min(std::max<size_t>(maxVersions, 1), kMaxRecords);
+    if (records_.size() > limit) {
+        size_t excess = records_.size() - limit;
+        evicted.assign(records_.begin(), records_.begin() + excess);
+        records_.erase(records_.begin(), records_.begin() + excess);
+    }
+    RebuildParentOrder();
+    return evicted;
+}
+
+void VersionIndex::RebuildParentOrder() {
+    byParent_.resize(records_.size());
+    for (size_t i = 0; i < byParent_.size(); ++i) {
+        byParent_[i] = static_cast<uint8_t>(i);
+    }
+    // Insertion sort: no scratch allocation at these sizes, and stable, so equal parents keep
+    // FIFO order and FindByParent returns the oldest match like the old linear scan
+    for (size_t i = 1; i < byParent_.size(); ++i) {
+        uint8_t current = byParent_[i];
+        size_t j = i;
+        while (j > 0 && records_[byParent_[j - 1]].parentHash > records_[current].parentHash) {
+            byParent_[j] = byParent_[j - 1];
+            --j;
+        }
+        byParent_[j] = current;
+    }
+}
@@ -0,0 +1,212 @@
+#include "VersionReclaimer.h"
+#include "MetricsHelper.h"
+#include <algorithm>
+
+namespace {
+    // Backlog summed over every container's reclaimer, published as one gauge
+    std::atomic<int64_t> g_totalBacklog{0};
+}
+
+VersionReclaimer::VersionReclaimer(const VersionReclaimerOptions& options, DeleteBatchFn deleteBatch)
+    : options_(options), deleteBatch_(std::move(deleteBatch)) {
+    options_.batchSize = std::max<size_t>(options_.batchSize, 1);
+    options_.maxAttempts = std::max<size_t>(options_.maxAttempts, 1);
+}
+
+VersionReclaimer::~VersionReclaimer() {
+    Stop();
+}
+
+void VersionReclaimer::Enqueue(const std::vector<std::string>& blobNames) {
+    if (blobNames.empty()) {
+        return;
+    }
+
+    size_t accepted = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            accepted = 0;
+        } else {
+            auto now = Clock::now();
+            size_t room = options_.maxBacklog - std::min(options_.maxBacklog, ready_.size() + retrying_.size());
+            accepted = std::min(room, blobNames.size());
+            for (size_t i = 0; i < accepted; ++i) {
+                ready_.push_back(Pending{blobNames[i], 0, now});
+            }
+            if (!worker_.joinable()) {
+                worker_ = std::thread([this]() { Loop(); });
+            }
+        }
+    }
+    cv_.notify_one();
+
+    AdjustBacklog(static_cast<int64_t>(accepted));
+    if (accepted < blobNames.size()) {
+        size_t dropped = blobNames.size() - accepted;
+        dropped_.fetch_add(dropped, std::memory_order_relaxed);
+        kvstore::MetricsHelper::GetInstance().IncrementCounter("version_gc.dropped", dropped);
+        Log(LogLevel::Error, "[Version GC] Backlog full or stopped - leaving " + std::to_string(dropped) + " version blob(s) orphaned");
+    }
+}
+
+// Ready names first, then retries whose delay has passed
+std::vector<VersionReclaimer::Pending> VersionReclaimer::TakeBatch(Clock::time_point now) {
+    std::vector<Pending> batch;
+    while (!ready_.empty() && batch.size() < options_.batchSize) {
+        batch.push_back(std::move(ready_.front()));
+        ready_.pop_front();
+    }
+    for (auto it = retrying_.begin(); it != retrying_.end() && batch.size() < options_.batchSize;) {
+        if (it->notBefore <= now) {
+            batch.push_back(std::move(*it));
+            it = retrying_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return batch;
+}
+
+void VersionReclaimer::Loop() {
+    auto& metrics = kvstore::MetricsHelper::GetInstance();
+
+    while (true) {
+        std::vector<Pending> batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (true) {
+                auto now = Clock::now();
+                if (stopping_ && now >= stopDeadline_) {
+                    break;
+                }
+                batch = TakeBatch(now);
+                if (!batch.empty()) {
+                    break;
+                }
+                if (stopping_ && ready_.empty()) {
+                    break;   // Retries still waiting are not worth holding up shutdown
+                }
+
+                // Sleep until the earliest retry is due, or until new work arrives
+                auto wakeAt = stopping_ ? stopDeadline_ : Clock::time_point::max();
+                for (const auto& pending : retrying_) {
+                    wakeAt = std::min(wakeAt, pending.notBefore);
+                }
+                if (wakeAt == Clock::time_point::max()) {
+                    cv_.wait(lock);
+                } else {
+                    cv_.wait_until(lock, wakeAt);
+                }
+            }
+            if (batch.empty()) {
+                size_t left = ready_.size() + retrying_.size();
+                ready_.clear();
+                retrying_.clear();
+                lock.unlock();
+                if (left > 0) {
+                    AdjustBacklog(-static_cast<int64_t>(left));
+                    dropped_.fetch_add(left, std::memory_order_relaxed);
+                    metrics.IncrementCounter("version_gc.dropped", left);
+                    Log(LogLevel::Error, "[Version GC] Stopping with " + std::to_string(left) + " version blob(s) not deleted");
+                }
+                return;
+            }
+        }
+
+        std::vector<std::string> names;
+        names.reserve(batch.size());
+        for (const auto& pending : batch) {
+            names.push_back(pending.blobName);
+        }
+
+        auto batchStart = Clock::now();
+        std::vector<bool> results;
+        try {
+            results = deleteBatch_(names);
+        } catch (const std::exception& e) {
+            Log(LogLevel::Error, std::string("[Version GC] Batch delete failed: ") + e.what());
+        }
+        results.resize(batch.size(), false);
+        auto batchEnd = Clock::now();
+        metrics.RecordLatency("version_gc.batch_us",
+            std::chrono::duration_cast<std::chrono::microseconds>(batchEnd - batchStart).count());
+
+        size_t deleted = 0, retried = 0, failed = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (size_t i = 0; i < batch.size(); ++i) {
+                if (results[i]) {
+                    ++deleted;
+                } else if (++batch[i].attempts >= options_.maxAttempts) {
+                    ++failed;
+                    Log(LogLevel::Error, "[Version GC] Giving up on " + batch[i].blobName);
+                } else {
+                    ++retried;
+                    batch[i].notBefore = batchEnd + options_.retryDelay * batch[i].attempts;
+                    retrying_.push_back(std::move(batch[i]));
+                }
+            }
+        }
+
+        AdjustBacklog(-static_cast<int64_t>(deleted + failed));
+        deleted_.fetch_add(deleted, std::memory_order_relaxed);
+        retries_.fetch_add(retried, std::memory_order_relaxed);
+        failed_.fetch_add(failed, std::memory_order_relaxed);
+        metrics.IncrementCounter("version_gc.deleted", deleted);
+        if (retried > 0) {
+            metrics.IncrementCounter("version_gc.retries", retried);
+        }
+        if (failed > 0) {
+            metrics.IncrementCounter("version_gc.failed", failed);
+        }
+
+        // Rate limit: the batch may not finish sooner than its share of deletesPerSecond
+        if (options_.deletesPerSecond > 0) {
+            auto budget = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(batch.size() / options_.deletesPerSecond));
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait_until(lock, batchStart + budget, [this]() { return stopping_; });
+        }
+    }
+}
+
+void VersionReclaimer::Stop(std::chrono::milliseconds timeout) {
+    std::thread worker;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!stopping_) {
+            stopping_ = true;
+            stopDeadline_ = Clock::now() + timeout;
+        }
+        worker.swap(worker_);
+    }
+    cv_.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+VersionReclaimerStats VersionReclaimer::GetStats() const {
+    VersionReclaimerStats stats;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.backlog = ready_.size() + retrying_.size();
+    }
+    stats.deleted = deleted_.load(std::memory_order_relaxed);
+    stats.retries = retries_.load(std::memory_order_relaxed);
+    stats.failed = failed_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void VersionReclaimer::AdjustBacklog(int64_t delta) {
+    int64_t total = g_totalBacklog.fetch_add(delta, std::memory_order_relaxed) + delta;
+    kvstore::MetricsHelper::GetInstance().SetGauge("version_gc.backlog", total);
+}
+
+void VersionReclaimer::Log(LogLevel level, const std::string& message) const {
+    if (logCallback_) {
+        logCallback_(level, message);
+    }
+}
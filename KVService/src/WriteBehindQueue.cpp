@@ -0,0 +1,532 @@
+#include "WriteBehindQueue.h"
+#include "MetricsHelper.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <system_error>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    constexpr char kJournalMagic[4] = {'K', 'V', 'W', '2'};      // Chunks carry their payload encoding
+    constexpr char kRawJournalMagic[4] = {'K', 'V', 'W', 'B'};   // Older journals: raw payloads
+    constexpr const char* kJournalExtension = ".wbj";
+
+    // Journal files never leave this machine, so values use host byte order
+    void WriteU64(std::ostream& out, uint64_t value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void WriteString(std::ostream& out, const std::string& value) {
+        WriteU64(out, value.size());
+        out.write(value.data(), static_cast<std::streamsize>(value.size()));
+    }
+
+    bool ReadU64(std::istream& in, uint64_t& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+
+    bool ReadString(std::istream& in, std::string& value, uint64_t maxSize) {
+        uint64_t size = 0;
+        if (!ReadU64(in, size) || size > maxSize) {
+            return false;
+        }
+        value.resize(static_cast<size_t>(size));
+        return size == 0 || static_cast<bool>(in.read(&value[0], static_cast<std::streamsize>(size)));
+    }
+
+    // ofstream::flush only reaches the OS cache; a LocalCache write is acknowledged once its
+    // journal is on disk. Directories can only be synced this way on POSIX, where it makes the
+    // rename durable; on Windows they are skipped.
+    bool SyncToDisk(const std::filesystem::path& path, bool directory) {
+#ifdef _WIN32
+        if (directory) {
+            return true;
+        }
+        int fd = _wopen(path.c_str(), _O_RDWR | _O_BINARY);
+        if (fd < 0) {
+            return false;
+        }
+        bool ok = _commit(fd) == 0;
+        _close(fd);
+        return ok;
+#else
+        int fd = ::open(path.c_str(), directory ? O_RDONLY | O_DIRECTORY : O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        bool ok = ::fsync(fd) == 0;
+        ::close(fd);
+        return ok;
+#endif
+    }
+}
+
+WriteBehindQueue::WriteBehindQueue(const WriteBehindOptions& options, StoreResolver resolver)
+    : options_(options), resolver_(std::move(resolver)) {
+    options_.flushThreads = std::max<size_t>(options_.flushThreads, 1);
+    options_.maxAttempts = std::max<size_t>(options_.maxAttempts, 1);
+}
+
+WriteBehindQueue::~WriteBehindQueue() {
+    Drain();
+}
+
+bool WriteBehindQueue::Initialize() {
+    if (!Enabled()) {
+        return true;
+    }
+
+    if (Journaled()) {
+        std::error_code ec;
+        std::filesystem::create_directories(options_.journalPath, ec);
+        if (ec) {
+            Log(LogLevel::Error, "[Write-Behind] Failed to create journal " + options_.journalPath + ": " + ec.message());
+            return false;
+        }
+        ReplayJournal();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    accepting_ = true;
+    for (size_t i = 0; i < options_.flushThreads; ++i) {
+        workers_.emplace_back([this]() { FlushLoop(); });
+    }
+    return true;
+}
+
+uint64_t WriteBehindQueue::PayloadBytes(const std::vector<PromptChunk>& chunks) {
+    uint64_t bytes = 0;
+    for (const auto& chunk : chunks) {
+        bytes += chunk.buffer.size();
+    }
+    return bytes;
+}
+
+bool WriteBehindQueue::Enqueue(std::shared_ptr<IKVStoreEngine> store,
+                               const std::string& resourceName,
+                               const std::string& containerName,
+                               std::vector<PromptChunk>& chunks,
+                               WriteDurability durability) {
+    if (durability == WriteDurability::Storage || !Enabled() || chunks.empty()) {
+        return false;
+    }
+    if (durability == WriteDurability::LocalCache && !Journaled()) {
+        return false;
+    }
+
+    Entry entry;
+    entry.store = std::move(store);
+    entry.resourceName = resourceName;
+    entry.containerName = containerName;
+    entry.bytes = PayloadBytes(chunks);
+
+    // Reserve the bytes first so concurrent journal writes cannot overshoot the budget
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!accepting_) {
+            return false;
+        }
+        if (queuedBytes_ + entry.bytes > options_.maxQueuedBytes) {
+            overflows_.fetch_add(1, std::memory_order_relaxed);
+            kvstore::MetricsHelper::GetInstance().IncrementCounter("write_behind.overflows");
+            return false;
+        }
+        queuedBytes_ += entry.bytes;
+        ++pendingEnqueues_;
+    }
+
+    entry.chunks = std::move(chunks);
+    if (durability == WriteDurability::LocalCache && !WriteJournal(entry, entry.journalFile)) {
+        chunks = std::move(entry.chunks);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queuedBytes_ -= entry.bytes;
+            --pendingEnqueues_;
+        }
+        idleCv_.notify_all();
+        return false;
+    }
+
+    size_t blocks = entry.chunks.size();
+    entry.enqueuedAt = Clock::now();
+    size_t depth = 0;
+    uint64_t bytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(entry));
+        --pendingEnqueues_;
+        depth = queue_.size();
+        bytes = queuedBytes_;
+    }
+    workCv_.notify_one();
+    kvstore::MetricsHelper::GetInstance().IncrementCounter("write_behind.enqueued_blocks", blocks);
+    PublishDepth(depth, bytes);
+    return true;
+}
+
+void WriteBehindQueue::FlushLoop() {
+    while (true) {
+        Entry entry;
+        size_t depth = 0;
+        uint64_t bytes = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (true) {
+                if (stopping_) {
+                    return;   // Drain has taken over whatever is left
+                }
+                if (!queue_.empty()) {
+                    entry = std::move(queue_.front());
+                    queue_.pop_front();
+                    break;
+                }
+                // New entries first, then retries whose delay has passed
+                auto now = Clock::now();
+                auto due = std::find_if(retrying_.begin(), retrying_.end(),
+                    [now](const Entry& pending) { return pending.notBefore <= now; });
+                if (due != retrying_.end()) {
+                    entry = std::move(*due);
+                    retrying_.erase(due);
+                    break;
+                }
+                if (retrying_.empty()) {
+                    workCv_.wait(lock);
+                } else {
+                    auto wakeAt = std::min_element(retrying_.begin(), retrying_.end(),
+                        [](const Entry& a, const Entry& b) { return a.notBefore < b.notBefore; })->notBefore;
+                    workCv_.wait_until(lock, wakeAt);
+                }
+            }
+            ++inFlight_;
+            depth = queue_.size() + retrying_.size();
+            bytes = queuedBytes_;
+        }
+        PublishDepth(depth, bytes);
+
+        uint64_t entryBytes = entry.bytes;
+        bool retry = Flush(entry);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --inFlight_;
+            if (retry) {
+                queuedBytes_ -= entryBytes - entry.bytes;   // Blocks stored by this attempt
+                retrying_.push_back(std::move(entry));
+            } else {
+                queuedBytes_ -= entryBytes;
+            }
+            depth = queue_.size() + retrying_.size();
+            bytes = queuedBytes_;
+        }
+        if (retry) {
+            workCv_.notify_all();   // Idle threads may be waiting past the new retry's deadline
+        }
+        idleCv_.notify_all();
+        PublishDepth(depth, bytes);
+    }
+}
+
+// Blocks of a chain are independent blobs, so only the failed ones are retried.
+// An exception or a storage error may clear up; a permanent error would fail the same way on
+// replay, so that block is dropped.
+bool WriteBehindQueue::Flush(Entry& entry) {
+    auto& metrics = kvstore::MetricsHelper::GetInstance();
+    ++entry.attempts;
+
+    // Unjournaled payloads live only in the entry, so it keeps a copy while a retry is possible;
+    // journaled entries retry until stored
+    bool canRetry = !entry.journalFile.empty() || entry.attempts < options_.maxAttempts;
+    std::vector<PromptChunk> batch = canRetry ? entry.chunks : std::move(entry.chunks);
+    size_t blocks = batch.size();
+
+    std::vector<BlockWriteStatus> statuses;
+    try {
+        statuses = entry.store->WriteBatchAsync(std::move(batch)).get();
+    } catch (const std::exception& e) {
+        Log(LogLevel::Error, "[Write-Behind] Upload attempt " + std::to_string(entry.attempts) + " failed: " + e.what());
+    }
+    statuses.resize(blocks);   // Blocks without a status (the attempt threw) failed transiently
+
+    size_t flushed = 0;
+    size_t dropped = 0;
+    std::vector<PromptChunk> failed;
+    for (size_t i = 0; i < blocks; ++i) {
+        if (statuses[i].success) {
+            ++flushed;
+        } else if (statuses[i].permanent || !canRetry) {
+            ++dropped;
+            if (statuses[i].permanent) {
+                Log(LogLevel::Error, "[Write-Behind] Dropping block " + std::to_string(statuses[i].hash) + ": " + statuses[i].error);
+            }
+        } else {
+            failed.push_back(std::move(entry.chunks[i]));
+        }
+    }
+
+    flushedBlocks_.fetch_add(flushed, std::memory_order_relaxed);
+    metrics.IncrementCounter("write_behind.flushed_blocks", flushed);
+    if (dropped > 0) {
+        droppedBlocks_.fetch_add(dropped, std::memory_order_relaxed);
+        metrics.IncrementCounter("write_behind.dropped_blocks", dropped);
+        Log(LogLevel::Error, "[Write-Behind] Dropped " + std::to_string(dropped) + " block(s) for " +
+            entry.resourceName + "/" + entry.containerName + " after " + std::to_string(entry.attempts) + " attempt(s)");
+    }
+
+    if (!failed.empty()) {
+        std::chrono::milliseconds delay = options_.retryDelay * (int64_t{1} << std::min<size_t>(entry.attempts - 1, 16));
+        delay = std::min(delay, options_.maxRetryDelay);
+        entry.chunks = std::move(failed);
+        entry.bytes = PayloadBytes(entry.chunks);
+        entry.notBefore = Clock::now() + delay;
+        retries_.fetch_add(1, std::memory_order_relaxed);
+        metrics.IncrementCounter("write_behind.retries");
+        Log(LogLevel::Error, "[Write-Behind] Retrying " + std::to_string(entry.chunks.size()) + " block(s) for " +
+            entry.resourceName + "/" + entry.containerName + " in " + std::to_string(delay.count()) + "ms");
+        return true;
+    }
+
+    // Nothing left to replay; the journal may still list blocks that were stored or dropped
+    if (!entry.journalFile.empty()) {
+        std::error_code ec;
+        std::filesystem::remove(entry.journalFile, ec);
+    }
+
+    auto lagUs = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - entry.enqueuedAt).count();
+    metrics.RecordLatency("write_behind.flush_lag_us", lagUs);
+    return false;
+}
+
+void WriteBehindQueue::Drain() {
+    std::vector<std::thread> workers;
+    std::deque<Entry> leftovers;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (stopping_ || workers_.empty()) {
+            accepting_ = false;
+            return;
+        }
+        accepting_ = false;
+        size_t queued = queue_.size() + retrying_.size() + inFlight_;
+        if (queued > 0) {
+            Log(LogLevel::Information, "[Write-Behind] Draining " + std::to_string(queued) + " queued write(s)...");
+        }
+        idleCv_.wait_for(lock, options_.drainTimeout, [this]() {
+            return queue_.empty() && retrying_.empty() && inFlight_ == 0 && pendingEnqueues_ == 0;
+        });
+        stopping_ = true;
+        leftovers.swap(queue_);
+        for (auto& entry : retrying_) {
+            leftovers.push_back(std::move(entry));
+        }
+        retrying_.clear();
+        workers.swap(workers_);
+    }
+    workCv_.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    size_t dropped = 0;
+    size_t kept = 0;
+    for (const auto& entry : leftovers) {
+        if (entry.journalFile.empty()) {
+            dropped += entry.chunks.size();
+        } else {
+            kept += entry.chunks.size();
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queuedBytes_ = 0;
+    }
+    PublishDepth(0, 0);
+    if (dropped > 0) {
+        droppedBlocks_.fetch_add(dropped, std::memory_order_relaxed);
+        kvstore::MetricsHelper::GetInstance().IncrementCounter("write_behind.dropped_blocks", dropped);
+        Log(LogLevel::Error, "[Write-Behind] Drain timed out - dropped " + std::to_string(dropped) + " unjournaled block(s)");
+    }
+    if (kept > 0) {
+        Log(LogLevel::Information, "[Write-Behind] Drain timed out - " + std::to_string(kept) +
+            " journaled block(s) will be replayed at the next start");
+    }
+}
+
+WriteBehindStats WriteBehindQueue::GetStats() const {
+    WriteBehindStats stats;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.queuedEntries = queue_.size() + retrying_.size() + inFlight_;
+        stats.queuedBytes = queuedBytes_;
+    }
+    stats.flushedBlocks = flushedBlocks_.load(std::memory_order_relaxed);
+    stats.retries = retries_.load(std::memory_order_relaxed);
+    stats.droppedBlocks = droppedBlocks_.load(std::memory_order_relaxed);
+    stats.overflows = overflows_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void WriteBehindQueue::PublishDepth(size_t entries, uint64_t bytes) const {
+    auto& metrics = kvstore::MetricsHelper::GetInstance();
+    metrics.SetGauge("write_behind.queue_depth", static_cast<int64_t>(entries));
+    metrics.SetGauge("write_behind.queue_bytes", static_cast<int64_t>(bytes));
+}
+
+// Layout: "KVW2", resource, container, chunk count, then per chunk:
+// hash, parentHash, partitionKey, completionId, token count, tokens, codec, shuffle, raw size, payload
+// ("KVWB" journals from older versions have no codec fields and raw payloads)
+bool WriteBehindQueue::WriteJournal(const Entry& entry, std::filesystem::path& file) {
+    std::stringstream name;
+    name << std::hex << std::setfill('0') << std::setw(16) << nextJournalSeq_.fetch_add(1) << kJournalExtension;
+    file = std::filesystem::path(options_.journalPath) / name.str();
+    auto temp = file;
+    temp += ".tmp";
+
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (out) {
+            out.write(kJournalMagic, sizeof(kJournalMagic));
+            WriteString(out, entry.resourceName);
+            WriteString(out, entry.containerName);
+            WriteU64(out, entry.chunks.size());
+            for (const auto& chunk : entry.chunks) {
+                WriteU64(out, chunk.hash);
+                WriteU64(out, chunk.parentHash);
+                WriteString(out, chunk.partitionKey);
+                WriteString(out, chunk.completionId);
+                WriteU64(out, chunk.tokens.size());
+                out.write(reinterpret_cast<const char*>(chunk.tokens.data()),
+                          static_cast<std::streamsize>(chunk.tokens.size() * sizeof(Token)));
+                WriteU64(out, static_cast<uint64_t>(chunk.encoding.codec));
+                WriteU64(out, chunk.encoding.shuffle);
+                WriteU64(out, chunk.encoding.rawSize);
+                WriteString(out, chunk.buffer);
+            }
+            out.close();
+        }
+        if (!out || !SyncToDisk(temp, false)) {
+            std::error_code ec;
+            std::filesystem::remove(temp, ec);
+            Log(LogLevel::Error, "[Write-Behind] Failed to write journal " + file.string());
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp, file, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        Log(LogLevel::Error, "[Write-Behind] Failed to publish journal " + file.string() + ": " + ec.message());
+        return false;
+    }
+    if (!SyncToDisk(options_.journalPath, true)) {
+        std::filesystem::remove(file, ec);
+        Log(LogLevel::Error, "[Write-Behind] Failed to sync journal directory " + options_.journalPath);
+        return false;
+    }
+    return true;
+}
+
+bool WriteBehindQueue::ReadJournal(const std::filesystem::path& file, Entry& entry) const {
+    std::ifstream in(file, std::ios::binary);
+    char magic[4] = {};
+    uint64_t count = 0;
+    if (!in.read(magic, sizeof(magic)) ||
+        (std::memcmp(magic, kJournalMagic, sizeof(magic)) != 0 && std::memcmp(magic, kRawJournalMagic, sizeof(magic)) != 0) ||
+        !ReadString(in, entry.resourceName, 4096) || !ReadString(in, entry.containerName, 4096) ||
+        !ReadU64(in, count) || count > (1u << 16)) {
+        return false;
+    }
+
+    bool encoded = std::memcmp(magic, kJournalMagic, sizeof(magic)) == 0;
+    entry.chunks.resize(static_cast<size_t>(count));
+    for (auto& chunk : entry.chunks) {
+        uint64_t tokenCount = 0;
+        if (!ReadU64(in, chunk.hash) || !ReadU64(in, chunk.parentHash) ||
+            !ReadString(in, chunk.partitionKey, 1u << 20) || !ReadString(in, chunk.completionId, 1u << 20) ||
+            !ReadU64(in, tokenCount) || tokenCount > (1u << 24)) {
+            return false;
+        }
+        chunk.tokens.resize(static_cast<size_t>(tokenCount));
+        if (tokenCount > 0 && !in.read(reinterpret_cast<char*>(chunk.tokens.data()),
+                                       static_cast<std::streamsize>(tokenCount * sizeof(Token)))) {
+            return false;
+        }
+        if (encoded) {
+            uint64_t codec = 0, shuffle = 0;
+            if (!ReadU64(in, codec) || !ReadU64(in, shuffle) || !ReadU64(in, chunk.encoding.rawSize) ||
+                codec > 255 || shuffle > payload::kMaxShuffle) {
+                return false;
+            }
+            chunk.encoding.codec = static_cast<payload::Codec>(codec);
+            chunk.encoding.shuffle = static_cast<uint8_t>(shuffle);
+        }
+        if (!ReadString(in, chunk.buffer, 1ull << 30)) {
+            return false;
+        }
+        chunk.bufferSize = chunk.buffer.size();
+    }
+    entry.bytes = PayloadBytes(entry.chunks);
+    return true;
+}
+
+// Called before the flush threads start; replayed entries may exceed the byte budget
+void WriteBehindQueue::ReplayJournal() {
+    std::error_code ec;
+    std::vector<std::filesystem::path> files;
+    for (const auto& dirEntry : std::filesystem::directory_iterator(options_.journalPath, ec)) {
+        const auto& path = dirEntry.path();
+        if (path.extension() == ".tmp") {
+            std::filesystem::remove(path, ec);
+        } else if (path.extension() == kJournalExtension) {
+            files.push_back(path);
+        }
+    }
+    // Fixed-width hex sequence numbers sort in write order
+    std::sort(files.begin(), files.end());
+
+    size_t replayedBlocks = 0;
+    uint64_t maxSeq = 0;
+    for (const auto& file : files) {
+        uint64_t seq = std::strtoull(file.stem().string().c_str(), nullptr, 16);
+        maxSeq = std::max(maxSeq, seq + 1);
+
+        Entry entry;
+        if (!ReadJournal(file, entry)) {
+            Log(LogLevel::Error, "[Write-Behind] Discarding corrupt journal " + file.string());
+            std::filesystem::remove(file, ec);
+            continue;
+        }
+        entry.store = resolver_ ? resolver_(entry.resourceName, entry.containerName) : nullptr;
+        if (!entry.store) {
+            Log(LogLevel::Error, "[Write-Behind] No store for " + entry.resourceName + "/" + entry.containerName +
+                " - keeping journal " + file.string());
+            continue;
+        }
+        entry.journalFile = file;
+        entry.enqueuedAt = Clock::now();
+        replayedBlocks += entry.chunks.size();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        queuedBytes_ += entry.bytes;
+        queue_.push_back(std::move(entry));
+    }
+    nextJournalSeq_.store(maxSeq);
+
+    if (replayedBlocks > 0) {
+        Log(LogLevel::Information, "[Write-Behind] Replaying " + std::to_string(replayedBlocks) + " journaled block(s)");
+    }
+}
+
+void WriteBehindQueue::Log(LogLevel level, const std::string& message) const {
+    if (logCallback_) {
+        logCallback_(level, message);
+    }
+}
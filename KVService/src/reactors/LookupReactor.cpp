@@ -1,8 +1,18 @@
 #include "LookupReactor.h"
-#include <thread>
 
 namespace kvstore {
 
+// Wire enum -> storage engine enum
+static ::ProbeStrategy ToEngineProbeStrategy(ProbeStrategy strategy) {
+    switch (strategy) {
+    case PROBE_STRATEGY_PARALLEL: return ::ProbeStrategy::Parallel;
+    case PROBE_STRATEGY_WAVES: return ::ProbeStrategy::Waves;
+    case PROBE_STRATEGY_GALLOPING: return ::ProbeStrategy::Galloping;
+    case PROBE_STRATEGY_BINARY: return ::ProbeStrategy::Binary;
+    default: return ::ProbeStrategy::Default;
+    }
+}
+
 LookupReactor::LookupReactor(KVStoreServiceImpl* service,
                              grpc::CallbackServerContext* context,
                              const LookupRequest* request,
@@ -59,9 +69,8 @@ void LookupReactor::StartProcessing() {
         return;
     }
     
-    // Execute async storage operation in thread pool
-    // This prevents blocking the gRPC event loop
-    std::thread([this, store]() {
+    // Run the storage operation on the request executor so it never blocks the gRPC event loop
+    bool scheduled = ScheduleRequest([this, store](int64_t queue_wait_us) {
         try {
             auto storage_start = std::chrono::high_resolution_clock::now();
             
@@ -87,7 +96,8 @@ void LookupReactor::StartProcessing() {
                 request_->completion_id(),
                 tokens.begin(),
                 tokens.end(),
-                precomputedHashes
+                precomputedHashes,
+                ToEngineProbeStrategy(request_->probe_strategy())
             );
             
             auto storage_end = std::chrono::high_resolution_clock::now();
@@ -111,7 +121,11 @@ void LookupReactor::StartProcessing() {
             auto* metrics = response_->mutable_server_metrics();
             metrics->set_storage_latency_us(storage_us);
             metrics->set_total_latency_us(total_us);
-            metrics->set_overhead_us(total_us - storage_us);
+            metrics->set_overhead_us(total_us - storage_us - queue_wait_us);
+            metrics->set_queue_wait_us(queue_wait_us);
+            SetIoQueueMetrics(metrics);
+            metrics->set_probes_issued(result.probesIssued);
+            metrics->set_probes_wasted(result.probesWasted);
             
             LogMetric("Lookup", request_id_, storage_us, total_us, 0, true);
             
@@ -131,7 +145,21 @@ void LookupReactor::StartProcessing() {
             LogMetric("Lookup", request_id_, 0, total_us, 0, false, e.what());
             Finish(grpc::Status(grpc::StatusCode::INTERNAL, e.what()));
         }
-    }).detach();
+    }, GetRequestPriority(context_, RequestPriority::High));
+    if (!scheduled) {
+        response_->set_success(false);
+        response_->set_error("Server busy: request queue is full");
+        auto rpc_end = std::chrono::high_resolution_clock::now();
+        auto total_us = std::chrono::duration_cast<std::chrono::microseconds>(rpc_end - rpc_start_).count();
+        
+        auto* metrics = response_->mutable_server_metrics();
+        metrics->set_storage_latency_us(0);
+        metrics->set_total_latency_us(total_us);
+        metrics->set_overhead_us(total_us);
+        
+        LogMetric("Lookup", request_id_, 0, total_us, 0, false, "Request queue full");
+        Finish(grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED, "Server busy: request queue is full"));
+    }
 }
 
 } // namespace kvstore
@@ -1,7 +1,13 @@
 #include "ReactorCommon.h"
+#include "KVStoreServiceImpl.h"
 #include "MetricsHelper.h"
+#include "RequestExecutor.h"
+#include "StorageIoExecutor.h"
+#include "kvstore.pb.h"
+#include <algorithm>
 #include <iostream>
 #include <chrono>
+#include <stdexcept>
 
 namespace kvstore {
 
@@ -48,4 +54,122 @@ void LogMetric(const std::string& method, const std::string& request_id,
     }
 }
 
+const char* const kPriorityMetadataKey = "x-kvstore-priority";
+
+RequestPriority GetRequestPriority(grpc::CallbackServerContext* context, RequestPriority methodDefault) {
+    RequestPriority priority = methodDefault;
+    const auto& metadata = context->client_metadata();
+    auto it = metadata.find(kPriorityMetadataKey);
+    if (it != metadata.end() &&
+        !ParseRequestPriority(std::string(it->second.data(), it->second.length()), priority)) {
+        MetricsHelper::GetInstance().IncrementCounter("request_priority.invalid_metadata");
+    }
+    return priority;
+}
+
+bool ScheduleRequest(std::function<void(int64_t queueWaitUs)> task, RequestPriority priority) {
+    auto queued_at = std::chrono::steady_clock::now();
+    return RequestExecutor::GetInstance().TrySubmit([task = std::move(task), queued_at]() {
+        task(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - queued_at).count());
+    }, priority);
+}
+
+void SetIoQueueMetrics(ServerMetrics* metrics) {
+    auto stats = StorageIoExecutor::GetInstance().GetStats();
+    metrics->set_io_queue_depth(static_cast<int64_t>(stats.queueDepth));
+    metrics->set_io_queue_wait_us(stats.recentQueueWaitUs);
+}
+
+void SetBytesCopied(ServerMetrics* metrics, size_t bytesCopied) {
+    metrics->set_bytes_copied(static_cast<int64_t>(bytesCopied));
+    MetricsHelper::GetInstance().IncrementCounter("read.bytes_copied", bytesCopied);
+}
+
+// PayloadCodec values match payload::Codec; unknown ones come through as unsupported codecs
+payload::Encoding GetPayloadEncoding(const PromptChunk& protoChunk) {
+    payload::Encoding encoding;
+    encoding.codec = static_cast<payload::Codec>(protoChunk.codec());
+    encoding.shuffle = static_cast<uint8_t>(std::min<uint32_t>(protoChunk.shuffle(), 255));
+    encoding.rawSize = protoChunk.raw_size();
+    return encoding;
+}
+
+void SetPayloadEncoding(PromptChunk* protoChunk, const payload::Encoding& encoding) {
+    if (encoding.IsRaw()) {
+        return;
+    }
+    protoChunk->set_codec(static_cast<PayloadCodec>(encoding.codec));
+    protoChunk->set_shuffle(encoding.shuffle);
+    protoChunk->set_raw_size(encoding.rawSize);
+}
+
+bool EncodeForStorage(KVStoreServiceImpl* service, const std::string& containerName,
+                      ::PromptChunk& chunk, std::string& error) {
+    auto& metrics = MetricsHelper::GetInstance();
+    if (!chunk.encoding.IsRaw()) {
+        if (!payload::IsSupported(chunk.encoding.codec) || chunk.encoding.rawSize > payload::kMaxRawSize) {
+            error = "Unsupported payload encoding";
+            return false;
+        }
+        ChunkBuffer raw(static_cast<size_t>(chunk.encoding.rawSize), '\0');
+        if (!payload::Decode(ChunkData(chunk.buffer), chunk.buffer.size(), chunk.encoding, reinterpret_cast<uint8_t*>(&raw[0]))) {
+            error = "Compressed payload does not decode";
+            return false;
+        }
+        metrics.IncrementCounter("payload.raw_bytes", static_cast<int64_t>(chunk.encoding.rawSize));
+        metrics.IncrementCounter("payload.stored_bytes", static_cast<int64_t>(chunk.buffer.size()));
+        return true;
+    }
+
+    size_t rawSize = chunk.buffer.size();
+    std::string encoded;
+    auto encoding = payload::Encode(ChunkData(chunk.buffer), rawSize, service->GetPayloadOptions(containerName), encoded);
+    if (!encoding.IsRaw()) {
+        chunk.buffer = std::move(encoded);
+        chunk.bufferSize = chunk.buffer.size();
+        chunk.encoding = encoding;
+    }
+    metrics.IncrementCounter("payload.raw_bytes", static_cast<int64_t>(rawSize));
+    metrics.IncrementCounter("payload.stored_bytes", static_cast<int64_t>(chunk.buffer.size()));
+    return true;
+}
+
+void EncodeForWire(::PromptChunk& chunk, const google::protobuf::RepeatedField<int>& acceptedCodecs) {
+    if (chunk.encoding.IsRaw() ||
+        std::find(acceptedCodecs.begin(), acceptedCodecs.end(), static_cast<int>(chunk.encoding.codec)) != acceptedCodecs.end()) {
+        return;
+    }
+
+    ChunkBuffer raw(static_cast<size_t>(std::min(chunk.encoding.rawSize, payload::kMaxRawSize)), '\0');
+    if (!payload::Decode(ChunkData(chunk.buffer), chunk.buffer.size(), chunk.encoding, reinterpret_cast<uint8_t*>(&raw[0]))) {
+        throw std::runtime_error(std::string("Stored payload does not decode (") + payload::CodecName(chunk.encoding.codec) + ")");
+    }
+    chunk.buffer = std::move(raw);
+    chunk.bufferSize = chunk.buffer.size();
+    chunk.bytesCopied += chunk.buffer.size();
+    chunk.encoding = payload::Encoding();
+    MetricsHelper::GetInstance().IncrementCounter("payload.wire_decodes");
+}
+
+WriteDurability TryWriteBehind(KVStoreServiceImpl* service,
+                               std::shared_ptr<IKVStoreEngine> store,
+                               const std::string& resourceName,
+                               const std::string& containerName,
+                               std::vector<::PromptChunk>& chunks,
+                               WriteDurability requested) {
+    auto* queue = service->GetWriteBehindQueue();
+    // Unknown levels from newer clients get the safe default
+    if (!queue || (requested != WRITE_DURABILITY_LOCAL_CACHE && requested != WRITE_DURABILITY_RECEIPT)) {
+        return WRITE_DURABILITY_STORAGE;
+    }
+
+    ::WriteDurability durability = requested == WRITE_DURABILITY_LOCAL_CACHE
+        ? ::WriteDurability::LocalCache
+        : ::WriteDurability::Receipt;
+    if (!queue->Enqueue(std::move(store), resourceName, containerName, chunks, durability)) {
+        return WRITE_DURABILITY_STORAGE;
+    }
+    return requested;
+}
+
 } // namespace kvstore
@@ -1,12 +1,20 @@
 #pragma once
 
+#include <grpcpp/grpcpp.h>
+#include "kvstore.pb.h"
+#include "IKVStoreEngine.h"
+#include "RequestPriority.h"
 #include <string>
 #include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
 
 namespace kvstore {
 
 // Forward declarations
 class KVStoreServiceImpl;
+class ServerMetrics;
 
 // Global flags to control metrics logging (defined in ReactorCommon.cpp)
 extern bool g_enableMetricsLogging;
@@ -18,4 +26,45 @@ void LogMetric(const std::string& method, const std::string& request_id,
                int64_t e2e_latency_us,
                bool success, const std::string& error = "");
 
+// Client metadata key that overrides a request's priority class ("high", "normal", "low")
+extern const char* const kPriorityMetadataKey;
+
+// Priority class of a request: the client's x-kvstore-priority if valid, else the method default
+// (Lookup High, Read/StreamingRead Normal, Write/WriteBatch Low)
+RequestPriority GetRequestPriority(grpc::CallbackServerContext* context, RequestPriority methodDefault);
+
+// Run a reactor's blocking work on the shared RequestExecutor at the given class; the task
+// receives the time it waited in the queue. False if the executor is saturated, in which case
+// the task never runs.
+bool ScheduleRequest(std::function<void(int64_t queueWaitUs)> task, RequestPriority priority);
+
+// Fill the storage I/O executor fields (queue depth, recent queue wait) of a response
+void SetIoQueueMetrics(ServerMetrics* metrics);
+
+// Report payload bytes copied in memory while serving a read (per response and as read.bytes_copied)
+void SetBytesCopied(ServerMetrics* metrics, size_t bytesCopied);
+
+// Payload encoding carried by a protobuf chunk, and the reverse
+payload::Encoding GetPayloadEncoding(const PromptChunk& protoChunk);
+void SetPayloadEncoding(PromptChunk* protoChunk, const payload::Encoding& encoding);
+
+// Compress a raw chunk received from a client with its container's codec. A payload the client
+// already compressed is stored as sent once it is known to decode; false (with error set) if not.
+bool EncodeForStorage(KVStoreServiceImpl* service, const std::string& containerName,
+                      ::PromptChunk& chunk, std::string& error);
+
+// Decode a chunk read from storage unless the client accepts its codec. Throws if the stored
+// payload does not decode.
+void EncodeForWire(::PromptChunk& chunk, const google::protobuf::RepeatedField<int>& acceptedCodecs);
+
+// Queue a converted chain on the service's write-behind queue if the request allows an early ack.
+// Returns the durability achieved; STORAGE means nothing was queued (chunks are untouched)
+// and the caller must write synchronously.
+WriteDurability TryWriteBehind(KVStoreServiceImpl* service,
+                               std::shared_ptr<IKVStoreEngine> store,
+                               const std::string& resourceName,
+                               const std::string& containerName,
+                               std::vector<::PromptChunk>& chunks,
+                               WriteDurability requested);
+
 } // namespace kvstore
@@ -1,5 +1,4 @@
 #include "ReadReactor.h"
-#include <thread>
 
 namespace kvstore {
 
@@ -55,7 +54,7 @@ void ReadReactor::StartProcessing() {
         return;
     }
     
-    std::thread([this, store]() {
+    bool scheduled = ScheduleRequest([this, store](int64_t queue_wait_us) {
         try {
             auto storage_start = std::chrono::high_resolution_clock::now();
             
@@ -68,12 +67,14 @@ void ReadReactor::StartProcessing() {
             response_->set_found(found);
             
             if (found) {
+                EncodeForWire(chunk, request_->accept_codecs());
                 auto* protoChunk = response_->mutable_chunk();
                 protoChunk->set_hash(chunk.hash);
                 protoChunk->set_partition_key(chunk.partitionKey);
                 protoChunk->set_parent_hash(chunk.parentHash);
                 protoChunk->set_completion_id(chunk.completionId);
-                protoChunk->set_buffer(chunk.buffer.data(), chunk.buffer.size());
+                protoChunk->set_buffer(std::move(chunk.buffer));  // Takes ownership, no copy
+                SetPayloadEncoding(protoChunk, chunk.encoding);
                 
                 for (auto token : chunk.tokens) {
                     protoChunk->add_tokens(static_cast<int64_t>(token));
@@ -87,7 +88,10 @@ void ReadReactor::StartProcessing() {
             auto* metrics = response_->mutable_server_metrics();
             metrics->set_storage_latency_us(storage_us);
             metrics->set_total_latency_us(total_us);
-            metrics->set_overhead_us(total_us - storage_us);
+            metrics->set_overhead_us(total_us - storage_us - queue_wait_us);
+            metrics->set_queue_wait_us(queue_wait_us);
+            SetIoQueueMetrics(metrics);
+            SetBytesCopied(metrics, chunk.bytesCopied);
             
             LogMetric("Read", request_id_, storage_us, total_us, 0, true);
             
@@ -107,7 +111,21 @@ void ReadReactor::StartProcessing() {
             LogMetric("Read", request_id_, 0, total_us, 0, false, e.what());
             Finish(grpc::Status(grpc::StatusCode::INTERNAL, e.what()));
         }
-    }).detach();
+    }, GetRequestPriority(context_, RequestPriority::Normal));
+    if (!scheduled) {
+        response_->set_success(false);
+        response_->set_error("Server busy: request queue is full");
+        auto rpc_end = std::chrono::high_resolution_clock::now();
+        auto total_us = std::chrono::duration_cast<std::chrono::microseconds>(rpc_end - rpc_start_).count();
+        
+        auto* metrics = response_->mutable_server_metrics();
+        metrics->set_storage_latency_us(0);
+        metrics->set_total_latency_us(total_us);
+        metrics->set_overhead_us(total_us);
+        
+        LogMetric("Read", request_id_, 0, total_us, 0, false, "Request queue full");
+        Finish(grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED, "Server busy: request queue is full"));
+    }
 }
 
 } // namespace kvstore
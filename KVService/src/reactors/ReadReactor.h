@@ -4,7 +4,6 @@
 #include "KVStoreServiceImpl.h"
 #include "ReactorCommon.h"
 #include <chrono>
-#include <thread>
 
 namespace kvstore {
 
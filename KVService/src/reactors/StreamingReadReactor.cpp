@@ -1,10 +1,11 @@
 #include "StreamingReadReactor.h"
-#include <thread>
+#include "MetricsHelper.h"
 
 namespace kvstore {
 
 StreamingReadReactor::StreamingReadReactor(KVStoreServiceImpl* service, grpc::CallbackServerContext* context)
-    : service_(service), context_(context) {
+    : service_(service), context_(context),
+      priority_(GetRequestPriority(context, RequestPriority::Normal)) {
     
     stream_start_ = std::chrono::high_resolution_clock::now();
     
@@ -12,73 +13,77 @@ StreamingReadReactor::StreamingReadReactor(KVStoreServiceImpl* service, grpc::Ca
     StartRead(&current_request_);
 }
 
+StreamingReadReactor::~StreamingReadReactor() {
+    // Responses never written (failed write or cancelled stream) leave the budget here
+    size_t unsent = buffered_bytes_.load();
+    if (unsent > 0) {
+        service_->ReleaseResponseBytes(unsent);
+    }
+}
+
 void StreamingReadReactor::OnReadDone(bool ok) {
     if (!ok) {
-        // Client finished sending requests
-        // Wait for all pending writes to complete, then finish
-        std::unique_lock<std::mutex> lock(mutex_);
-        client_done_ = true;
-        if (pending_writes_ == 0 && active_threads_ == 0) {
-            lock.unlock();
-            Finish(grpc::Status::OK);
-        }
+        // Client finished sending requests; finish once every read has been sent
+        client_done_.store(true);
+        Pump();
         return;
     }
     
     // Process this request
+    outstanding_.fetch_add(1);
     ProcessRequest(current_request_);
     
-    // Read the next request (pipelining)
-    StartRead(&current_request_);
+    // Read the next request (pipelining) unless the stream is at its limits
+    if (CanReadMore()) {
+        StartRead(&current_request_);
+        return;
+    }
+    read_paused_.store(true);
+    MetricsHelper::GetInstance().IncrementCounter("streaming_read.read_pauses");
+    // A write may have completed between the check and the pause
+    ResumeRead();
 }
 
 void StreamingReadReactor::OnWriteDone(bool ok) {
-    std::unique_lock<std::mutex> lock(mutex_);
-    pending_writes_--;
-    write_in_progress_ = false;  // Reset write flag
-    
     if (!ok) {
-        // Write failed, finish with error
-        lock.unlock();
+        // Write failed, finish with error (the writer token stays taken)
         Finish(grpc::Status(grpc::StatusCode::INTERNAL, "Write failed"));
         return;
     }
     
-    // Try to send next response if available
-    TrySendNextResponse();
+    size_t bytes = current_response_->chunk().buffer().size();
+    buffered_bytes_.fetch_sub(bytes);
+    service_->ReleaseResponseBytes(bytes);
+    current_response_.reset();
+    outstanding_.fetch_sub(1);
     
-    // If client is done and no more pending work, finish
-    if (client_done_ && pending_writes_ == 0 && active_threads_ == 0 && response_queue_.empty()) {
-        lock.unlock();
-        Finish(grpc::Status::OK);
-    }
+    writing_.store(false);
+    Pump();
+    ResumeRead();
 }
 
 void StreamingReadReactor::OnDone() {
-    // Wait for all active threads to complete before destroying
-    {
-        std::unique_lock<std::mutex> lock(mutex_);
-        shutdown_ = true;
-        shutdown_cv_.wait(lock, [this]() { return active_threads_ == 0; });
-    }
-    
     auto stream_end = std::chrono::high_resolution_clock::now();
     auto total_us = std::chrono::duration_cast<std::chrono::microseconds>(stream_end - stream_start_).count();
     LogMetric("StreamingRead", "stream", 0, total_us, 0, true);
-    delete this;
+    
+    // Reads still running keep the reactor alive; the last one deletes it
+    Release();
 }
 
 void StreamingReadReactor::ProcessRequest(const ReadRequest& request) {
+    // Reads complete in any order; the echoed sequence lets the client match them up
+    uint64_t sequence = request.sequence();
+    
     // Validate request
     if (request.resource_name().empty() || request.container_name().empty() || request.location().empty()) {
         auto response = std::make_unique<ReadResponse>();
+        response->set_sequence(sequence);
         response->set_success(false);
         response->set_found(false);
         response->set_error("Invalid request: missing required fields");
         
-        std::unique_lock<std::mutex> lock(mutex_);
-        response_queue_.push(std::move(response));
-        TrySendNextResponse();
+        Complete(std::move(response));
         return;
     }
     
@@ -86,28 +91,27 @@ void StreamingReadReactor::ProcessRequest(const ReadRequest& request) {
     auto store = service_->GetAccountResolver()->ResolveStore(request.resource_name(), request.container_name());
     if (!store) {
         auto response = std::make_unique<ReadResponse>();
+        response->set_sequence(sequence);
         response->set_success(false);
         response->set_found(false);
         response->set_error("Failed to initialize storage");
         
-        std::unique_lock<std::mutex> lock(mutex_);
-        response_queue_.push(std::move(response));
-        TrySendNextResponse();
+        Complete(std::move(response));
         return;
     }
     
-    // Increment active thread count before spawning
-    {
-        std::unique_lock<std::mutex> lock(mutex_);
-        active_threads_++;
-    }
+    // Count the read before it can start, so the stream neither finishes nor goes away under it
+    active_tasks_.fetch_add(1);
+    refs_.fetch_add(1);
     
-    // Process async in thread to not block reactor
+    // Process on the request executor to not block the reactor
     std::string location = request.location();
     std::string completion_id = request.completion_id();
+    auto accept_codecs = request.accept_codecs();
     
-    std::thread([this, store, location, completion_id]() {
+    bool scheduled = ScheduleRequest([this, store, location, completion_id, accept_codecs, sequence](int64_t queue_wait_us) {
         auto response = std::make_unique<ReadResponse>();
+        response->set_sequence(sequence);
         
         try {
             auto storage_start = std::chrono::high_resolution_clock::now();
@@ -122,12 +126,14 @@ void StreamingReadReactor::ProcessRequest(const ReadRequest& request) {
             response->set_found(found);
             
             if (found) {
+                EncodeForWire(chunk, accept_codecs);
                 auto* protoChunk = response->mutable_chunk();
                 protoChunk->set_hash(chunk.hash);
                 protoChunk->set_partition_key(chunk.partitionKey);
                 protoChunk->set_parent_hash(chunk.parentHash);
                 protoChunk->set_completion_id(chunk.completionId);
-                protoChunk->set_buffer(chunk.buffer.data(), chunk.buffer.size());
+                protoChunk->set_buffer(std::move(chunk.buffer));  // Takes ownership, no copy
+                SetPayloadEncoding(protoChunk, chunk.encoding);
                 
                 for (auto token : chunk.tokens) {
                     protoChunk->add_tokens(static_cast<int64_t>(token));
@@ -136,8 +142,11 @@ void StreamingReadReactor::ProcessRequest(const ReadRequest& request) {
             
             auto* metrics = response->mutable_server_metrics();
             metrics->set_storage_latency_us(storage_us);
-            metrics->set_total_latency_us(storage_us);
+            metrics->set_total_latency_us(storage_us + queue_wait_us);
             metrics->set_overhead_us(0);
+            metrics->set_queue_wait_us(queue_wait_us);
+            SetIoQueueMetrics(metrics);
+            SetBytesCopied(metrics, chunk.bytesCopied);
             
         } catch (const std::exception& e) {
             response->set_success(false);
@@ -145,39 +154,101 @@ void StreamingReadReactor::ProcessRequest(const ReadRequest& request) {
             response->set_error(e.what());
         }
         
-        // Queue response and decrement thread count
-        std::unique_lock<std::mutex> lock(mutex_);
-        bool was_shutdown = shutdown_;
+        // Queue the response before the count drops, so Pump cannot finish without it
+        Enqueue(std::move(response));
+        active_tasks_.fetch_sub(1);
+        Pump();
+        Release();
+    }, priority_);
+    if (!scheduled) {
+        auto response = std::make_unique<ReadResponse>();
+        response->set_sequence(sequence);
+        response->set_success(false);
+        response->set_found(false);
+        response->set_error("Server busy: request queue is full");
         
-        if (!was_shutdown) {
-            response_queue_.push(std::move(response));
-            TrySendNextResponse();
+        Enqueue(std::move(response));
+        active_tasks_.fetch_sub(1);
+        refs_.fetch_sub(1);   // gRPC still holds its reference here
+        Pump();
+    }
+}
+
+void StreamingReadReactor::Complete(std::unique_ptr<ReadResponse> response) {
+    Enqueue(std::move(response));
+    Pump();
+}
+
+void StreamingReadReactor::Enqueue(std::unique_ptr<ReadResponse> response) {
+    // Payload dominates the message; the budget ignores the small fixed fields
+    size_t bytes = response->chunk().buffer().size();
+    buffered_bytes_.fetch_add(bytes);
+    service_->ChargeResponseBytes(bytes);
+    ready_.Push(std::move(response));
+}
+
+bool StreamingReadReactor::CanReadMore() const {
+    const auto& limits = service_->GetStreamingReadLimits();
+    size_t outstanding = outstanding_.load();
+    if (limits.maxInFlightPerStream > 0 && outstanding >= limits.maxInFlightPerStream) {
+        return false;
+    }
+    // Over budget, wait for this stream's own responses to drain; with none outstanding there
+    // is no write to resume from, so always allow one
+    return outstanding == 0 || !service_->ResponseBudgetExceeded();
+}
+
+void StreamingReadReactor::ResumeRead() {
+    if (!read_paused_.load() || !CanReadMore()) {
+        return;
+    }
+    bool expected = true;
+    if (read_paused_.compare_exchange_strong(expected, false)) {
+        StartRead(&current_request_);
+    }
+}
+
+void StreamingReadReactor::Pump() {
+    bool expected = false;
+    while (writing_.compare_exchange_strong(expected, true)) {
+        if (batch_.empty()) {
+            ready_.PopAll(batch_);
+        }
+        if (!batch_.empty()) {
+            current_response_ = std::move(batch_.front());
+            batch_.pop_front();
+            
+            // More responses already waiting: let gRPC hold this one and send them together
+            grpc::WriteOptions options;
+            if (!batch_.empty() || !ready_.Empty()) {
+                options.set_buffer_hint();
+                MetricsHelper::GetInstance().IncrementCounter("streaming_read.buffered_writes");
+            }
+            StartWrite(current_response_.get(), options);
+            return;  // OnWriteDone releases the token
         }
         
-        active_threads_--;
-        
-        // Check if we need to finish or signal shutdown
-        if (was_shutdown) {
-            shutdown_cv_.notify_one();
-        } else if (client_done_ && pending_writes_ == 0 && active_threads_ == 0 && response_queue_.empty()) {
-            lock.unlock();
+        // A read pushes its response before dropping the count, so an empty queue seen after
+        // a zero count means everything has been sent
+        if (client_done_.load() && active_tasks_.load() == 0 && ready_.Empty()) {
             Finish(grpc::Status::OK);
+            return;  // Nothing may be written after Finish, so the token is never released
+        }
+        
+        writing_.store(false);
+        // A response queued, or the last read completed, while we held the token: its own Pump
+        // found the token taken, so go around again
+        if (ready_.Empty() && !(client_done_.load() && active_tasks_.load() == 0)) {
+            return;
         }
-    }).detach();
+        expected = false;
+    }
 }
 
-void StreamingReadReactor::TrySendNextResponse() {
-    // Must be called with mutex held
-    if (write_in_progress_ || response_queue_.empty()) {
-        return;
+void StreamingReadReactor::Release() {
+    if (refs_.fetch_sub(1) == 1) {
+        delete this;
     }
-    
-    current_response_ = std::move(response_queue_.front());
-    response_queue_.pop();
-    write_in_progress_ = true;
-    pending_writes_++;
-    
-    StartWrite(current_response_.get());
 }
 
 } // namespace kvstore
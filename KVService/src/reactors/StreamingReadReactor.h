@@ -3,19 +3,26 @@
 #include <grpcpp/grpcpp.h>
 #include "KVStoreServiceImpl.h"
 #include "ReactorCommon.h"
+#include "MpscQueue.h"
+#include <atomic>
 #include <chrono>
-#include <thread>
-#include <queue>
-#include <mutex>
-#include <condition_variable>
+#include <deque>
 #include <memory>
 
 namespace kvstore {
 
 // Streaming Read Reactor - handles bidirectional streaming for bulk reads
+// Reads run in parallel on the request executor and push finished responses onto a lock-free
+// queue. Whichever thread takes the writer token sends them, one StartWrite at a time as gRPC
+// requires, with buffer_hint set while more are waiting so a burst goes out in fewer frames.
+// The reactor is deleted once gRPC is done with it and the last read has completed.
+// Backpressure (StreamingReadLimits): the next request is not read while the stream has
+// maxInFlightPerStream requests unanswered, or while the server's buffered responses are over
+// budget and this stream has some of its own to drain. Reading resumes from OnWriteDone.
 class StreamingReadReactor : public grpc::ServerBidiReactor<ReadRequest, ReadResponse> {
 public:
     StreamingReadReactor(KVStoreServiceImpl* service, grpc::CallbackServerContext* context);
+    ~StreamingReadReactor() override;
     
     void OnReadDone(bool ok) override;
     void OnWriteDone(bool ok) override;
@@ -23,23 +30,39 @@ public:
     
 private:
     void ProcessRequest(const ReadRequest& request);
-    void TrySendNextResponse();
+    // Queue a finished response and try to send it
+    void Complete(std::unique_ptr<ReadResponse> response);
+    // Charge a response to the budget and queue it
+    void Enqueue(std::unique_ptr<ReadResponse> response);
+    // Whether the limits allow reading another request
+    bool CanReadMore() const;
+    // Start the paused read if the limits now allow it; only from a gRPC reaction, where a
+    // StartRead cannot race with the end of the call
+    void ResumeRead();
+    // Start the next write, or Finish once the client is done and every read is sent
+    void Pump();
+    void Release();
     
     KVStoreServiceImpl* service_;
     grpc::CallbackServerContext* context_;
+    RequestPriority priority_;   // From the stream's metadata, for every read it carries
     std::chrono::high_resolution_clock::time_point stream_start_;
     
     ReadRequest current_request_;
+    
+    MpscQueue<std::unique_ptr<ReadResponse>> ready_;
+    // Owned by the writer token holder
+    std::deque<std::unique_ptr<ReadResponse>> batch_;
     std::unique_ptr<ReadResponse> current_response_;
     
-    std::mutex mutex_;
-    std::condition_variable shutdown_cv_;
-    std::queue<std::unique_ptr<ReadResponse>> response_queue_;
-    bool write_in_progress_ = false;
-    bool client_done_ = false;
-    bool shutdown_ = false;
-    int pending_writes_ = 0;
-    int active_threads_ = 0;
+    // Held from StartWrite to OnWriteDone, and for good once Finish is called
+    std::atomic<bool> writing_{false};
+    std::atomic<bool> client_done_{false};
+    std::atomic<bool> read_paused_{false};
+    std::atomic<size_t> outstanding_{0};       // Requests read whose response is not yet written
+    std::atomic<size_t> buffered_bytes_{0};    // This stream's share of the response budget
+    std::atomic<int> active_tasks_{0};
+    std::atomic<int> refs_{1};   // gRPC's, dropped in OnDone, plus one per read in flight
 };
 
 } // namespace kvstore
@@ -0,0 +1,185 @@
+#include "WriteBatchReactor.h"
+#include "MetricsHelper.h"
+
+namespace kvstore {
+
+WriteBatchReactor::WriteBatchReactor(KVStoreServiceImpl* service,
+                                     grpc::CallbackServerContext* context,
+                                     const WriteBatchRequest* request,
+                                     WriteBatchResponse* response)
+    : service_(service), context_(context), request_(request), response_(response) {
+    
+    rpc_start_ = std::chrono::high_resolution_clock::now();
+    
+    auto metadata = context->client_metadata();
+    auto req_id = metadata.find("request-id");
+    if (req_id != metadata.end()) {
+        request_id_ = std::string(req_id->second.data(), req_id->second.length());
+    }
+    
+    StartProcessing();
+}
+
+void WriteBatchReactor::OnDone() {
+    delete this;
+}
+
+void WriteBatchReactor::StartProcessing() {
+    if (request_->resource_name().empty()) {
+        Finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "resource_name is required"));
+        return;
+    }
+    if (request_->container_name().empty()) {
+        Finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "container_name is required"));
+        return;
+    }
+    if (request_->chunks_size() == 0) {
+        Finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "chunks is required"));
+        return;
+    }
+    
+    auto store = service_->GetAccountResolver()->ResolveStore(request_->resource_name(), request_->container_name());
+    if (!store) {
+        response_->set_success(false);
+        response_->set_error("Failed to initialize storage for account");
+        auto rpc_end = std::chrono::high_resolution_clock::now();
+        auto total_us = std::chrono::duration_cast<std::chrono::microseconds>(rpc_end - rpc_start_).count();
+        
+        auto* metrics = response_->mutable_server_metrics();
+        metrics->set_storage_latency_us(0);
+        metrics->set_total_latency_us(total_us);
+        metrics->set_overhead_us(total_us);
+        
+        LogMetric("WriteBatch", request_id_, 0, total_us, 0, false, "Failed to initialize storage");
+        Finish(grpc::Status(grpc::StatusCode::INTERNAL, "Failed to initialize storage"));
+        return;
+    }
+    
+    bool scheduled = ScheduleRequest([this, store](int64_t queue_wait_us) {
+        try {
+            auto storage_start = std::chrono::high_resolution_clock::now();
+            
+            // Convert protobuf chunks to native PromptChunks, linking each to the previous block
+            std::string payloadError;
+            std::vector<::PromptChunk> chunks;
+            chunks.reserve(request_->chunks_size());
+            for (const auto& protoChunk : request_->chunks()) {
+                ::PromptChunk chunk;
+                chunk.hash = protoChunk.hash();
+                chunk.partitionKey = protoChunk.partition_key();
+                chunk.parentHash = chunks.empty() ? protoChunk.parent_hash() : chunks.back().hash;
+                chunk.completionId = protoChunk.completion_id();
+                
+                chunk.buffer = protoChunk.buffer();
+                chunk.bufferSize = chunk.buffer.size();
+                
+                chunk.tokens.reserve(protoChunk.tokens().size());
+                for (auto token : protoChunk.tokens()) {
+                    chunk.tokens.push_back(static_cast<Token>(token));
+                }
+                
+                chunk.encoding = GetPayloadEncoding(protoChunk);
+                if (!EncodeForStorage(service_, request_->container_name(), chunk, payloadError)) {
+                    break;
+                }
+                chunks.push_back(std::move(chunk));
+            }
+            
+            // A payload that does not decode is a client bug; reject the whole chain
+            if (!payloadError.empty()) {
+                response_->set_success(false);
+                response_->set_error(payloadError);
+                auto rpc_end = std::chrono::high_resolution_clock::now();
+                auto total_us = std::chrono::duration_cast<std::chrono::microseconds>(rpc_end - rpc_start_).count();
+                
+                auto* metrics = response_->mutable_server_metrics();
+                metrics->set_storage_latency_us(0);
+                metrics->set_total_latency_us(total_us);
+                metrics->set_overhead_us(total_us);
+                
+                LogMetric("WriteBatch", request_id_, 0, total_us, 0, false, payloadError);
+                Finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, payloadError));
+                return;
+            }
+            
+            // Queued chains are acknowledged block by block; the flush reports failures as metrics
+            std::vector<::BlockWriteStatus> statuses;
+            auto durability = TryWriteBehind(service_, store, request_->resource_name(), request_->container_name(),
+                                             chunks, request_->durability());
+            if (durability == WRITE_DURABILITY_STORAGE) {
+                statuses = store->WriteBatchAsync(std::move(chunks)).get();
+            } else {
+                for (const auto& protoChunk : request_->chunks()) {
+                    statuses.emplace_back(protoChunk.hash(), true);
+                }
+            }
+            
+            auto storage_end = std::chrono::high_resolution_clock::now();
+            
+            size_t failed = 0;
+            for (const auto& status : statuses) {
+                auto* protoStatus = response_->add_statuses();
+                protoStatus->set_hash(status.hash);
+                protoStatus->set_success(status.success);
+                if (!status.success) {
+                    protoStatus->set_error(status.error);
+                    if (failed++ == 0) {
+                        response_->set_error(status.error);
+                    }
+                }
+            }
+            response_->set_success(failed == 0);
+            response_->set_durability(durability);
+            
+            auto& serverMetrics = MetricsHelper::GetInstance();
+            serverMetrics.IncrementCounter("write_batch.blocks", static_cast<int64_t>(statuses.size()));
+            serverMetrics.IncrementCounter("write_batch.failed_blocks", static_cast<int64_t>(failed));
+            
+            auto rpc_end = std::chrono::high_resolution_clock::now();
+            auto storage_us = std::chrono::duration_cast<std::chrono::microseconds>(storage_end - storage_start).count();
+            auto total_us = std::chrono::duration_cast<std::chrono::microseconds>(rpc_end - rpc_start_).count();
+            
+            auto* metrics = response_->mutable_server_metrics();
+            metrics->set_storage_latency_us(storage_us);
+            metrics->set_total_latency_us(total_us);
+            metrics->set_overhead_us(total_us - storage_us - queue_wait_us);
+            metrics->set_queue_wait_us(queue_wait_us);
+            SetIoQueueMetrics(metrics);
+            
+            LogMetric("WriteBatch", request_id_, storage_us, total_us, 0, failed == 0, response_->error());
+            
+            // Per-block failures are reported in statuses; the RPC itself succeeded
+            Finish(grpc::Status::OK);
+            
+        } catch (const std::exception& e) {
+            response_->set_success(false);
+            response_->set_error(e.what());
+            auto rpc_end = std::chrono::high_resolution_clock::now();
+            auto total_us = std::chrono::duration_cast<std::chrono::microseconds>(rpc_end - rpc_start_).count();
+            
+            auto* metrics = response_->mutable_server_metrics();
+            metrics->set_storage_latency_us(0);
+            metrics->set_total_latency_us(total_us);
+            metrics->set_overhead_us(total_us);
+            
+            LogMetric("WriteBatch", request_id_, 0, total_us, 0, false, e.what());
+            Finish(grpc::Status(grpc::StatusCode::INTERNAL, e.what()));
+        }
+    }, GetRequestPriority(context_, RequestPriority::Low));
+    if (!scheduled) {
+        response_->set_success(false);
+        response_->set_error("Server busy: request queue is full");
+        auto rpc_end = std::chrono::high_resolution_clock::now();
+        auto total_us = std::chrono::duration_cast<std::chrono::microseconds>(rpc_end - rpc_start_).count();
+        
+        auto* metrics = response_->mutable_server_metrics();
+        metrics->set_storage_latency_us(0);
+        metrics->set_total_latency_us(total_us);
+        metrics->set_overhead_us(total_us);
+        
+        LogMetric("WriteBatch", request_id_, 0, total_us, 0, false, "Request queue full");
+        Finish(grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED, "Server busy: request queue is full"));
+    }
+}
+
+} // namespace kvstore
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <grpcpp/grpcpp.h>
+#include "KVStoreServiceImpl.h"
+#include "ReactorCommon.h"
+#include <chrono>
+
+namespace kvstore {
+
+// Async WriteBatch Reactor
+// Writes an ordered block chain through the store's WriteBatchAsync and returns one status per block
+class WriteBatchReactor : public grpc::ServerUnaryReactor {
+public:
+    WriteBatchReactor(KVStoreServiceImpl* service,
+                      grpc::CallbackServerContext* context,
+                      const WriteBatchRequest* request,
+                      WriteBatchResponse* response);
+    
+    void OnDone() override;
+    
+private:
+    void StartProcessing();
+    
+    KVStoreServiceImpl* service_;
+    grpc::CallbackServerContext* context_;
+    const WriteBatchRequest* request_;
+    WriteBatchResponse* response_;
+    std::chrono::high_resolution_clock::time_point rpc_start_;
+    std::string request_id_ = "unknown";
+};
+
+} // namespace kvstore
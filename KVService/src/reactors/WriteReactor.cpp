@@ -1,5 +1,4 @@
 #include "WriteReactor.h"
-#include <thread>
 
 namespace kvstore {
 
@@ -55,7 +54,7 @@ void WriteReactor::StartProcessing() {
         return;
     }
     
-    std::thread([this, store]() {
+    bool scheduled = ScheduleRequest([this, store](int64_t queue_wait_us) {
         try {
             auto storage_start = std::chrono::high_resolution_clock::now();
             
@@ -68,8 +67,7 @@ void WriteReactor::StartProcessing() {
             chunk.parentHash = protoChunk.parent_hash();
             chunk.completionId = protoChunk.completion_id();
             
-            const auto& bufferData = protoChunk.buffer();
-            chunk.buffer.assign(bufferData.begin(), bufferData.end());
+            chunk.buffer = protoChunk.buffer();
             chunk.bufferSize = chunk.buffer.size();
             
             chunk.tokens.reserve(protoChunk.tokens().size());
@@ -77,13 +75,38 @@ void WriteReactor::StartProcessing() {
                 chunk.tokens.push_back(static_cast<Token>(token));
             }
             
-            // Perform async write
-            auto future = store->WriteAsync(chunk);
-            future.get();
+            chunk.encoding = GetPayloadEncoding(protoChunk);
+            std::string payloadError;
+            if (!EncodeForStorage(service_, request_->container_name(), chunk, payloadError)) {
+                response_->set_success(false);
+                response_->set_error(payloadError);
+                auto rpc_end = std::chrono::high_resolution_clock::now();
+                auto total_us = std::chrono::duration_cast<std::chrono::microseconds>(rpc_end - rpc_start_).count();
+                
+                auto* metrics = response_->mutable_server_metrics();
+                metrics->set_storage_latency_us(0);
+                metrics->set_total_latency_us(total_us);
+                metrics->set_overhead_us(total_us);
+                
+                LogMetric("Write", request_id_, 0, total_us, 0, false, payloadError);
+                Finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, payloadError));
+                return;
+            }
+            
+            // Acknowledge early through the write-behind queue if requested, else write now
+            std::vector<::PromptChunk> chain;
+            chain.push_back(std::move(chunk));
+            auto durability = TryWriteBehind(service_, store, request_->resource_name(), request_->container_name(),
+                                             chain, request_->durability());
+            if (durability == WRITE_DURABILITY_STORAGE) {
+                auto future = store->WriteAsync(chain.front());
+                future.get();
+            }
             
             auto storage_end = std::chrono::high_resolution_clock::now();
             
             response_->set_success(true);
+            response_->set_durability(durability);
             
             auto rpc_end = std::chrono::high_resolution_clock::now();
             auto storage_us = std::chrono::duration_cast<std::chrono::microseconds>(storage_end - storage_start).count();
@@ -92,7 +115,9 @@ void WriteReactor::StartProcessing() {
             auto* metrics = response_->mutable_server_metrics();
             metrics->set_storage_latency_us(storage_us);
             metrics->set_total_latency_us(total_us);
-            metrics->set_overhead_us(total_us - storage_us);
+            metrics->set_overhead_us(total_us - storage_us - queue_wait_us);
+            metrics->set_queue_wait_us(queue_wait_us);
+            SetIoQueueMetrics(metrics);
             
             LogMetric("Write", request_id_, storage_us, total_us, 0, true);
             
@@ -112,7 +137,21 @@ void WriteReactor::StartProcessing() {
             LogMetric("Write", request_id_, 0, total_us, 0, false, e.what());
             Finish(grpc::Status(grpc::StatusCode::INTERNAL, e.what()));
         }
-    }).detach();
+    }, GetRequestPriority(context_, RequestPriority::Low));
+    if (!scheduled) {
+        response_->set_success(false);
+        response_->set_error("Server busy: request queue is full");
+        auto rpc_end = std::chrono::high_resolution_clock::now();
+        auto total_us = std::chrono::duration_cast<std::chrono::microseconds>(rpc_end - rpc_start_).count();
+        
+        auto* metrics = response_->mutable_server_metrics();
+        metrics->set_storage_latency_us(0);
+        metrics->set_total_latency_us(total_us);
+        metrics->set_overhead_us(total_us);
+        
+        LogMetric("Write", request_id_, 0, total_us, 0, false, "Request queue full");
+        Finish(grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED, "Server busy: request queue is full"));
+    }
 }
 
 } // namespace kvstore
@@ -1,13 +1,19 @@
 #include "KVStoreServiceImpl.h"
 #include "StorageDatabaseResolver.h"
+#include "InMemoryAccountResolver.h"
 #include "MetricsHelper.h"
+#include "StorageIoExecutor.h"
+#include "RequestExecutor.h"
+#include "ContentHash.h"
 #include "ServiceConfig.h"
 #include "FileConfigProvider.h"
 #include <grpcpp/grpcpp.h>
 #include <grpcpp/health_check_service_interface.h>
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <cstdlib>
 #include <csignal>
 #include <thread>
@@ -40,6 +46,21 @@ static bool TryParseInt(const std::string& value, int& out) {
     }
 }
 
+static bool TryParseProbeStrategy(const std::string& value, ProbeStrategy& out) {
+    if (value == "parallel") {
+        out = ProbeStrategy::Parallel;
+    } else if (value == "waves") {
+        out = ProbeStrategy::Waves;
+    } else if (value == "galloping") {
+        out = ProbeStrategy::Galloping;
+    } else if (value == "binary") {
+        out = ProbeStrategy::Binary;
+    } else {
+        return false;
+    }
+    return true;
+}
+
 // Get total processor count across all NUMA nodes/processor groups
 int GetTotalProcessorCount() {
 #ifdef _WIN32
@@ -138,18 +159,56 @@ void SignalHandler(int signal) {
     }
 }
 
+// Server settings besides the listen address and service config, filled in by the argument
+// parser and handed to RunServer as one value so a new feature adds a field, not a parameter
+struct ServerOptions {
+    LogLevel logLevel = LogLevel::Information;
+    HttpTransportProtocol transport = HttpTransportProtocol::LibCurl;
+    bool enableSdkLogging = false;
+    bool enableMultiNic = true;
+    bool enableMetricsLogging = true;
+    int numThreads = 0;   // 0 = one per processor
+    bool enableNumaSpread = true;
+    RequestExecutorOptions requestExecutorOptions;
+    StorageIoExecutorOptions ioOptions;
+
+    // Storage engine
+    StorageEngineType storageEngine = StorageEngineType::AzureBlob;
+    std::string storagePath = "kvstore-data";
+    BlobNamingMode blobNaming = BlobNamingMode::Tokens;
+    bool legacyNameFallback = true;
+    payload::Options payloadOptions;
+    std::unordered_map<std::string, payload::Codec> containerPayloadCodecs;
+
+    // Azure lookup path
+    BlockMetadataCacheOptions metadataCacheOptions;
+    ProbeStrategy probeStrategy = ProbeStrategy::Parallel;
+    std::unordered_map<std::string, ProbeStrategy> containerProbeStrategies;
+    BloomFilterOptions bloomFilterOptions;
+    std::chrono::seconds bloomSnapshotInterval{60};
+
+    // Azure read path
+    DiskChunkCacheOptions chunkCacheOptions;
+    HotChunkCacheOptions hotCacheOptions;
+    ParallelTransferOptions parallelTransferOptions;
+
+    // Azure write path
+    WriteBehindOptions writeBehindOptions;
+    VersionReclaimerOptions versionReclaimerOptions;
+    bool contentDedup = true;
+    RecentWriteSetOptions recentWriteOptions;
+
+    // RPC scheduling
+    kvstore::StreamingReadLimits streamingReadLimits;
+};
+
 void RunServer(const std::string& serverAddress,
                const kvstore::ServiceConfig& serviceConfig,
-               LogLevel logLevel = LogLevel::Information,
-               HttpTransportProtocol transport = HttpTransportProtocol::WinHTTP,
-               bool enableSdkLogging = true,
-               bool enableMultiNic = false,
-               bool enableMetricsLogging = true,
-               int numThreads = 0,
-               bool enableNumaSpread = true) {
+               const ServerOptions& options) {
+    int numThreads = options.numThreads;
     
     // Report NUMA topology
-    if (enableNumaSpread) {
+    if (options.enableNumaSpread) {
         EnableAllNumaNodes();
     } else {
         std::cout << "NUMA spread disabled (process should stay within a single NUMA node if constrained externally)" << std::endl;
@@ -161,13 +220,21 @@ void RunServer(const std::string& serverAddress,
     }
     std::cout << "Using " << numThreads << " server threads" << std::endl;
     
-    // Log service configuration
-    std::cout << "Service Configuration:" << std::endl;
-    std::cout << "  Current Location: " << serviceConfig.currentLocation << std::endl;
-    std::cout << "  Configuration Store: " << serviceConfig.configurationStore << std::endl;
-    std::cout << "  Configuration Container: " << serviceConfig.configurationContainer << std::endl;
-    std::cout << "  Domain Suffix: " << serviceConfig.domainSuffix << std::endl;
-    std::cout << "  Configuration Store URL: " << serviceConfig.GetConfigurationStoreUrl() << std::endl;
+    // Reactors run their blocking work on the request executor, one worker per server thread
+    RequestExecutorOptions executorOptions = options.requestExecutorOptions;
+    executorOptions.threads = static_cast<size_t>(numThreads);
+    executorOptions.numaAware = options.enableNumaSpread;
+    RequestExecutor::GetInstance().Configure(executorOptions);
+    
+    // Log service configuration (only the Azure engine resolves accounts through the config store)
+    if (options.storageEngine == StorageEngineType::AzureBlob) {
+        std::cout << "Service Configuration:" << std::endl;
+        std::cout << "  Current Location: " << serviceConfig.currentLocation << std::endl;
+        std::cout << "  Configuration Store: " << serviceConfig.configurationStore << std::endl;
+        std::cout << "  Configuration Container: " << serviceConfig.configurationContainer << std::endl;
+        std::cout << "  Domain Suffix: " << serviceConfig.domainSuffix << std::endl;
+        std::cout << "  Configuration Store URL: " << serviceConfig.GetConfigurationStoreUrl() << std::endl;
+    }
     
     // Enable gRPC verbose logging if environment variable is set
     const char* grpcVerbose = std::getenv("GRPC_VERBOSITY");
@@ -179,36 +246,99 @@ void RunServer(const std::string& serverAddress,
         std::cout << "gRPC trace enabled: " << grpcTrace << std::endl;
     }
     
-    // Create StorageDatabaseResolver with configuration
-    kvstore::StorageDatabaseResolverConfig resolverConfig;
-    resolverConfig.serviceConfig = serviceConfig;
-    resolverConfig.httpTransport = transport;
-    resolverConfig.enableSdkLogging = enableSdkLogging;
-    resolverConfig.enableMultiNic = enableMultiNic;
-    resolverConfig.logLevel = logLevel;
-    
-    auto accountResolver = std::make_shared<kvstore::StorageDatabaseResolver>(resolverConfig);
-    
-    // Set up logging callback for the resolver
-    accountResolver->SetLogCallback([logLevel](LogLevel level, const std::string& message) {
+    auto resolverLogCallback = [logLevel = options.logLevel](LogLevel level, const std::string& message) {
         if (level == LogLevel::Error) {
             std::cerr << "[ERROR] " << message << std::endl;
         } else if (level <= logLevel) {
             std::cout << "[INFO] " << message << std::endl;
         }
-    });
+    };
+    
+    // One local SSD chunk cache shared by every Azure store
+    std::shared_ptr<DiskChunkCache> chunkCache;
+    if (options.storageEngine == StorageEngineType::AzureBlob && options.chunkCacheOptions.maxBytes > 0) {
+        chunkCache = std::make_shared<DiskChunkCache>();
+        chunkCache->SetLogCallback(resolverLogCallback);
+        if (!chunkCache->Initialize(options.chunkCacheOptions)) {
+            std::cerr << "Failed to initialize chunk cache at " << options.chunkCacheOptions.path << std::endl;
+            return;
+        }
+    }
+    std::shared_ptr<HotChunkCache> hotChunkCache;
+    if (options.storageEngine == StorageEngineType::AzureBlob && options.hotCacheOptions.maxBytes > 0) {
+        hotChunkCache = std::make_shared<HotChunkCache>(options.hotCacheOptions);
+    }
     
-    // Initialize the resolver (connects to config store)
-    if (!accountResolver->Initialize()) {
-        std::cerr << "Failed to initialize account resolver: " << accountResolver->GetLastError() << std::endl;
-        return;
+    std::shared_ptr<kvstore::IAccountResolver> accountResolver;
+    if (options.storageEngine == StorageEngineType::AzureBlob) {
+        // Create StorageDatabaseResolver with configuration
+        kvstore::StorageDatabaseResolverConfig resolverConfig;
+        resolverConfig.serviceConfig = serviceConfig;
+        resolverConfig.httpTransport = options.transport;
+        resolverConfig.enableSdkLogging = options.enableSdkLogging;
+        resolverConfig.enableMultiNic = options.enableMultiNic;
+        resolverConfig.logLevel = options.logLevel;
+        resolverConfig.metadataCache = options.metadataCacheOptions;
+        resolverConfig.probeStrategy = options.probeStrategy;
+        resolverConfig.containerProbeStrategies = options.containerProbeStrategies;
+        resolverConfig.bloomFilter = options.bloomFilterOptions;
+        resolverConfig.bloomSnapshotInterval = options.bloomSnapshotInterval;
+        resolverConfig.chunkCache = chunkCache;
+        resolverConfig.hotChunkCache = hotChunkCache;
+        resolverConfig.blobNaming = options.blobNaming;
+        resolverConfig.legacyNameFallback = options.legacyNameFallback;
+        resolverConfig.versionReclaimer = options.versionReclaimerOptions;
+        resolverConfig.contentDedup = options.contentDedup;
+        resolverConfig.parallelTransfer = options.parallelTransferOptions;
+        resolverConfig.recentWrites = options.recentWriteOptions;
+        
+        auto databaseResolver = std::make_shared<kvstore::StorageDatabaseResolver>(resolverConfig);
+        databaseResolver->SetLogCallback(resolverLogCallback);
+        
+        // Initialize the resolver (connects to config store)
+        if (!databaseResolver->Initialize()) {
+            std::cerr << "Failed to initialize account resolver: " << databaseResolver->GetLastError() << std::endl;
+            return;
+        }
+        accountResolver = databaseResolver;
+    } else {
+        // Offline engines need no account lookup - one engine per resource/container
+        kvstore::AccountResolverConfig resolverConfig;
+        resolverConfig.logLevel = options.logLevel;
+        resolverConfig.storageEngine = options.storageEngine;
+        resolverConfig.localStoragePath = options.storagePath;
+        
+        auto localResolver = std::make_shared<kvstore::InMemoryAccountResolver>(resolverConfig);
+        localResolver->SetLogCallback(resolverLogCallback);
+        accountResolver = localResolver;
     }
     std::cout << "Account resolver initialized successfully" << std::endl;
     
+    // Write-behind queue for early-acknowledged writes; replays journaled writes left by the last run
+    auto writeBehind = std::make_shared<WriteBehindQueue>(options.writeBehindOptions,
+        [accountResolver](const std::string& resourceName, const std::string& containerName) {
+            return accountResolver->ResolveStore(resourceName, containerName);
+        });
+    writeBehind->SetLogCallback(resolverLogCallback);
+    if (!writeBehind->Initialize()) {
+        std::cerr << "Failed to initialize write-behind journal at " << options.writeBehindOptions.journalPath << std::endl;
+        return;
+    }
+    
     // Create service with account resolver
     kvstore::KVStoreServiceImpl service(accountResolver);
-    service.SetLogLevel(logLevel);
-    service.EnableMetricsLogging(enableMetricsLogging);
+    service.SetLogLevel(options.logLevel);
+    service.EnableMetricsLogging(options.enableMetricsLogging);
+    if (writeBehind->Enabled()) {
+        service.SetWriteBehindQueue(writeBehind);
+    }
+    std::unordered_map<std::string, payload::Options> containerPayloadOptions;
+    for (const auto& [container, codec] : options.containerPayloadCodecs) {
+        containerPayloadOptions[container] = options.payloadOptions;
+        containerPayloadOptions[container].codec = codec;
+    }
+    service.SetPayloadOptions(options.payloadOptions, containerPayloadOptions);
+    service.SetStreamingReadLimits(options.streamingReadLimits);
 
     grpc::EnableDefaultHealthCheckService(true);
     // Note: Proto reflection plugin not available in static builds
@@ -273,19 +403,71 @@ void RunServer(const std::string& serverAddress,
     std::cout << "KV Store gRPC Service" << std::endl;
     std::cout << "==================================================" << std::endl;
     std::cout << "Server listening on: " << serverAddress << std::endl;
-    std::cout << "Account Resolver: StorageDatabaseResolver" << std::endl;
-    std::cout << "Log Level: " << (logLevel == LogLevel::Error ? "Error" : 
-                                   logLevel == LogLevel::Information ? "Information" : "Verbose") << std::endl;
-    std::cout << "HTTP Transport: " << (transport == HttpTransportProtocol::WinHTTP ? "WinHTTP" : "LibCurl") << std::endl;
-    std::cout << "SDK Logging: " << (enableSdkLogging ? "Enabled" : "Disabled") << std::endl;
-    std::cout << "Multi-NIC: " << (enableMultiNic ? "Enabled" : "Disabled") << std::endl;
-    std::cout << "Metrics Logging: " << (enableMetricsLogging ? "Enabled" : "Disabled") << std::endl;
+    std::cout << "Account Resolver: " << (options.storageEngine == StorageEngineType::AzureBlob ? "StorageDatabaseResolver" : "InMemoryAccountResolver") << std::endl;
+    std::cout << "Storage Engine: " << (options.storageEngine == StorageEngineType::AzureBlob ? "Azure Blob" :
+                                        options.storageEngine == StorageEngineType::InMemory ? "In-Memory" :
+                                        "Local Disk (" + options.storagePath + ")") << std::endl;
+    std::cout << "Log Level: " << (options.logLevel == LogLevel::Error ? "Error" : 
+                                   options.logLevel == LogLevel::Information ? "Information" : "Verbose") << std::endl;
+    std::cout << "HTTP Transport: " << (options.transport == HttpTransportProtocol::WinHTTP ? "WinHTTP" : "LibCurl") << std::endl;
+    std::cout << "SDK Logging: " << (options.enableSdkLogging ? "Enabled" : "Disabled") << std::endl;
+    std::cout << "Multi-NIC: " << (options.enableMultiNic ? "Enabled" : "Disabled") << std::endl;
+    std::cout << "Request Executor: " << numThreads << " workers, queue " << options.requestExecutorOptions.maxQueueDepth
+              << (options.enableNumaSpread ? ", per NUMA node with work stealing" : ", single queue") << std::endl;
+    std::cout << "Storage I/O Executor: " << options.ioOptions.threads << " threads, queue " << options.ioOptions.maxQueueDepth
+              << ", fan-out " << options.ioOptions.maxFanOutPerRequest << " per request" << std::endl;
+    std::cout << "Priority Classes: Lookup high, Read normal, Write low (x-kvstore-priority overrides), starvation limit " << options.requestExecutorOptions.starvationLimit.count() << " ms" << std::endl;
+    std::cout << "StreamingRead Limits: " << options.streamingReadLimits.maxInFlightPerStream << " in flight per stream, "
+              << options.streamingReadLimits.responseBudgetBytes / (1024 * 1024) << " MB response budget (0 = unlimited)" << std::endl;
+    if (options.storageEngine == StorageEngineType::AzureBlob) {
+        std::cout << "Metadata Cache: " << (options.metadataCacheOptions.maxEntries > 0
+            ? std::to_string(options.metadataCacheOptions.maxEntries) + " entries, TTL " + std::to_string(options.metadataCacheOptions.ttl.count()) + "ms"
+            : std::string("Disabled")) << std::endl;
+        std::cout << "Bloom Filter: " << (options.bloomFilterOptions.enabled
+            ? std::to_string(options.bloomFilterOptions.expectedBlobs) + " blobs at " + std::to_string(options.bloomFilterOptions.bitsPerBlob) +
+              " bits, snapshot every " + std::to_string(options.bloomSnapshotInterval.count()) + "s"
+            : std::string("Disabled")) << std::endl;
+        std::cout << "Chunk Cache: " << (chunkCache
+            ? options.chunkCacheOptions.path + " (" + std::to_string(options.chunkCacheOptions.maxBytes >> 20) + " MB)"
+            : std::string("Disabled")) << std::endl;
+        std::cout << "Hot Chunk Cache: " << (hotChunkCache
+            ? std::to_string(options.hotCacheOptions.maxBytes >> 20) + " MB (W-TinyLFU)"
+            : std::string("Disabled")) << std::endl;
+        std::cout << "Blob Naming: " << (options.blobNaming == BlobNamingMode::Hash
+            ? std::string("128-bit hash") + (options.legacyNameFallback ? " (with token-name fallback)" : "")
+            : std::string("base64url tokens")) << std::endl;
+        std::cout << "Version GC: batches of " << options.versionReclaimerOptions.batchSize << ", " << (options.versionReclaimerOptions.deletesPerSecond > 0
+            ? std::to_string(static_cast<int64_t>(options.versionReclaimerOptions.deletesPerSecond)) + " deletes/s"
+            : std::string("unlimited")) << std::endl;
+        std::cout << "Version Payloads: " << (options.contentDedup
+            ? std::string("content-addressed (SHA-256") + (Sha256::HardwareAccelerated() ? ", SHA-NI)" : ")")
+            : std::string("GUID blob per version")) << std::endl;
+        std::cout << "Parallel Transfers: " << (options.parallelTransferOptions.thresholdBytes > 0
+            ? "above " + std::to_string(options.parallelTransferOptions.thresholdBytes >> 20) + " MB, " +
+              std::to_string(options.parallelTransferOptions.partBytes >> 20) + " MB parts x" + std::to_string(options.parallelTransferOptions.parallelism)
+            : std::string("Disabled")) << std::endl;
+        std::cout << "Recent Writes: " << (options.recentWriteOptions.maxEntries > 0
+            ? std::to_string(options.recentWriteOptions.maxEntries) + " versions per store, " + std::to_string(options.recentWriteOptions.ttl.count()) + " ms"
+            : std::string("Disabled")) << std::endl;
+    }
+    std::cout << "Payload Codec: " << payload::CodecName(options.payloadOptions.codec)
+              << (options.payloadOptions.shuffle > 1 ? ", shuffle " + std::to_string(options.payloadOptions.shuffle) : std::string())
+              << (options.containerPayloadCodecs.empty() ? std::string() : ", " + std::to_string(options.containerPayloadCodecs.size()) + " container override(s)")
+              << std::endl;
+    std::cout << "Write-Behind: " << (writeBehind->Enabled()
+        ? std::to_string(options.writeBehindOptions.maxQueuedBytes >> 20) + " MB, " + std::to_string(options.writeBehindOptions.flushThreads) +
+          " flush threads, journal " + (writeBehind->Journaled() ? options.writeBehindOptions.journalPath : std::string("disabled"))
+        : std::string("Disabled")) << std::endl;
+    std::cout << "Metrics Logging: " << (options.enableMetricsLogging ? "Enabled" : "Disabled") << std::endl;
     std::cout << "==================================================" << std::endl;
     std::cout << "Press Ctrl+C to stop the server" << std::endl;
     
     // Wait for server shutdown
     g_server->Wait();
     
+    // Flush acknowledged writes before the stores go away
+    writeBehind->Drain();
+    
     std::cout << "Server stopped" << std::endl;
 }
 
@@ -295,13 +477,51 @@ void PrintUsage(const char* programName) {
     std::cout << "  --config FILE                 Path to service configuration JSON file (default: service-config.json)" << std::endl;
     std::cout << "  --port PORT                   Port to listen on (default: 50051)" << std::endl;
     std::cout << "  --host HOST                   Host to bind to (default: 0.0.0.0)" << std::endl;
-    std::cout << "  --threads NUM                 Number of server threads (default: auto-detect CPU count)" << std::endl;
+    std::cout << "  --threads NUM                 Number of server threads and request workers (default: auto-detect CPU count)" << std::endl;
+    std::cout << "  --request-queue-depth NUM     Requests queued for a worker before new ones are rejected (default: 4096)" << std::endl;
+    std::cout << "  --priority-starvation-ms MS   Queue wait after which lower-priority work runs ahead of higher (default: 250)" << std::endl;
+    std::cout << "  --stream-max-inflight NUM     StreamingRead requests unanswered per stream before reading pauses, 0 = unlimited (default: 64)" << std::endl;
+    std::cout << "  --stream-response-budget-mb MB  Buffered StreamingRead response payload across streams, 0 = unlimited (default: 1024)" << std::endl;
     std::cout << "  --log-level LEVEL             Log level: error, info, verbose (default: info)" << std::endl;
     std::cout << "  --transport TRANSPORT         HTTP transport: winhttp, libcurl (default: libcurl)" << std::endl;
     std::cout << "  --enable-sdk-logging          Enable Azure SDK logging (default: disabled)" << std::endl;
     std::cout << "  --disable-multi-nic           Disable multi-NIC support (default: enabled)" << std::endl;
     std::cout << "  --disable-numa-spread         Do not attempt to spread threads across NUMA nodes (default: enabled)" << std::endl;
     std::cout << "  --processor-group N           Pin main thread to Windows processor group N (NUMA-style); implies --disable-numa-spread" << std::endl;
+    std::cout << "  --storage-engine ENGINE       Storage engine: azure, memory, disk (default: azure)" << std::endl;
+    std::cout << "  --storage-path DIR            Root directory for the disk engine (default: kvstore-data)" << std::endl;
+    std::cout << "  --metadata-cache-entries N    Block metadata cache capacity, 0 disables (default: 262144)" << std::endl;
+    std::cout << "  --metadata-cache-ttl-ms MS    Block metadata cache entry lifetime (default: 60000)" << std::endl;
+    std::cout << "  --probe-strategy STRATEGY     Lookup probing: parallel, waves, galloping, binary (default: parallel)" << std::endl;
+    std::cout << "  --container-probe-strategy C=STRATEGY  Probe strategy for one container (repeatable)" << std::endl;
+    std::cout << "  --bloom-filter-blobs N        Blob names the Bloom filter is sized for (default: 8388608)" << std::endl;
+    std::cout << "  --bloom-filter-bits N         Bloom filter bits per blob name (default: 10)" << std::endl;
+    std::cout << "  --bloom-snapshot-interval-s S Seconds between Bloom filter snapshots (default: 60)" << std::endl;
+    std::cout << "  --disable-bloom-filter        Probe storage for every uncached Lookup block" << std::endl;
+    std::cout << "  --chunk-cache-path DIR        Local SSD directory for the chunk cache (default: kvstore-chunk-cache)" << std::endl;
+    std::cout << "  --chunk-cache-mb MB           Chunk cache byte budget, 0 disables (default: 0)" << std::endl;
+    std::cout << "  --hot-cache-mb MB             In-memory hot-chunk cache budget, 0 disables (default: 0)" << std::endl;
+    std::cout << "  --blob-naming MODE            Token block blob names: tokens, hash (default: tokens)" << std::endl;
+    std::cout << "  --no-legacy-blob-names        In hash mode, stop falling back to token-named blobs" << std::endl;
+    std::cout << "  --disable-content-dedup       Give every additional version its own GUID blob" << std::endl;
+    std::cout << "  --parallel-transfer-mb MB     Split larger payloads into parallel parts, 0 disables (default: 4)" << std::endl;
+    std::cout << "  --transfer-part-mb MB         Staged block / ranged GET size (default: 1)" << std::endl;
+    std::cout << "  --transfer-parallelism N      Parts in flight per payload (default: 8)" << std::endl;
+    std::cout << "  --recent-writes N             Recently written versions skipped per store, 0 disables (default: 262144)" << std::endl;
+    std::cout << "  --recent-writes-ttl-ms MS     Recently written version lifetime (default: 60000)" << std::endl;
+    std::cout << "  --write-behind-mb MB          Write-behind queue budget for early-acked writes, 0 disables (default: 0)" << std::endl;
+    std::cout << "  --write-behind-threads NUM    Write-behind flush threads (default: 16)" << std::endl;
+    std::cout << "  --write-behind-journal DIR    Local journal directory; enables local-cache durability (default: none)" << std::endl;
+    std::cout << "  --write-behind-drain-s S      Seconds to flush queued writes on shutdown (default: 30)" << std::endl;
+    std::cout << "  --payload-codec CODEC         Compress stored chunk payloads: none, lz4, zstd (default: none)" << std::endl;
+    std::cout << "  --payload-shuffle N           Byte-shuffle element size before compression, 2 for fp16/bf16 (default: 0)" << std::endl;
+    std::cout << "  --payload-level N             zstd compression level, 0 = zstd default (default: 0)" << std::endl;
+    std::cout << "  --container-payload-codec C=CODEC  Payload codec for one container (repeatable)" << std::endl;
+    std::cout << "  --version-gc-rate N           Evicted version blob deletes per second, 0 = unlimited (default: 200)" << std::endl;
+    std::cout << "  --version-gc-batch N          Evicted version blobs per Blob Batch delete (default: 256)" << std::endl;
+    std::cout << "  --io-threads NUM              Storage I/O executor threads (default: 128)" << std::endl;
+    std::cout << "  --io-queue-depth NUM          Storage I/O queue bound before callers run work inline (default: 4096)" << std::endl;
+    std::cout << "  --io-fanout NUM               Max parallel storage calls per Lookup or WriteBatch (default: 32)" << std::endl;
     std::cout << "  --disable-metrics             Disable JSON metrics logging to console (default: enabled)" << std::endl;
     std::cout << "  --metrics-endpoint ENDPOINT   Azure Monitor OTLP endpoint (optional)" << std::endl;
     std::cout << "  --instrumentation-key KEY     Application Insights instrumentation key (optional)" << std::endl;
@@ -316,14 +536,8 @@ int main(int argc, char** argv) {
     // Parse command line arguments
     std::string host = "0.0.0.0";
     int port = 50051;
-    int numThreads = 0;  // 0 = auto-detect
-    LogLevel logLevel = LogLevel::Information;
-    HttpTransportProtocol transport = HttpTransportProtocol::LibCurl;
-    bool enableSdkLogging = false;  // Default: disabled for cleaner output
-    bool enableMultiNic = true;
-    bool enableNumaSpread = true;
+    ServerOptions options;
     int processorGroup = -1;
-    bool enableMetricsLogging = true;  // Default: enabled
     std::string metricsEndpoint;
     std::string instrumentationKey;
     std::string configFilePath = "service-config.json";
@@ -351,16 +565,30 @@ int main(int argc, char** argv) {
             hostExplicit = true;
         }
         else if (arg == "--threads" && i + 1 < argc) {
-            numThreads = std::stoi(argv[++i]);
+            options.numThreads = std::stoi(argv[++i]);
+        }
+        else if (arg == "--request-queue-depth" && i + 1 < argc) {
+            options.requestExecutorOptions.maxQueueDepth = std::stoull(argv[++i]);
+        }
+        else if (arg == "--priority-starvation-ms" && i + 1 < argc) {
+            auto limit = std::chrono::milliseconds(std::stoll(argv[++i]));
+            options.requestExecutorOptions.starvationLimit = limit;
+            options.ioOptions.starvationLimit = limit;
+        }
+        else if (arg == "--stream-max-inflight" && i + 1 < argc) {
+            options.streamingReadLimits.maxInFlightPerStream = std::stoull(argv[++i]);
+        }
+        else if (arg == "--stream-response-budget-mb" && i + 1 < argc) {
+            options.streamingReadLimits.responseBudgetBytes = std::stoull(argv[++i]) * 1024 * 1024;
         }
         else if (arg == "--log-level" && i + 1 < argc) {
             std::string level = argv[++i];
             if (level == "error") {
-                logLevel = LogLevel::Error;
+                options.logLevel = LogLevel::Error;
             } else if (level == "info") {
-                logLevel = LogLevel::Information;
+                options.logLevel = LogLevel::Information;
             } else if (level == "verbose") {
-                logLevel = LogLevel::Verbose;
+                options.logLevel = LogLevel::Verbose;
             } else {
                 std::cerr << "Invalid log level: " << level << std::endl;
                 return 1;
@@ -369,30 +597,185 @@ int main(int argc, char** argv) {
         else if (arg == "--transport" && i + 1 < argc) {
             std::string transportStr = argv[++i];
             if (transportStr == "winhttp") {
-                transport = HttpTransportProtocol::WinHTTP;
+                options.transport = HttpTransportProtocol::WinHTTP;
             } else if (transportStr == "libcurl") {
-                transport = HttpTransportProtocol::LibCurl;
+                options.transport = HttpTransportProtocol::LibCurl;
             } else {
                 std::cerr << "Invalid transport: " << transportStr << std::endl;
                 return 1;
             }
         }
         else if (arg == "--enable-sdk-logging") {
-            enableSdkLogging = true;
+            options.enableSdkLogging = true;
         }
         else if (arg == "--disable-multi-nic") {
-            enableMultiNic = false;
+            options.enableMultiNic = false;
         }
         else if (arg == "--disable-numa-spread") {
-            enableNumaSpread = false;
+            options.enableNumaSpread = false;
         }
         else if (arg == "--processor-group" && i + 1 < argc) {
             processorGroup = std::stoi(argv[++i]);
-            enableNumaSpread = false;
+            options.enableNumaSpread = false;
             processorGroupExplicit = true;
         }
+        else if (arg == "--storage-engine" && i + 1 < argc) {
+            std::string engineStr = argv[++i];
+            if (engineStr == "azure") {
+                options.storageEngine = StorageEngineType::AzureBlob;
+            } else if (engineStr == "memory") {
+                options.storageEngine = StorageEngineType::InMemory;
+            } else if (engineStr == "disk") {
+                options.storageEngine = StorageEngineType::LocalDisk;
+            } else {
+                std::cerr << "Invalid storage engine: " << engineStr << std::endl;
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        }
+        else if (arg == "--storage-path" && i + 1 < argc) {
+            options.storagePath = argv[++i];
+        }
+        else if (arg == "--metadata-cache-entries" && i + 1 < argc) {
+            options.metadataCacheOptions.maxEntries = std::stoull(argv[++i]);
+        }
+        else if (arg == "--metadata-cache-ttl-ms" && i + 1 < argc) {
+            options.metadataCacheOptions.ttl = std::chrono::milliseconds(std::stoll(argv[++i]));
+        }
+        else if (arg == "--probe-strategy" && i + 1 < argc) {
+            std::string strategyStr = argv[++i];
+            if (!TryParseProbeStrategy(strategyStr, options.probeStrategy)) {
+                std::cerr << "Invalid probe strategy: " << strategyStr << std::endl;
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        }
+        else if (arg == "--container-probe-strategy" && i + 1 < argc) {
+            std::string entry = argv[++i];
+            size_t eq = entry.find('=');
+            ProbeStrategy containerStrategy;
+            if (eq == std::string::npos || eq == 0 || !TryParseProbeStrategy(entry.substr(eq + 1), containerStrategy)) {
+                std::cerr << "Invalid container probe strategy: " << entry << " (expected CONTAINER=STRATEGY)" << std::endl;
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            options.containerProbeStrategies[entry.substr(0, eq)] = containerStrategy;
+        }
+        else if (arg == "--bloom-filter-blobs" && i + 1 < argc) {
+            options.bloomFilterOptions.expectedBlobs = std::stoull(argv[++i]);
+        }
+        else if (arg == "--bloom-filter-bits" && i + 1 < argc) {
+            options.bloomFilterOptions.bitsPerBlob = std::stoull(argv[++i]);
+        }
+        else if (arg == "--bloom-snapshot-interval-s" && i + 1 < argc) {
+            options.bloomSnapshotInterval = std::chrono::seconds(std::stoll(argv[++i]));
+        }
+        else if (arg == "--disable-bloom-filter") {
+            options.bloomFilterOptions.enabled = false;
+        }
+        else if (arg == "--chunk-cache-path" && i + 1 < argc) {
+            options.chunkCacheOptions.path = argv[++i];
+        }
+        else if (arg == "--chunk-cache-mb" && i + 1 < argc) {
+            options.chunkCacheOptions.maxBytes = std::stoull(argv[++i]) << 20;
+        }
+        else if (arg == "--hot-cache-mb" && i + 1 < argc) {
+            options.hotCacheOptions.maxBytes = std::stoull(argv[++i]) << 20;
+        }
+        else if (arg == "--blob-naming" && i + 1 < argc) {
+            std::string namingStr = argv[++i];
+            if (namingStr == "tokens") {
+                options.blobNaming = BlobNamingMode::Tokens;
+            } else if (namingStr == "hash") {
+                options.blobNaming = BlobNamingMode::Hash;
+            } else {
+                std::cerr << "Invalid blob naming mode: " << namingStr << std::endl;
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        }
+        else if (arg == "--no-legacy-blob-names") {
+            options.legacyNameFallback = false;
+        }
+        else if (arg == "--disable-content-dedup") {
+            options.contentDedup = false;
+        }
+        else if (arg == "--parallel-transfer-mb" && i + 1 < argc) {
+            options.parallelTransferOptions.thresholdBytes = std::stoull(argv[++i]) << 20;
+        }
+        else if (arg == "--transfer-part-mb" && i + 1 < argc) {
+            options.parallelTransferOptions.partBytes = std::max<uint64_t>(std::stoull(argv[++i]), 1) << 20;
+        }
+        else if (arg == "--transfer-parallelism" && i + 1 < argc) {
+            options.parallelTransferOptions.parallelism = std::max<size_t>(std::stoull(argv[++i]), 1);
+        }
+        else if (arg == "--recent-writes" && i + 1 < argc) {
+            options.recentWriteOptions.maxEntries = std::stoull(argv[++i]);
+        }
+        else if (arg == "--recent-writes-ttl-ms" && i + 1 < argc) {
+            options.recentWriteOptions.ttl = std::chrono::milliseconds(std::stoll(argv[++i]));
+        }
+        else if (arg == "--write-behind-mb" && i + 1 < argc) {
+            options.writeBehindOptions.maxQueuedBytes = std::stoull(argv[++i]) << 20;
+        }
+        else if (arg == "--write-behind-threads" && i + 1 < argc) {
+            options.writeBehindOptions.flushThreads = std::stoull(argv[++i]);
+        }
+        else if (arg == "--write-behind-journal" && i + 1 < argc) {
+            options.writeBehindOptions.journalPath = argv[++i];
+        }
+        else if (arg == "--write-behind-drain-s" && i + 1 < argc) {
+            options.writeBehindOptions.drainTimeout = std::chrono::seconds(std::stoll(argv[++i]));
+        }
+        else if (arg == "--payload-codec" && i + 1 < argc) {
+            std::string codec = argv[++i];
+            if (!payload::ParseCodec(codec, options.payloadOptions.codec) || !payload::IsSupported(options.payloadOptions.codec)) {
+                std::cerr << "Invalid or unsupported payload codec: " << codec << " (expected none, lz4 or zstd)" << std::endl;
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        }
+        else if (arg == "--payload-shuffle" && i + 1 < argc) {
+            int shuffle = std::stoi(argv[++i]);
+            if (shuffle < 0 || shuffle > payload::kMaxShuffle) {
+                std::cerr << "Invalid payload shuffle: " << shuffle << " (expected 0-" << int(payload::kMaxShuffle) << ")" << std::endl;
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            options.payloadOptions.shuffle = static_cast<uint8_t>(shuffle);
+        }
+        else if (arg == "--payload-level" && i + 1 < argc) {
+            options.payloadOptions.level = std::stoi(argv[++i]);
+        }
+        else if (arg == "--container-payload-codec" && i + 1 < argc) {
+            std::string entry = argv[++i];
+            size_t eq = entry.find('=');
+            payload::Codec containerCodec;
+            if (eq == std::string::npos || eq == 0 || !payload::ParseCodec(entry.substr(eq + 1), containerCodec) ||
+                !payload::IsSupported(containerCodec)) {
+                std::cerr << "Invalid container payload codec: " << entry << " (expected CONTAINER=CODEC)" << std::endl;
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            options.containerPayloadCodecs[entry.substr(0, eq)] = containerCodec;
+        }
+        else if (arg == "--version-gc-rate" && i + 1 < argc) {
+            options.versionReclaimerOptions.deletesPerSecond = std::stod(argv[++i]);
+        }
+        else if (arg == "--version-gc-batch" && i + 1 < argc) {
+            options.versionReclaimerOptions.batchSize = std::stoull(argv[++i]);
+        }
+        else if (arg == "--io-threads" && i + 1 < argc) {
+            options.ioOptions.threads = std::stoull(argv[++i]);
+        }
+        else if (arg == "--io-queue-depth" && i + 1 < argc) {
+            options.ioOptions.maxQueueDepth = std::stoull(argv[++i]);
+        }
+        else if (arg == "--io-fanout" && i + 1 < argc) {
+            options.ioOptions.maxFanOutPerRequest = std::stoull(argv[++i]);
+        }
         else if (arg == "--disable-metrics") {
-            enableMetricsLogging = false;
+            options.enableMetricsLogging = false;
         }
         else if (arg == "--metrics-endpoint" && i + 1 < argc) {
             metricsEndpoint = argv[++i];
@@ -425,7 +808,7 @@ int main(int argc, char** argv) {
         if (TryParseInt(GetEnvVar("KV_PROCESSOR_GROUP"), envGroup)) {
             processorGroup = envGroup;
             if (processorGroup >= 0) {
-                enableNumaSpread = false;
+                options.enableNumaSpread = false;
             }
         }
     }
@@ -461,7 +844,7 @@ int main(int argc, char** argv) {
         }
     }
 
-    if (!serviceConfig.IsValid()) {
+    if (options.storageEngine == StorageEngineType::AzureBlob && !serviceConfig.IsValid()) {
         std::cerr << "Service configuration is invalid: " << serviceConfig.GetValidationError() << std::endl;
         std::cerr << "Provide a valid config file via --config or set env vars KV_CURRENT_LOCATION, KV_CONFIGURATION_STORE, KV_CONFIGURATION_CONTAINER (and optionally KV_DOMAIN_SUFFIX)." << std::endl;
         return 1;
@@ -469,6 +852,9 @@ int main(int argc, char** argv) {
     
     std::string serverAddress = host + ":" + std::to_string(port);
     
+    // Size the shared storage I/O executor before any store is created
+    StorageIoExecutor::GetInstance().Configure(options.ioOptions);
+    
     // Initialize Azure Monitor metrics if endpoint provided
     if (!metricsEndpoint.empty() && !instrumentationKey.empty()) {
         std::cout << "Initializing Azure Monitor metrics..." << std::endl;
@@ -485,7 +871,7 @@ int main(int argc, char** argv) {
             }
         }
 #endif
-        RunServer(serverAddress, serviceConfig, logLevel, transport, enableSdkLogging, enableMultiNic, enableMetricsLogging, numThreads, enableNumaSpread);
+        RunServer(serverAddress, serviceConfig, options);
     } catch (const std::exception& e) {
         std::cerr << "Server error: " << e.what() << std::endl;
         return 1;